@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+enum class AssetState
+{
+    Queued, // Waiting for a worker
+    Decoding, // Imported or decoded on a worker
+    Uploading, // Decoded, waiting for the main thread upload
+    Ready,
+    Failed,
+    Cancelled
+};
+
+/// <summary>
+/// One asynchronous load. Decode runs on a worker thread, the AssetLoader uploads the result and calls the completion callback
+/// on the main thread.
+/// </summary>
+class AssetRequest
+{
+public:
+    std::string path;
+    std::atomic<int> priority = 0; // Higher first, for decode and upload
+    uint64_t sequence = 0; // Request order, breaks priority ties
+    std::atomic<AssetState> state = AssetState::Queued;
+    std::atomic<bool> cancelRequested = false;
+    std::string error;
+    std::shared_ptr<void> result; // Set on the main thread when the upload succeeded, lives as long as the request
+    std::function<void()> onComplete;
+
+public:
+    virtual ~AssetRequest() = default;
+    virtual void decode() = 0;
+};
+
+/// <summary>
+/// Future of an asset load, copies share the same request.
+/// </summary>
+template<typename T>
+class AssetHandle
+{
+private:
+    std::shared_ptr<AssetRequest> request;
+
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<AssetRequest> request) : request(std::move(request)) {}
+
+    bool isValid() const { return request != nullptr; }
+    AssetState getState() const { return request ? request->state.load() : AssetState::Cancelled; }
+    bool isReady() const { return getState() == AssetState::Ready; }
+    bool isDone() const { AssetState state = getState(); return state == AssetState::Ready || state == AssetState::Failed || state == AssetState::Cancelled; }
+    const std::string& getPath() const { static const std::string empty; return request ? request->path : empty; }
+    const std::string& getError() const { static const std::string empty; return request ? request->error : empty; }
+
+    // Null until the asset is ready
+    std::shared_ptr<T> get() const { return isReady() ? std::static_pointer_cast<T>(request->result) : nullptr; }
+
+    int getPriority() const { return request ? request->priority.load() : 0; }
+
+    // Takes effect for a request that is not decoded yet or waits for its upload
+    void setPriority(int priority) const { if (request) request->priority = priority; }
+
+    // A cancelled request never calls its callback, a ready asset stays loaded
+    void cancel() const { if (request) request->cancelRequested = true; }
+};
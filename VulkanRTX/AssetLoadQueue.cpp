@@ -0,0 +1,63 @@
+#include "AssetLoadQueue.hpp"
+#include "ThreadPool.hpp"
+
+void AssetLoadQueue::run(std::function<std::vector<LoadedAsset>()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        runningJobs++;
+    }
+
+    ThreadPool::getShared().submit([this, job = std::move(job)]()
+    {
+        std::vector<LoadedAsset> loaded;
+        std::exception_ptr jobError;
+        try
+        {
+            loaded = job();
+        }
+        catch (...)
+        {
+            jobError = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (LoadedAsset& asset : loaded)
+        {
+            results.push_back(std::move(asset));
+        }
+        if (jobError && !error)
+        {
+            error = jobError;
+        }
+        runningJobs--;
+        idle.notify_all();
+    });
+}
+
+std::vector<LoadedAsset> AssetLoadQueue::take()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error)
+    {
+        std::exception_ptr jobError = error;
+        error = nullptr;
+        std::rethrow_exception(jobError);
+    }
+
+    std::vector<LoadedAsset> loaded;
+    loaded.swap(results);
+    return loaded;
+}
+
+bool AssetLoadQueue::isIdle()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return runningJobs == 0;
+}
+
+void AssetLoadQueue::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return runningJobs == 0; });
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "ObjLoader.hpp"
+#include "VulkanTexture.hpp"
+
+// An imported asset or baked static chunk handed from a loading job to the main thread
+struct LoadedAsset
+{
+    uint32_t assetIndex;
+    ModelInfo info;
+    DecodedTextures textures; // Material textures decoded by the job, the upload decodes missing ones
+};
+
+/// <summary>
+/// Runs asset jobs on the shared thread pool and collects their results, so the main thread can upload them between frames.
+/// The first exception thrown by a job is rethrown by take.
+/// </summary>
+class AssetLoadQueue
+{
+private:
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<LoadedAsset> results;
+    std::exception_ptr error;
+    size_t runningJobs = 0;
+
+public:
+    void run(std::function<std::vector<LoadedAsset>()> job);
+
+    /// <summary>
+    /// Returns the results of the jobs finished since the last call, in completion order.
+    /// </summary>
+    std::vector<LoadedAsset> take();
+
+    bool isIdle();
+
+    /// <summary>
+    /// Blocks until every job is done, their results stay queued.
+    /// </summary>
+    void wait();
+};
@@ -0,0 +1,388 @@
+#include "AssetLoader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "ImportSettings.hpp"
+#include "ModelImporter.hpp"
+#include "TextureManager.hpp"
+#include "ThreadPool.hpp"
+#include "VulkanGraphicsPipelineManager.hpp"
+
+namespace
+{
+    class ModelRequest : public AssetRequest
+    {
+    public:
+        ModelInfo info;
+        DecodedTextures textures;
+
+        void decode() override
+        {
+            info = ModelImporter::import(path);
+            textures = AssetLoader::decodeMaterialTextures(info);
+        }
+
+        // Uploaded alone, its material textures are batched by VulkanModelAsset::load
+        void upload(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+        {
+            VkDescriptorPool descriptorPool = VulkanGraphicsPipelineManager::createPool(context, 0, info.meshes.size(), 0);
+            std::unique_ptr<VulkanModelAsset> asset = std::make_unique<VulkanModelAsset>();
+            asset->sourcePath = path;
+            try
+            {
+                asset->load(info, context, commandBufferManager, descriptorPool, &textures);
+            }
+            catch (const std::exception&)
+            {
+                vkDestroyDescriptorPool(context.device, descriptorPool, nullptr);
+                throw;
+            }
+
+            // The last handle destroys the GPU data with the material descriptor pool of the asset
+            VkDevice device = context.device;
+            result = std::shared_ptr<VulkanModelAsset>(asset.release(), [device, descriptorPool](VulkanModelAsset* released)
+            {
+                released->cleanup(device);
+                vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+                delete released;
+            });
+
+            // The GPU copy is all that is needed from now on
+            info = ModelInfo();
+            textures.clear();
+        }
+    };
+
+    class TextureRequest : public AssetRequest
+    {
+    public:
+        VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+        TextureData data;
+
+        void decode() override
+        {
+            if (!TextureManager::isResident(path, format))
+            {
+                data = VulkanTexture::load(path, format);
+            }
+        }
+    };
+
+    // Uploads the decoded requests together through the TextureBatchLoader. The data of each request is moved into the batch,
+    // requests decode skipped because their texture was resident are decoded by the cache if it got released since
+    void uploadBatch(const std::vector<TextureRequest*>& requests, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+    {
+        std::vector<TextureBatchEntry> entries;
+        DecodedTextures decodedTextures;
+        for (TextureRequest* request : requests)
+        {
+            TextureBatchEntry entry;
+            entry.path = request->path;
+            entry.format = request->format;
+            entries.push_back(entry);
+            if (!request->data.pixels.empty())
+            {
+                decodedTextures.try_emplace(request->path, std::move(request->data));
+            }
+            request->data = TextureData();
+        }
+
+        AcquiredTextures textures;
+        try
+        {
+            textures = TextureManager::acquireBatch(entries, context, commandBufferManager, &decodedTextures);
+        }
+        catch (const std::exception&)
+        {
+            // Retried one by one below, so a failed upload only fails its own request
+        }
+
+        for (TextureRequest* request : requests)
+        {
+            auto it = textures.find({ request->path, request->format });
+            if (it != textures.end())
+            {
+                request->result = it->second;
+                request->state = AssetState::Ready;
+                continue;
+            }
+
+            try
+            {
+                auto decodedIt = decodedTextures.find(request->path);
+                request->result = TextureManager::acquire(request->path, request->format, context, commandBufferManager, decodedIt != decodedTextures.end() ? &decodedIt->second : nullptr);
+                request->state = AssetState::Ready;
+            }
+            catch (const std::exception& e)
+            {
+                request->error = e.what();
+                request->state = AssetState::Failed;
+            }
+        }
+    }
+
+    // Highest priority first, then request order
+    bool isBefore(const std::shared_ptr<AssetRequest>& a, const std::shared_ptr<AssetRequest>& b)
+    {
+        int priorityA = a->priority;
+        int priorityB = b->priority;
+        return priorityA != priorityB ? priorityA > priorityB : a->sequence < b->sequence;
+    }
+}
+
+std::mutex AssetLoader::mutex;
+std::condition_variable AssetLoader::idle;
+std::vector<std::shared_ptr<AssetRequest>> AssetLoader::queued;
+std::vector<std::shared_ptr<AssetRequest>> AssetLoader::decoded;
+size_t AssetLoader::decodingCount = 0;
+uint64_t AssetLoader::nextSequence = 0;
+float AssetLoader::uploadBudgetMs = 8.0f;
+uint64_t AssetLoader::uploadBatchBytes = 64ull * 1024 * 1024;
+
+AssetHandle<VulkanModelAsset> AssetLoader::loadModel(const std::string& path, int priority, std::function<void(const AssetHandle<VulkanModelAsset>&)> onComplete)
+{
+    std::shared_ptr<ModelRequest> request = std::make_shared<ModelRequest>();
+    request->path = path;
+    request->priority = priority;
+
+    AssetHandle<VulkanModelAsset> handle(request);
+    if (onComplete)
+    {
+        request->onComplete = [handle, onComplete]() { onComplete(handle); };
+    }
+    enqueue(request);
+    return handle;
+}
+
+AssetHandle<VulkanTexture> AssetLoader::loadTexture(const std::string& path, VkFormat format, int priority, std::function<void(const AssetHandle<VulkanTexture>&)> onComplete)
+{
+    std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>();
+    request->path = path;
+    request->priority = priority;
+    request->format = format;
+
+    AssetHandle<VulkanTexture> handle(request);
+    if (onComplete)
+    {
+        request->onComplete = [handle, onComplete]() { onComplete(handle); };
+    }
+    enqueue(request);
+    return handle;
+}
+
+DecodedTextures AssetLoader::decodeMaterialTextures(const ModelInfo& info)
+{
+    // Undecodable textures are left to the upload, which reports them like a synchronous load
+    DecodedTextures textures;
+    if (ImportSettings::streamTextures)
+    {
+        // The materials stream them in, the model does not wait for its textures
+        return textures;
+    }
+    for (const PBRMaterialInfo& material : info.materials)
+    {
+        for (const auto& [texturePath, format] : { std::make_pair(material.albedoTexture, VK_FORMAT_R8G8B8A8_SRGB), std::make_pair(material.bumpTexture, VK_FORMAT_R8G8B8A8_UNORM) })
+        {
+            if (texturePath.empty() || textures.count(texturePath) > 0 || TextureManager::isResident(texturePath, format)) continue;
+            try
+            {
+                textures.emplace(texturePath, VulkanTexture::load(texturePath, format));
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    }
+    return textures;
+}
+
+void AssetLoader::enqueue(const std::shared_ptr<AssetRequest>& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request->sequence = nextSequence++;
+        queued.push_back(request);
+    }
+
+    // Every task decodes the best queued request when it runs, not necessarily this one
+    ThreadPool::getShared().submit(&AssetLoader::decodeNext);
+}
+
+void AssetLoader::decodeNext()
+{
+    std::shared_ptr<AssetRequest> request;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Cancelled requests are dropped here, their callback holds a handle to the request
+        auto cancelled = std::partition(queued.begin(), queued.end(), [](const std::shared_ptr<AssetRequest>& queuedRequest) { return !queuedRequest->cancelRequested; });
+        for (auto it = cancelled; it != queued.end(); it++)
+        {
+            (*it)->state = AssetState::Cancelled;
+            (*it)->onComplete = nullptr;
+        }
+        queued.erase(cancelled, queued.end());
+
+        if (queued.empty())
+        {
+            idle.notify_all();
+            return;
+        }
+
+        auto best = std::min_element(queued.begin(), queued.end(), isBefore);
+        request = *best;
+        queued.erase(best);
+        request->state = AssetState::Decoding;
+        decodingCount++;
+    }
+
+    try
+    {
+        request->decode();
+    }
+    catch (const std::exception& e)
+    {
+        request->error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    request->state = request->error.empty() ? AssetState::Uploading : AssetState::Failed;
+    decoded.push_back(request);
+    decodingCount--;
+    idle.notify_all();
+}
+
+void AssetLoader::update(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+{
+    std::vector<std::shared_ptr<AssetRequest>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+    if (ready.empty())
+    {
+        return;
+    }
+    std::sort(ready.begin(), ready.end(), isBefore);
+
+    // Uploads wait on the graphics queue, keep them within the budget but always make progress. Each batch takes the next
+    // requests in priority order up to uploadBatchBytes of decoded data and is submitted at once
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t processed = 0;
+    bool uploaded = false;
+    while (processed < ready.size())
+    {
+        if (uploaded)
+        {
+            float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+            if (elapsed > uploadBudgetMs)
+            {
+                break;
+            }
+        }
+
+        size_t batchEnd = processed;
+        uint64_t batchBytes = 0;
+        std::vector<TextureRequest*> batch;
+        for (; batchEnd < ready.size(); batchEnd++)
+        {
+            const std::shared_ptr<AssetRequest>& request = ready[batchEnd];
+            if (request->cancelRequested)
+            {
+                request->state = AssetState::Cancelled;
+                request->onComplete = nullptr;
+            }
+            if (request->state != AssetState::Uploading) continue;
+
+            TextureRequest* textureRequest = dynamic_cast<TextureRequest*>(request.get());
+            if (!textureRequest)
+            {
+                // Models upload on their own, after the textures batched ahead of them
+                if (batch.empty())
+                {
+                    try
+                    {
+                        static_cast<ModelRequest*>(request.get())->upload(context, commandBufferManager);
+                        request->state = AssetState::Ready;
+                    }
+                    catch (const std::exception& e)
+                    {
+                        request->error = e.what();
+                        request->state = AssetState::Failed;
+                    }
+                    uploaded = true;
+                    batchEnd++;
+                }
+                break;
+            }
+
+            uint64_t bytes = textureRequest->data.pixels.size();
+            if (!batch.empty() && batchBytes + bytes > uploadBatchBytes)
+            {
+                break;
+            }
+            batch.push_back(textureRequest);
+            batchBytes += bytes;
+        }
+
+        if (!batch.empty())
+        {
+            uploadBatch(batch, context, commandBufferManager);
+            uploaded = true;
+        }
+
+        for (; processed < batchEnd; processed++)
+        {
+            const std::shared_ptr<AssetRequest>& request = ready[processed];
+            if (request->state == AssetState::Cancelled) continue;
+
+            if (request->state == AssetState::Failed)
+            {
+                std::cerr << "Could not load " << request->path << ": " << request->error << std::endl;
+            }
+
+            // Cleared before the call so the request does not keep its own handle alive
+            std::function<void()> onComplete = std::move(request->onComplete);
+            request->onComplete = nullptr;
+            if (onComplete)
+            {
+                onComplete();
+            }
+        }
+    }
+
+    // Over budget: the rest waits for the next frame, ahead of newer decodes of the same priority
+    if (processed < ready.size())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.insert(decoded.begin(), ready.begin() + processed, ready.end());
+    }
+}
+
+size_t AssetLoader::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued.size() + decodingCount + decoded.size();
+}
+
+void AssetLoader::cleanup()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (const std::shared_ptr<AssetRequest>& request : queued)
+        {
+            request->cancelRequested = true;
+            request->state = AssetState::Cancelled;
+            request->onComplete = nullptr;
+        }
+        queued.clear();
+        idle.wait(lock, [] { return decodingCount == 0; });
+
+        for (const std::shared_ptr<AssetRequest>& request : decoded)
+        {
+            request->state = AssetState::Cancelled;
+            request->onComplete = nullptr;
+        }
+        decoded.clear();
+    }
+}
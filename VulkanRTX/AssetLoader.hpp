@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AssetHandle.hpp"
+#include "ObjLoader.hpp"
+#include "VulkanModelAsset.hpp"
+#include "VulkanTexture.hpp"
+
+/// <summary>
+/// Asynchronous model and texture loading. Requests are decoded on the shared thread pool in priority order: model import
+/// with its material textures, or image decode. The main thread uploads decoded requests in update, highest priority first
+/// within a time budget, textures in batches of one TextureBatchLoader submission and models one at a time, then calls
+/// their completion callbacks. Uploads stay on the main thread because the renderer submits to the same graphics queue.
+/// Loaded assets are owned by their handles: a model is released with the last handle to its request, a texture with that
+/// and the last user of the cached texture. Handles must outlive the frames using their asset.
+/// </summary>
+class AssetLoader
+{
+private:
+    static std::mutex mutex;
+    static std::condition_variable idle;
+    static std::vector<std::shared_ptr<AssetRequest>> queued; // Waiting for a worker
+    static std::vector<std::shared_ptr<AssetRequest>> decoded; // Waiting for the main thread, failures included
+    static size_t decodingCount;
+    static uint64_t nextSequence;
+
+    static void enqueue(const std::shared_ptr<AssetRequest>& request);
+    static void decodeNext();
+
+public:
+    static float uploadBudgetMs; // Main thread time spent uploading per update, at least one batch always runs
+    static uint64_t uploadBatchBytes; // Decoded data uploaded by one batch, a larger texture gets its own
+
+    /// <summary>
+    /// Imports a model with ModelImporter, its material textures are decoded on the same worker.
+    /// The asset has its own material descriptor pool; models placing it allocate their sets from the caller's pool.
+    /// </summary>
+    static AssetHandle<VulkanModelAsset> loadModel(const std::string& path, int priority = 0, std::function<void(const AssetHandle<VulkanModelAsset>&)> onComplete = nullptr);
+
+    static AssetHandle<VulkanTexture> loadTexture(const std::string& path, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, int priority = 0, std::function<void(const AssetHandle<VulkanTexture>&)> onComplete = nullptr);
+
+    /// <summary>
+    /// Loads the albedo and bump maps of every material with VulkanTexture::load, any thread. Files already resident in the
+    /// TextureManager or that fail to decode are skipped, the upload handles them. Nothing is decoded with
+    /// ImportSettings::streamTextures.
+    /// </summary>
+    static DecodedTextures decodeMaterialTextures(const ModelInfo& info);
+
+    /// <summary>
+    /// Main thread, once per frame: uploads decoded requests and runs the callbacks of finished ones.
+    /// </summary>
+    static void update(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
+
+    // Requests not finished yet
+    static size_t getPendingCount();
+
+    /// <summary>
+    /// Cancels pending requests and waits for running decodes.
+    /// </summary>
+    static void cleanup();
+};
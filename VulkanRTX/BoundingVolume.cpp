@@ -0,0 +1,125 @@
+#include "BoundingVolume.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "VulkanGeometry.hpp"
+
+#include <emmintrin.h>
+
+namespace
+{
+    // Loads the position of a vertex in the low three lanes, the last lane reads the next member of the vertex
+    __m128 loadPosition(const VulkanVertex& vertex)
+    {
+        static_assert(offsetof(VulkanVertex, pos) + sizeof(float) * 4 <= sizeof(VulkanVertex), "position load reads past the vertex");
+        return _mm_loadu_ps(&vertex.pos.x);
+    }
+}
+
+void BoundingVolume::grow(const BoundingVolume& other)
+{
+    if (other.isEmpty())
+    {
+        return;
+    }
+    if (isEmpty())
+    {
+        *this = other;
+        return;
+    }
+
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+
+    glm::vec3 mergedCenter = (min + max) * 0.5f;
+    float mergedRadius = std::max(glm::distance(mergedCenter, center) + radius, glm::distance(mergedCenter, other.center) + other.radius);
+    center = mergedCenter;
+    radius = mergedRadius;
+}
+
+BoundingVolume BoundingVolume::transform(const glm::mat4& matrix) const
+{
+    if (isEmpty())
+    {
+        return *this;
+    }
+
+    BoundingVolume result;
+    glm::vec3 translation(matrix[3]);
+    result.min = translation;
+    result.max = translation;
+    for (int column = 0; column < 3; column++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            float a = matrix[column][row] * min[column];
+            float b = matrix[column][row] * max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+
+    float maxScale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    result.radius = radius * maxScale;
+    return result;
+}
+
+BoundingVolume BoundingVolume::compute(const std::vector<VulkanVertex>& vertices)
+{
+    BoundingVolume bounds;
+    if (vertices.empty())
+    {
+        return bounds;
+    }
+
+    // Four independent accumulators hide the min/max latency
+    __m128 minimum[4];
+    __m128 maximum[4];
+    for (int i = 0; i < 4; i++)
+    {
+        minimum[i] = _mm_set1_ps(FLT_MAX);
+        maximum[i] = _mm_set1_ps(-FLT_MAX);
+    }
+
+    size_t count = vertices.size();
+    size_t v = 0;
+    for (; v + 4 <= count; v += 4)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            __m128 position = loadPosition(vertices[v + i]);
+            minimum[i] = _mm_min_ps(minimum[i], position);
+            maximum[i] = _mm_max_ps(maximum[i], position);
+        }
+    }
+    for (; v < count; v++)
+    {
+        __m128 position = loadPosition(vertices[v]);
+        minimum[0] = _mm_min_ps(minimum[0], position);
+        maximum[0] = _mm_max_ps(maximum[0], position);
+    }
+
+    __m128 boxMin = _mm_min_ps(_mm_min_ps(minimum[0], minimum[1]), _mm_min_ps(minimum[2], minimum[3]));
+    __m128 boxMax = _mm_max_ps(_mm_max_ps(maximum[0], maximum[1]), _mm_max_ps(maximum[2], maximum[3]));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, boxMin);
+    bounds.min = glm::vec3(lanes[0], lanes[1], lanes[2]);
+    _mm_store_ps(lanes, boxMax);
+    bounds.max = glm::vec3(lanes[0], lanes[1], lanes[2]);
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+    // Farthest squared distance from the center, the last lane is masked out
+    const __m128 center = _mm_setr_ps(bounds.center.x, bounds.center.y, bounds.center.z, 0.0f);
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    __m128 farthest = _mm_setzero_ps();
+    for (const VulkanVertex& vertex : vertices)
+    {
+        __m128 offset = _mm_and_ps(_mm_sub_ps(loadPosition(vertex), center), xyzMask);
+        __m128 squared = _mm_mul_ps(offset, offset);
+        __m128 distance = _mm_add_ss(_mm_add_ss(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 2, 2, 2)));
+        farthest = _mm_max_ss(farthest, distance);
+    }
+    bounds.radius = std::sqrt(_mm_cvtss_f32(farthest));
+    return bounds;
+}
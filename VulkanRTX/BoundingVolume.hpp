@@ -0,0 +1,37 @@
+#pragma once
+#include <cfloat>
+#include <vector>
+#include "GLM_defines.hpp"
+
+struct VulkanVertex;
+
+/// <summary>
+/// Axis aligned box and bounding sphere of a set of points. Empty until grown, an empty volume stays empty when transformed.
+/// The sphere is centered on the box and reaches the farthest point, which is tighter than the box corners.
+/// </summary>
+struct BoundingVolume
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = -1.0f;
+
+    bool isEmpty() const { return radius < 0.0f; }
+    glm::vec3 getExtent() const { return isEmpty() ? glm::vec3(0.0f) : max - min; }
+
+    /// <summary>
+    /// Encloses both volumes. The sphere encloses both spheres, centered on the merged box.
+    /// </summary>
+    void grow(const BoundingVolume& other);
+
+    /// <summary>
+    /// Box enclosing the transformed box (Arvo, "Transforming Axis-Aligned Bounding Boxes"), sphere scaled by the largest
+    /// axis scale of the transform.
+    /// </summary>
+    BoundingVolume transform(const glm::mat4& matrix) const;
+
+    /// <summary>
+    /// Bounds of the vertex positions, four vertices at a time with SSE.
+    /// </summary>
+    static BoundingVolume compute(const std::vector<VulkanVertex>& vertices);
+};
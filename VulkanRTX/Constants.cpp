@@ -13,7 +13,6 @@ const int RT_MISS_SHADER_INDEX = 1;
 const int RT_MAX_SAMPLES = 100000;
 const int RT_CLOSEST_HIT_GENERAL_SHADER_INDEX = 2;
 
-const int MAX_MESHES = 2048;
 const int FULLSCREEN_QUAD_COUNT = 1;
 
 #ifdef NDEBUG
@@ -20,5 +20,4 @@ extern const int RT_MISS_SHADER_INDEX;
 extern const int RT_MAX_SAMPLES;
 extern const int RT_CLOSEST_HIT_GENERAL_SHADER_INDEX;
 
-extern const int MAX_MESHES;
 extern const int FULLSCREEN_QUAD_COUNT;
\ No newline at end of file
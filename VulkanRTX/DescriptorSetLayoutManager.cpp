@@ -1,5 +1,6 @@
 #include "DescriptorSetLayoutManager.hpp"
 #include <stdexcept>
+#include <algorithm>
 #include <array>
 #include "Constants.hpp"
 
@@ -7,6 +8,7 @@ VkDescriptorSetLayout DescriptorSetLayoutManager::modelLayout = VK_NULL_HANDLE;
 VkDescriptorSetLayout DescriptorSetLayoutManager::materialLayout = VK_NULL_HANDLE;
 VkDescriptorSetLayout DescriptorSetLayoutManager::fullScreenQuadLayout = VK_NULL_HANDLE;
 VkDescriptorSetLayout DescriptorSetLayoutManager::rayTracingDescriptorSetLayout = VK_NULL_HANDLE;
+uint32_t DescriptorSetLayoutManager::maxMaterialTextures = 0;
 
 void DescriptorSetLayoutManager::createLayouts(const VulkanContext& context)
 {
@@ -186,22 +188,6 @@ void DescriptorSetLayoutManager::createRayTracingDescriptorSetLayout(const Vulka
     instanceDataBufferBinding.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
     instanceDataBufferBinding.pImmutableSamplers = nullptr;
 
-    // Textures array
-    VkDescriptorSetLayoutBinding instancesAlbedoBinding{};
-    instancesAlbedoBinding.binding = binding++;
-    instancesAlbedoBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    instancesAlbedoBinding.descriptorCount = MAX_MESHES;
-    instancesAlbedoBinding.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
-    instancesAlbedoBinding.pImmutableSamplers = nullptr;
-
-    // Textures array
-    VkDescriptorSetLayoutBinding instancesNormalBinding{};
-    instancesNormalBinding.binding = binding++;
-    instancesNormalBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    instancesNormalBinding.descriptorCount = MAX_MESHES;
-    instancesNormalBinding.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
-    instancesNormalBinding.pImmutableSamplers = nullptr;
-
     // GBuffer
     VkDescriptorSetLayoutBinding depthBinding{};
     depthBinding.binding = binding++;
@@ -232,7 +218,23 @@ void DescriptorSetLayoutManager::createRayTracingDescriptorSetLayout(const Vulka
     lastImageBinding.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
     lastImageBinding.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 13> bindings =
+    // Material textures, albedo and normal map of every mesh interleaved. Only the last binding can have a variable count,
+    // the layout declares the device maximum and each allocated set the count of its scene.
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physicalDevice, &properties);
+    const VkPhysicalDeviceLimits& limits = properties.limits;
+    uint32_t stageLimit = std::min(limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages);
+    uint32_t setLimit = std::min(limits.maxDescriptorSetSamplers, limits.maxDescriptorSetSampledImages) - 4; // G-Buffer and accumulation
+    maxMaterialTextures = std::min(stageLimit, setLimit);
+
+    VkDescriptorSetLayoutBinding materialTexturesBinding{};
+    materialTexturesBinding.binding = binding++;
+    materialTexturesBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    materialTexturesBinding.descriptorCount = maxMaterialTextures;
+    materialTexturesBinding.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+    materialTexturesBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 12> bindings =
     {
         tlasBinding,
         storageImageBinding,
@@ -241,16 +243,25 @@ void DescriptorSetLayoutManager::createRayTracingDescriptorSetLayout(const Vulka
         indexBufferBinding,
         meshDataBufferBinding,
         instanceDataBufferBinding,
-        instancesAlbedoBinding,
-        instancesNormalBinding,
         depthBinding,
         normalsBinding,
         albedoBinding,
-        lastImageBinding
+        lastImageBinding,
+        materialTexturesBinding
     };
 
+    // Slots past the scene texture count are never written
+    std::array<VkDescriptorBindingFlags, 12> bindingFlags{};
+    bindingFlags.back() = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
     layoutInfo.pBindings = bindings.data();
 
@@ -296,6 +307,11 @@ VkDescriptorSetLayout DescriptorSetLayoutManager::getRayTracingLayout()
     return rayTracingDescriptorSetLayout;
 }
 
+uint32_t DescriptorSetLayoutManager::getMaxMaterialTextures()
+{
+    return maxMaterialTextures;
+}
+
 void DescriptorSetLayoutManager::cleanup(VkDevice device)
 {
     if (modelLayout != VK_NULL_HANDLE)
@@ -9,6 +9,7 @@ private:
 	static VkDescriptorSetLayout materialLayout;
 	static VkDescriptorSetLayout fullScreenQuadLayout;
 	static VkDescriptorSetLayout rayTracingDescriptorSetLayout;
+	static uint32_t maxMaterialTextures;
 
 public:
 	static void createLayouts(const VulkanContext& context);
@@ -22,5 +23,8 @@ public:
 	static VkDescriptorSetLayout getFullScreenQuadLayout();
 	static VkDescriptorSetLayout getRayTracingLayout();
 
+	// Upper bound of the variable-count material texture array of the ray tracing layout, from the device limits
+	static uint32_t getMaxMaterialTextures();
+
 	static void cleanup(VkDevice device);
 };
\ No newline at end of file
@@ -0,0 +1,695 @@
+#include "FastObjParser.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    // Chunks below this size are not worth a task of their own
+    constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+    constexpr size_t CHUNKS_PER_WORKER = 4;
+
+    enum class StatementType
+    {
+        Group,
+        Object,
+        UseMaterial,
+        MaterialLibrary
+    };
+
+    // Statements that change how the faces following them are grouped, in file order
+    struct Statement
+    {
+        StatementType type;
+        size_t faceIndex;     // Faces of the chunk parsed before this statement
+        size_t triangleIndex; // Same position in the triangulated faces
+        std::string value;
+    };
+
+    struct Chunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        size_t vertexCount = 0;
+        size_t normalCount = 0;
+        size_t texCoordCount = 0;
+        size_t vertexBase = 0;
+        size_t normalBase = 0;
+        size_t texCoordBase = 0;
+
+        std::vector<tinyobj::index_t> corners;
+        std::vector<uint32_t> faceSizes;
+        std::vector<tinyobj::index_t> triangles;
+        std::vector<Statement> statements;
+    };
+
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && (isBlank(text.front()) || text.front() == '\r')) text.remove_prefix(1);
+        while (!text.empty() && (isBlank(text.back()) || text.back() == '\r')) text.remove_suffix(1);
+        return text;
+    }
+
+    // Returns the line starting at cursor without its line break and moves cursor to the next line
+    std::string_view nextLine(const char*& cursor, const char* end)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (lineEnd == nullptr) lineEnd = end;
+
+        std::string_view line(cursor, lineEnd - cursor);
+        cursor = lineEnd < end ? lineEnd + 1 : end;
+
+        while (!line.empty() && isBlank(line.front())) line.remove_prefix(1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    }
+
+    // Splits "keyword arguments" and returns the keyword
+    std::string_view splitKeyword(std::string_view line, std::string_view& arguments)
+    {
+        size_t keywordEnd = 0;
+        while (keywordEnd < line.size() && !isBlank(line[keywordEnd])) keywordEnd++;
+        arguments = line.substr(keywordEnd);
+        return line.substr(0, keywordEnd);
+    }
+
+    bool parseFloat(std::string_view& text, float& value)
+    {
+        size_t start = 0;
+        while (start < text.size() && isBlank(text[start])) start++;
+        if (start < text.size() && text[start] == '+') start++;
+
+        const char* first = text.data() + start;
+        const char* last = text.data() + text.size();
+        std::from_chars_result result = std::from_chars(first, last, value);
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+        text.remove_prefix(result.ptr - text.data());
+        return true;
+    }
+
+    float parseFloatOr(std::string_view& text, float fallback)
+    {
+        float value;
+        return parseFloat(text, value) ? value : fallback;
+    }
+
+    bool parseInt(const char*& cursor, const char* end, int& value)
+    {
+        bool negative = false;
+        if (cursor < end && (*cursor == '-' || *cursor == '+'))
+        {
+            negative = *cursor == '-';
+            cursor++;
+        }
+
+        if (cursor >= end || *cursor < '0' || *cursor > '9')
+        {
+            return false;
+        }
+
+        int result = 0;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9')
+        {
+            result = result * 10 + (*cursor - '0');
+            cursor++;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    // OBJ indices are 1 based, negative ones count back from the last element parsed so far
+    int resolveIndex(int index, size_t countSoFar)
+    {
+        if (index > 0) return index - 1;
+        if (index < 0) return static_cast<int>(countSoFar) + index;
+        throw std::runtime_error("Invalid OBJ face index 0");
+    }
+
+    void countAttributes(Chunk& chunk)
+    {
+        const char* cursor = chunk.begin;
+        while (cursor < chunk.end)
+        {
+            std::string_view line = nextLine(cursor, chunk.end);
+            if (line.empty() || line[0] != 'v') continue;
+
+            // Classified like parseChunk, which fills exactly the counted slots
+            std::string_view arguments;
+            std::string_view keyword = splitKeyword(line, arguments);
+            if (keyword == "v") chunk.vertexCount++;
+            else if (keyword == "vn") chunk.normalCount++;
+            else if (keyword == "vt") chunk.texCoordCount++;
+        }
+    }
+
+    void parseFace(std::string_view arguments, Chunk& chunk, size_t vertexCount, size_t normalCount, size_t texCoordCount)
+    {
+        const char* cursor = arguments.data();
+        const char* end = cursor + arguments.size();
+        uint32_t faceSize = 0;
+
+        while (true)
+        {
+            while (cursor < end && (isBlank(*cursor) || *cursor == '\r')) cursor++;
+            if (cursor >= end) break;
+
+            // v, v/vt, v//vn or v/vt/vn
+            tinyobj::index_t corner{ -1, -1, -1 };
+            int value;
+            if (!parseInt(cursor, end, value))
+            {
+                throw std::runtime_error("Failed to parse OBJ face: " + std::string(arguments));
+            }
+            corner.vertex_index = resolveIndex(value, vertexCount);
+
+            if (cursor < end && *cursor == '/')
+            {
+                cursor++;
+                if (cursor < end && *cursor != '/')
+                {
+                    if (!parseInt(cursor, end, value))
+                    {
+                        throw std::runtime_error("Failed to parse OBJ face: " + std::string(arguments));
+                    }
+                    corner.texcoord_index = resolveIndex(value, texCoordCount);
+                }
+                if (cursor < end && *cursor == '/')
+                {
+                    cursor++;
+                    if (!parseInt(cursor, end, value))
+                    {
+                        throw std::runtime_error("Failed to parse OBJ face: " + std::string(arguments));
+                    }
+                    corner.normal_index = resolveIndex(value, normalCount);
+                }
+            }
+
+            chunk.corners.push_back(corner);
+            faceSize++;
+        }
+
+        chunk.faceSizes.push_back(faceSize);
+    }
+
+    void checkAttributeCount(size_t index, size_t base, size_t count, const char* keyword)
+    {
+        if (index >= base + count)
+        {
+            throw std::runtime_error(std::string("OBJ chunk has more '") + keyword + "' lines than counted");
+        }
+    }
+
+    void parseChunk(Chunk& chunk, tinyobj::attrib_t& attrib)
+    {
+        size_t vertexCount = chunk.vertexBase;
+        size_t normalCount = chunk.normalBase;
+        size_t texCoordCount = chunk.texCoordBase;
+
+        const char* cursor = chunk.begin;
+        while (cursor < chunk.end)
+        {
+            std::string_view line = nextLine(cursor, chunk.end);
+            if (line.empty() || line[0] == '#') continue;
+
+            std::string_view arguments;
+            std::string_view keyword = splitKeyword(line, arguments);
+
+            if (keyword == "v")
+            {
+                checkAttributeCount(vertexCount, chunk.vertexBase, chunk.vertexCount, "v");
+                float* position = &attrib.vertices[vertexCount * 3];
+                position[0] = parseFloatOr(arguments, 0.0f);
+                position[1] = parseFloatOr(arguments, 0.0f);
+                position[2] = parseFloatOr(arguments, 0.0f);
+                vertexCount++;
+            }
+            else if (keyword == "vn")
+            {
+                checkAttributeCount(normalCount, chunk.normalBase, chunk.normalCount, "vn");
+                float* normal = &attrib.normals[normalCount * 3];
+                normal[0] = parseFloatOr(arguments, 0.0f);
+                normal[1] = parseFloatOr(arguments, 0.0f);
+                normal[2] = parseFloatOr(arguments, 0.0f);
+                normalCount++;
+            }
+            else if (keyword == "vt")
+            {
+                checkAttributeCount(texCoordCount, chunk.texCoordBase, chunk.texCoordCount, "vt");
+                float* texCoord = &attrib.texcoords[texCoordCount * 2];
+                texCoord[0] = parseFloatOr(arguments, 0.0f);
+                texCoord[1] = parseFloatOr(arguments, 0.0f);
+                texCoordCount++;
+            }
+            else if (keyword == "f")
+            {
+                parseFace(arguments, chunk, vertexCount, normalCount, texCoordCount);
+            }
+            else if (keyword == "g" || keyword == "o" || keyword == "usemtl" || keyword == "mtllib")
+            {
+                Statement statement;
+                statement.type = keyword == "g" ? StatementType::Group
+                    : keyword == "o" ? StatementType::Object
+                    : keyword == "usemtl" ? StatementType::UseMaterial
+                    : StatementType::MaterialLibrary;
+                statement.faceIndex = chunk.faceSizes.size();
+                statement.triangleIndex = 0;
+
+                if (statement.type == StatementType::Group)
+                {
+                    // Several group names are joined with single spaces
+                    std::string_view names = trim(arguments);
+                    while (!names.empty())
+                    {
+                        size_t nameEnd = 0;
+                        while (nameEnd < names.size() && !isBlank(names[nameEnd])) nameEnd++;
+                        if (!statement.value.empty()) statement.value += ' ';
+                        statement.value.append(names.substr(0, nameEnd));
+                        names = trim(names.substr(nameEnd));
+                    }
+                }
+                else
+                {
+                    statement.value = std::string(trim(arguments));
+                }
+                chunk.statements.push_back(std::move(statement));
+            }
+        }
+    }
+
+    float squaredDistance(const tinyobj::attrib_t& attrib, int a, int b)
+    {
+        float dx = attrib.vertices[a * 3 + 0] - attrib.vertices[b * 3 + 0];
+        float dy = attrib.vertices[a * 3 + 1] - attrib.vertices[b * 3 + 1];
+        float dz = attrib.vertices[a * 3 + 2] - attrib.vertices[b * 3 + 2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void triangulateChunk(Chunk& chunk, const tinyobj::attrib_t& attrib)
+    {
+        size_t vertexCount = attrib.vertices.size() / 3;
+        size_t normalCount = attrib.normals.size() / 3;
+        size_t texCoordCount = attrib.texcoords.size() / 2;
+        chunk.triangles.reserve(chunk.corners.size());
+
+        size_t statementIndex = 0;
+        size_t corner = 0;
+        for (size_t face = 0; face <= chunk.faceSizes.size(); face++)
+        {
+            while (statementIndex < chunk.statements.size() && chunk.statements[statementIndex].faceIndex == face)
+            {
+                chunk.statements[statementIndex++].triangleIndex = chunk.triangles.size() / 3;
+            }
+            if (face == chunk.faceSizes.size()) break;
+
+            const tinyobj::index_t* c = &chunk.corners[corner];
+            uint32_t faceSize = chunk.faceSizes[face];
+            corner += faceSize;
+
+            for (uint32_t i = 0; i < faceSize; i++)
+            {
+                if (c[i].vertex_index < 0 || static_cast<size_t>(c[i].vertex_index) >= vertexCount
+                    || c[i].normal_index >= static_cast<int>(normalCount) || c[i].texcoord_index >= static_cast<int>(texCoordCount)
+                    || c[i].normal_index < -1 || c[i].texcoord_index < -1)
+                {
+                    throw std::runtime_error("OBJ face references a missing vertex attribute");
+                }
+            }
+
+            if (faceSize < 3)
+            {
+                // Points and lines written as faces are dropped
+                continue;
+            }
+
+            if (faceSize == 4)
+            {
+                // Split quads along their shortest diagonal
+                if (squaredDistance(attrib, c[0].vertex_index, c[2].vertex_index) < squaredDistance(attrib, c[1].vertex_index, c[3].vertex_index))
+                {
+                    chunk.triangles.insert(chunk.triangles.end(), { c[0], c[1], c[2], c[0], c[2], c[3] });
+                }
+                else
+                {
+                    chunk.triangles.insert(chunk.triangles.end(), { c[0], c[1], c[3], c[1], c[2], c[3] });
+                }
+                continue;
+            }
+
+            for (uint32_t i = 1; i + 1 < faceSize; i++)
+            {
+                chunk.triangles.insert(chunk.triangles.end(), { c[0], c[i], c[i + 1] });
+            }
+        }
+
+        chunk.corners.clear();
+        chunk.corners.shrink_to_fit();
+    }
+
+    void initMaterial(tinyobj::material_t& material)
+    {
+        material = tinyobj::material_t();
+        for (int i = 0; i < 3; i++)
+        {
+            material.ambient[i] = 0.0f;
+            material.diffuse[i] = 0.0f;
+            material.specular[i] = 0.0f;
+            material.transmittance[i] = 0.0f;
+            material.emission[i] = 0.0f;
+        }
+        material.shininess = 1.0f;
+        material.ior = 1.0f;
+        material.dissolve = 1.0f;
+        material.illum = 0;
+        material.roughness = 0.0f;
+        material.metallic = 0.0f;
+        material.sheen = 0.0f;
+        material.clearcoat_thickness = 0.0f;
+        material.clearcoat_roughness = 0.0f;
+        material.anisotropy = 0.0f;
+        material.anisotropy_rotation = 0.0f;
+    }
+
+    void parseColor(std::string_view arguments, float color[3])
+    {
+        color[0] = parseFloatOr(arguments, 0.0f);
+        color[1] = parseFloatOr(arguments, color[0]);
+        color[2] = parseFloatOr(arguments, color[1]);
+    }
+
+    // Texture statements may carry options such as "-bm 1.0", the file name is the last argument
+    std::string parseTextureName(std::string_view arguments)
+    {
+        arguments = trim(arguments);
+        size_t nameStart = arguments.size();
+        while (nameStart > 0 && !isBlank(arguments[nameStart - 1])) nameStart--;
+        return std::string(arguments.substr(nameStart));
+    }
+}
+
+bool FastObjParser::parseMtl(const std::string& mtlPath, std::vector<tinyobj::material_t>& materials, std::map<std::string, int>& materialMap)
+{
+    MappedFile file;
+    if (!file.open(mtlPath))
+    {
+        return false;
+    }
+
+    tinyobj::material_t material;
+    initMaterial(material);
+
+    auto flush = [&]()
+    {
+        if (!material.name.empty())
+        {
+            materialMap.emplace(material.name, static_cast<int>(materials.size()));
+            materials.push_back(material);
+        }
+    };
+
+    const char* cursor = file.data();
+    const char* end = cursor + file.size();
+    while (cursor < end)
+    {
+        std::string_view line = nextLine(cursor, end);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::string_view arguments;
+        std::string_view keyword = splitKeyword(line, arguments);
+
+        if (keyword == "newmtl")
+        {
+            flush();
+            initMaterial(material);
+            material.name = std::string(trim(arguments));
+        }
+        else if (keyword == "Ka") parseColor(arguments, material.ambient);
+        else if (keyword == "Kd") parseColor(arguments, material.diffuse);
+        else if (keyword == "Ks") parseColor(arguments, material.specular);
+        else if (keyword == "Ke") parseColor(arguments, material.emission);
+        else if (keyword == "Kt" || keyword == "Tf") parseColor(arguments, material.transmittance);
+        else if (keyword == "Ns") material.shininess = parseFloatOr(arguments, material.shininess);
+        else if (keyword == "Ni") material.ior = parseFloatOr(arguments, material.ior);
+        else if (keyword == "d") material.dissolve = parseFloatOr(arguments, material.dissolve);
+        else if (keyword == "Tr") material.dissolve = 1.0f - parseFloatOr(arguments, 0.0f);
+        else if (keyword == "illum") material.illum = static_cast<int>(parseFloatOr(arguments, 0.0f));
+        else if (keyword == "Pr") material.roughness = parseFloatOr(arguments, material.roughness);
+        else if (keyword == "Pm") material.metallic = parseFloatOr(arguments, material.metallic);
+        else if (keyword == "Ps") material.sheen = parseFloatOr(arguments, material.sheen);
+        else if (keyword == "map_Ka") material.ambient_texname = parseTextureName(arguments);
+        else if (keyword == "map_Kd") material.diffuse_texname = parseTextureName(arguments);
+        else if (keyword == "map_Ks") material.specular_texname = parseTextureName(arguments);
+        else if (keyword == "map_Ns") material.specular_highlight_texname = parseTextureName(arguments);
+        else if (keyword == "map_bump" || keyword == "map_Bump" || keyword == "bump") material.bump_texname = parseTextureName(arguments);
+        else if (keyword == "map_d") material.alpha_texname = parseTextureName(arguments);
+        else if (keyword == "disp") material.displacement_texname = parseTextureName(arguments);
+        else if (keyword == "refl") material.reflection_texname = parseTextureName(arguments);
+        else if (keyword == "map_Pr") material.roughness_texname = parseTextureName(arguments);
+        else if (keyword == "map_Pm") material.metallic_texname = parseTextureName(arguments);
+        else if (keyword == "map_Ps") material.sheen_texname = parseTextureName(arguments);
+        else if (keyword == "map_Ke") material.emissive_texname = parseTextureName(arguments);
+        else if (keyword == "norm") material.normal_texname = parseTextureName(arguments);
+    }
+
+    flush();
+    return true;
+}
+
+void FastObjParser::parse(const std::string& objPath, tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials)
+{
+    MappedFile file;
+    if (!file.open(objPath))
+    {
+        throw std::runtime_error("Failed to open OBJ: " + objPath);
+    }
+
+    std::string baseDir = objPath.substr(0, objPath.find_last_of("/\\") + 1);
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // Cut the file into line aligned chunks
+    ThreadPool& pool = ThreadPool::getShared();
+    size_t chunkCount = std::max<size_t>(1, std::min(size / MIN_CHUNK_SIZE, pool.getWorkerCount() * CHUNKS_PER_WORKER));
+    std::vector<Chunk> chunks(chunkCount);
+
+    const char* chunkStart = data;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        const char* chunkEnd = data + size * (i + 1) / chunkCount;
+        if (i + 1 < chunkCount)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', data + size - chunkEnd));
+            chunkEnd = lineEnd ? lineEnd + 1 : data + size;
+        }
+        chunkEnd = std::max(chunkStart, chunkEnd);
+
+        chunks[i].begin = chunkStart;
+        chunks[i].end = chunkEnd;
+        chunkStart = chunkEnd;
+    }
+
+    // Pass 1: attribute counts give every chunk its offset in the merged arrays
+    pool.parallelFor(chunkCount, [&](size_t i)
+    {
+        countAttributes(chunks[i]);
+    });
+
+    size_t vertexCount = 0;
+    size_t normalCount = 0;
+    size_t texCoordCount = 0;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.vertexBase = vertexCount;
+        chunk.normalBase = normalCount;
+        chunk.texCoordBase = texCoordCount;
+        vertexCount += chunk.vertexCount;
+        normalCount += chunk.normalCount;
+        texCoordCount += chunk.texCoordCount;
+    }
+
+    attrib = tinyobj::attrib_t();
+    attrib.vertices.resize(vertexCount * 3);
+    attrib.normals.resize(normalCount * 3);
+    attrib.texcoords.resize(texCoordCount * 2);
+
+    // Pass 2: parse attributes in place and collect faces and statements per chunk
+    pool.parallelFor(chunkCount, [&](size_t i)
+    {
+        parseChunk(chunks[i], attrib);
+    });
+
+    // Pass 3: triangulate, quads need the final positions
+    pool.parallelFor(chunkCount, [&](size_t i)
+    {
+        triangulateChunk(chunks[i], attrib);
+    });
+
+    // Stitch groups and materials in file order
+    shapes.clear();
+    materials.clear();
+    std::map<std::string, int> materialMap;
+    bool materialLibraryLoaded = false;
+
+    tinyobj::shape_t shape;
+    int materialId = -1;
+
+    auto appendTriangles = [&](const Chunk& chunk, size_t first, size_t last)
+    {
+        if (last <= first) return;
+        shape.mesh.indices.insert(shape.mesh.indices.end(), chunk.triangles.begin() + first * 3, chunk.triangles.begin() + last * 3);
+        shape.mesh.num_face_vertices.insert(shape.mesh.num_face_vertices.end(), last - first, 3);
+        shape.mesh.material_ids.insert(shape.mesh.material_ids.end(), last - first, materialId);
+        shape.mesh.smoothing_group_ids.insert(shape.mesh.smoothing_group_ids.end(), last - first, 0);
+    };
+
+    auto startShape = [&](const std::string& name)
+    {
+        if (!shape.mesh.indices.empty())
+        {
+            shapes.push_back(std::move(shape));
+        }
+        shape = tinyobj::shape_t();
+        shape.name = name;
+    };
+
+    for (const Chunk& chunk : chunks)
+    {
+        size_t triangle = 0;
+        for (const Statement& statement : chunk.statements)
+        {
+            appendTriangles(chunk, triangle, statement.triangleIndex);
+            triangle = statement.triangleIndex;
+
+            switch (statement.type)
+            {
+            case StatementType::Group:
+            case StatementType::Object:
+                startShape(statement.value);
+                break;
+            case StatementType::UseMaterial:
+            {
+                auto found = materialMap.find(statement.value);
+                materialId = found != materialMap.end() ? found->second : -1;
+                break;
+            }
+            case StatementType::MaterialLibrary:
+            {
+                // Like tinyobj, only the first library that can be opened is used
+                std::string_view names = statement.value;
+                while (!materialLibraryLoaded && !names.empty())
+                {
+                    size_t nameEnd = 0;
+                    while (nameEnd < names.size() && !isBlank(names[nameEnd])) nameEnd++;
+                    materialLibraryLoaded = parseMtl(baseDir + std::string(names.substr(0, nameEnd)), materials, materialMap);
+                    names = trim(names.substr(nameEnd));
+                }
+                break;
+            }
+            }
+        }
+        appendTriangles(chunk, triangle, chunk.triangles.size() / 3);
+    }
+
+    if (!shape.mesh.indices.empty())
+    {
+        shapes.push_back(std::move(shape));
+    }
+}
+
+void FastObjParser::runBenchmark(const std::string& modelsDirectory)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    std::vector<std::string> objPaths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(modelsDirectory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".obj")
+        {
+            objPaths.push_back(entry.path().generic_string());
+        }
+    }
+    std::sort(objPaths.begin(), objPaths.end());
+
+    std::cout << "OBJ parser benchmark, " << ThreadPool::getShared().getWorkerCount() << " workers\n";
+
+    for (const std::string& path : objPaths)
+    {
+        std::string baseDir = path.substr(0, path.find_last_of("/\\") + 1);
+
+        tinyobj::attrib_t referenceAttrib;
+        std::vector<tinyobj::shape_t> referenceShapes;
+        std::vector<tinyobj::material_t> referenceMaterials;
+        std::string warn, err;
+
+        auto start = Clock::now();
+        bool loaded = tinyobj::LoadObj(&referenceAttrib, &referenceShapes, &referenceMaterials, &warn, &err, path.c_str(), baseDir.c_str(), true);
+        double referenceTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (!loaded)
+        {
+            std::cout << path << ": tinyobj failed, " << warn << err << "\n";
+            continue;
+        }
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+
+        start = Clock::now();
+        parse(path, attrib, shapes, materials);
+        double parseTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        // Float parsing may round differently in the last bit, everything else has to match exactly
+        auto maxDifference = [](const std::vector<tinyobj::real_t>& a, const std::vector<tinyobj::real_t>& b)
+        {
+            float difference = 0.0f;
+            for (size_t i = 0; i < std::min(a.size(), b.size()); i++)
+            {
+                difference = std::max(difference, std::fabs(a[i] - b[i]));
+            }
+            return difference;
+        };
+
+        bool same = attrib.vertices.size() == referenceAttrib.vertices.size()
+            && attrib.normals.size() == referenceAttrib.normals.size()
+            && attrib.texcoords.size() == referenceAttrib.texcoords.size()
+            && shapes.size() == referenceShapes.size()
+            && materials.size() == referenceMaterials.size();
+
+        for (size_t s = 0; same && s < shapes.size(); s++)
+        {
+            const tinyobj::mesh_t& mesh = shapes[s].mesh;
+            const tinyobj::mesh_t& reference = referenceShapes[s].mesh;
+            same = mesh.indices.size() == reference.indices.size() && mesh.material_ids == reference.material_ids;
+            for (size_t i = 0; same && i < mesh.indices.size(); i++)
+            {
+                same = mesh.indices[i].vertex_index == reference.indices[i].vertex_index
+                    && mesh.indices[i].normal_index == reference.indices[i].normal_index
+                    && mesh.indices[i].texcoord_index == reference.indices[i].texcoord_index;
+            }
+        }
+
+        float attributeDifference = std::max({ maxDifference(attrib.vertices, referenceAttrib.vertices),
+            maxDifference(attrib.normals, referenceAttrib.normals),
+            maxDifference(attrib.texcoords, referenceAttrib.texcoords) });
+
+        std::cout << path << ": " << attrib.vertices.size() / 3 << " vertices, " << shapes.size() << " shapes | tinyobj "
+                  << referenceTime << " ms | native " << parseTime << " ms (x" << referenceTime / parseTime << ") | "
+                  << (same ? "identical" : "MISMATCH") << ", max attribute difference " << attributeDifference << "\n";
+    }
+}
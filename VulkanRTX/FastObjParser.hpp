@@ -0,0 +1,30 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include <tiny_obj_loader.h>
+
+/// <summary>
+/// Native OBJ/MTL parser for large single files, fills the same structures as tinyobj::LoadObj with triangulation.
+/// The file is memory mapped and cut into line aligned chunks. A first parallel pass counts the v/vt/vn lines of each chunk
+/// so every chunk knows where its attributes land in the merged arrays, a second pass parses the chunks in place and
+/// a third one triangulates their faces. Groups and materials are then stitched in file order.
+/// </summary>
+class FastObjParser
+{
+public:
+    /// <summary>
+    /// Parses an OBJ and the first material library it references that can be opened. Throws on malformed faces.
+    /// </summary>
+    static void parse(const std::string& objPath, tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::material_t>& materials);
+
+    /// <summary>
+    /// Appends the materials of an MTL file, returns false if it could not be opened. Known names keep their first index.
+    /// </summary>
+    static bool parseMtl(const std::string& mtlPath, std::vector<tinyobj::material_t>& materials, std::map<std::string, int>& materialMap);
+
+    /// <summary>
+    /// Times tinyobj and this parser on every OBJ found under the given directory, checks that both produce the same data and prints the results.
+    /// </summary>
+    static void runBenchmark(const std::string& modelsDirectory);
+};
@@ -0,0 +1,834 @@
+#include "GltfLoader.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include "Json.hpp"
+#include "MappedFile.hpp"
+#include "MeshCleaner.hpp"
+#include "MeshClusterizer.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "TangentGenerator.hpp"
+#include "ImportSettings.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+    constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+    // Accessor component types
+    constexpr int COMPONENT_BYTE = 5120;
+    constexpr int COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr int COMPONENT_SHORT = 5122;
+    constexpr int COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr int COMPONENT_UNSIGNED_INT = 5125;
+    constexpr int COMPONENT_FLOAT = 5126;
+
+    constexpr int MODE_TRIANGLES = 4;
+    constexpr int MAX_NODE_DEPTH = 64;
+
+    struct ByteSpan
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    const JsonValue EMPTY_JSON;
+
+    const JsonValue& getMember(const JsonValue& object, std::string_view key)
+    {
+        const JsonValue* value = object.find(key);
+        return value ? *value : EMPTY_JSON;
+    }
+
+    bool endsWith(const std::string& text, std::string_view suffix)
+    {
+        if (text.size() < suffix.size()) return false;
+        for (size_t i = 0; i < suffix.size(); i++)
+        {
+            if (std::tolower(static_cast<unsigned char>(text[text.size() - suffix.size() + i])) != suffix[i]) return false;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> decodeBase64(std::string_view text)
+    {
+        auto decodeChar = [](char c) -> int
+        {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+' || c == '-') return 62;
+            if (c == '/' || c == '_') return 63;
+            return -1;
+        };
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(text.size() * 3 / 4);
+        uint32_t accumulator = 0;
+        int bits = 0;
+        for (char c : text)
+        {
+            int value = decodeChar(c);
+            if (value < 0) continue; // Padding and whitespace
+            accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                bytes.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+            }
+        }
+        return bytes;
+    }
+
+    // Relative URIs may be percent-encoded
+    std::string decodeUri(const std::string& uri)
+    {
+        std::string decoded;
+        decoded.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+            {
+                decoded += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                decoded += uri[i];
+            }
+        }
+        return decoded;
+    }
+
+    bool isDataUri(const std::string& uri)
+    {
+        return uri.compare(0, 5, "data:") == 0;
+    }
+
+    std::vector<uint8_t> decodeDataUri(const std::string& uri)
+    {
+        size_t comma = uri.find(',');
+        if (comma == std::string::npos || uri.compare(comma - 7, 7, ";base64") != 0)
+        {
+            throw std::runtime_error("glTF data URIs must be base64 encoded");
+        }
+        return decodeBase64(std::string_view(uri).substr(comma + 1));
+    }
+
+    uint32_t readU32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    // Splits a .glb into its JSON and binary chunks, or returns the whole file as JSON for .gltf
+    std::string_view readJsonChunk(const MappedFile& file, ByteSpan& binaryChunk, const std::string& path)
+    {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(file.data());
+        size_t size = file.size();
+        if (size < 12 || readU32(data) != GLB_MAGIC)
+        {
+            return std::string_view(file.data(), size);
+        }
+
+        if (readU32(data + 4) != 2)
+        {
+            throw std::runtime_error("Unsupported glTF binary version in " + path);
+        }
+        size = std::min<size_t>(size, readU32(data + 8));
+
+        std::string_view json;
+        size_t offset = 12;
+        while (offset + 8 <= size)
+        {
+            uint32_t chunkLength = readU32(data + offset);
+            uint32_t chunkType = readU32(data + offset + 4);
+            offset += 8;
+            if (chunkLength > size - offset)
+            {
+                throw std::runtime_error("Truncated glTF binary chunk in " + path);
+            }
+
+            if (chunkType == GLB_CHUNK_JSON && json.empty())
+            {
+                json = std::string_view(file.data() + offset, chunkLength);
+            }
+            else if (chunkType == GLB_CHUNK_BIN && binaryChunk.data == nullptr)
+            {
+                binaryChunk = { data + offset, chunkLength };
+            }
+            offset += (chunkLength + 3) & ~3u;
+        }
+
+        if (json.empty())
+        {
+            throw std::runtime_error("Missing JSON chunk in " + path);
+        }
+        return json;
+    }
+
+    class GltfDocument
+    {
+    public:
+        std::string path;
+        std::string baseDir;
+        JsonValue json;
+        std::vector<ByteSpan> buffers;
+
+    private:
+        MappedFile file;
+        std::vector<std::unique_ptr<MappedFile>> externalFiles;
+        std::vector<std::vector<uint8_t>> decodedBuffers;
+
+    public:
+        explicit GltfDocument(const std::string& gltfPath)
+            : path(gltfPath), baseDir(gltfPath.substr(0, gltfPath.find_last_of("/\\") + 1))
+        {
+            if (!file.open(path))
+            {
+                throw std::runtime_error("Failed to open glTF: " + path);
+            }
+
+            ByteSpan binaryChunk;
+            json = JsonValue::parse(readJsonChunk(file, binaryChunk, path));
+
+            const JsonValue& asset = getMember(json, "asset");
+            if (asset.getString("version").compare(0, 2, "2.") != 0)
+            {
+                throw std::runtime_error("Only glTF 2.0 is supported: " + path);
+            }
+
+            // Compressed geometry needs a decoder we do not have
+            const JsonValue& required = getMember(json, "extensionsRequired");
+            for (size_t i = 0; i < required.size(); i++)
+            {
+                throw std::runtime_error("glTF " + path + " requires unsupported extension " + required[i].asString());
+            }
+
+            const JsonValue& bufferArray = getMember(json, "buffers");
+            buffers.resize(bufferArray.size());
+            for (size_t i = 0; i < bufferArray.size(); i++)
+            {
+                std::string uri = bufferArray[i].getString("uri");
+                if (uri.empty())
+                {
+                    // The first buffer without URI is the GLB binary chunk
+                    if (i != 0 || binaryChunk.data == nullptr)
+                    {
+                        throw std::runtime_error("glTF buffer " + std::to_string(i) + " has no data in " + path);
+                    }
+                    buffers[i] = binaryChunk;
+                }
+                else if (isDataUri(uri))
+                {
+                    decodedBuffers.push_back(decodeDataUri(uri));
+                    buffers[i] = { decodedBuffers.back().data(), decodedBuffers.back().size() };
+                }
+                else
+                {
+                    auto externalFile = std::make_unique<MappedFile>();
+                    std::string bufferPath = baseDir + decodeUri(uri);
+                    if (!externalFile->open(bufferPath))
+                    {
+                        throw std::runtime_error("Failed to open glTF buffer " + bufferPath);
+                    }
+                    buffers[i] = { reinterpret_cast<const uint8_t*>(externalFile->data()), externalFile->size() };
+                    externalFiles.push_back(std::move(externalFile));
+                }
+
+                size_t declaredLength = static_cast<size_t>(bufferArray[i].getNumber("byteLength", 0));
+                if (declaredLength > buffers[i].size)
+                {
+                    throw std::runtime_error("glTF buffer " + std::to_string(i) + " is shorter than its byteLength in " + path);
+                }
+            }
+        }
+
+        const JsonValue& get(std::string_view arrayName, int index) const
+        {
+            const JsonValue& array = getMember(json, arrayName);
+            if (index < 0 || static_cast<size_t>(index) >= array.size())
+            {
+                throw std::runtime_error("glTF " + path + " references missing " + std::string(arrayName) + " " + std::to_string(index));
+            }
+            return array[index];
+        }
+
+        ByteSpan getBufferView(int index) const
+        {
+            const JsonValue& view = get("bufferViews", index);
+            int bufferIndex = view.getInt("buffer", -1);
+            if (bufferIndex < 0 || static_cast<size_t>(bufferIndex) >= buffers.size())
+            {
+                throw std::runtime_error("glTF buffer view " + std::to_string(index) + " references a missing buffer in " + path);
+            }
+            size_t offset = static_cast<size_t>(view.getNumber("byteOffset", 0));
+            size_t length = static_cast<size_t>(view.getNumber("byteLength", 0));
+            const ByteSpan& buffer = buffers[bufferIndex];
+            if (offset > buffer.size || length > buffer.size - offset)
+            {
+                throw std::runtime_error("glTF buffer view " + std::to_string(index) + " is out of bounds in " + path);
+            }
+            return { buffer.data + offset, length };
+        }
+    };
+
+    // Typed view over the elements of an accessor
+    struct Accessor
+    {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        int componentType = COMPONENT_FLOAT;
+        int componentCount = 0;
+        bool normalized = false;
+
+        float readFloat(size_t element, int component) const
+        {
+            const uint8_t* p = data + element * stride;
+            switch (componentType)
+            {
+            case COMPONENT_FLOAT:
+            {
+                float value;
+                std::memcpy(&value, p + component * sizeof(float), sizeof(float));
+                return value;
+            }
+            case COMPONENT_UNSIGNED_BYTE:
+                return normalized ? p[component] / 255.0f : p[component];
+            case COMPONENT_BYTE:
+            {
+                float value = static_cast<int8_t>(p[component]);
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case COMPONENT_UNSIGNED_SHORT:
+            {
+                uint16_t value;
+                std::memcpy(&value, p + component * sizeof(uint16_t), sizeof(uint16_t));
+                return normalized ? value / 65535.0f : value;
+            }
+            case COMPONENT_SHORT:
+            {
+                int16_t value;
+                std::memcpy(&value, p + component * sizeof(int16_t), sizeof(int16_t));
+                return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            default:
+                return static_cast<float>(readIndex(element));
+            }
+        }
+
+        uint32_t readIndex(size_t element) const
+        {
+            const uint8_t* p = data + element * stride;
+            switch (componentType)
+            {
+            case COMPONENT_UNSIGNED_BYTE:
+                return *p;
+            case COMPONENT_UNSIGNED_SHORT:
+            {
+                uint16_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+            default:
+                return readU32(p);
+            }
+        }
+
+        glm::vec2 readVec2(size_t element) const { return glm::vec2(readFloat(element, 0), readFloat(element, 1)); }
+        glm::vec3 readVec3(size_t element) const { return glm::vec3(readFloat(element, 0), readFloat(element, 1), readFloat(element, 2)); }
+    };
+
+    size_t getComponentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_BYTE:
+        case COMPONENT_UNSIGNED_BYTE:
+            return 1;
+        case COMPONENT_SHORT:
+        case COMPONENT_UNSIGNED_SHORT:
+            return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    int getComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+
+    Accessor getAccessor(const GltfDocument& document, int index, int minComponents)
+    {
+        const JsonValue& json = document.get("accessors", index);
+        if (json.find("sparse"))
+        {
+            throw std::runtime_error("Sparse glTF accessors are not supported: " + document.path);
+        }
+        if (!json.find("bufferView"))
+        {
+            throw std::runtime_error("glTF accessors without buffer view are not supported: " + document.path);
+        }
+
+        Accessor accessor;
+        accessor.count = static_cast<size_t>(json.getNumber("count", 0));
+        accessor.componentType = json.getInt("componentType", 0);
+        accessor.componentCount = getComponentCount(json.getString("type"));
+        accessor.normalized = getMember(json, "normalized").asBool(false);
+
+        size_t componentSize = getComponentSize(accessor.componentType);
+        size_t elementSize = componentSize * accessor.componentCount;
+        if (elementSize == 0 || accessor.componentCount < minComponents)
+        {
+            throw std::runtime_error("Unsupported layout for glTF accessor " + std::to_string(index) + " in " + document.path);
+        }
+
+        int viewIndex = json.getInt("bufferView", -1);
+        ByteSpan view = document.getBufferView(viewIndex);
+        size_t stride = static_cast<size_t>(document.get("bufferViews", viewIndex).getNumber("byteStride", 0));
+        accessor.stride = stride != 0 ? stride : elementSize;
+
+        size_t offset = static_cast<size_t>(json.getNumber("byteOffset", 0));
+        if (accessor.count > 0 && (offset > view.size || (accessor.count - 1) * accessor.stride + elementSize > view.size - offset))
+        {
+            throw std::runtime_error("glTF accessor " + std::to_string(index) + " is out of bounds in " + document.path);
+        }
+        accessor.data = view.data + offset;
+        return accessor;
+    }
+
+    glm::mat4 getNodeTransform(const JsonValue& node)
+    {
+        const JsonValue& matrix = getMember(node, "matrix");
+        if (matrix.size() == 16)
+        {
+            glm::mat4 result;
+            for (int i = 0; i < 16; i++)
+            {
+                result[i / 4][i % 4] = static_cast<float>(matrix[i].asNumber());
+            }
+            return result;
+        }
+
+        glm::vec3 translation(0.0f);
+        glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale(1.0f);
+        const JsonValue& t = getMember(node, "translation");
+        const JsonValue& r = getMember(node, "rotation");
+        const JsonValue& s = getMember(node, "scale");
+        if (t.size() == 3) translation = glm::vec3(t[0].asNumber(), t[1].asNumber(), t[2].asNumber());
+        if (r.size() == 4) rotation = glm::quat(static_cast<float>(r[3].asNumber()), static_cast<float>(r[0].asNumber()), static_cast<float>(r[1].asNumber()), static_cast<float>(r[2].asNumber()));
+        if (s.size() == 3) scale = glm::vec3(s[0].asNumber(), s[1].asNumber(), s[2].asNumber());
+
+        return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+    }
+
+    // A triangle primitive placed by a node
+    struct PrimitiveInstance
+    {
+        const JsonValue* primitive;
+        glm::mat4 transform;
+        int materialIndex;
+    };
+
+    void collectPrimitives(const GltfDocument& document, int nodeIndex, const glm::mat4& parentTransform, int depth, std::vector<PrimitiveInstance>& instances)
+    {
+        if (depth > MAX_NODE_DEPTH)
+        {
+            throw std::runtime_error("glTF node hierarchy too deep or cyclic in " + document.path);
+        }
+
+        const JsonValue& node = document.get("nodes", nodeIndex);
+        glm::mat4 transform = parentTransform * getNodeTransform(node);
+
+        int meshIndex = node.getInt("mesh", -1);
+        if (meshIndex >= 0)
+        {
+            const JsonValue& primitives = getMember(document.get("meshes", meshIndex), "primitives");
+            for (size_t i = 0; i < primitives.size(); i++)
+            {
+                if (primitives[i].getInt("mode", MODE_TRIANGLES) != MODE_TRIANGLES)
+                {
+                    std::cerr << "Skipping non triangle primitive in " + document.path + "\n";
+                    continue;
+                }
+                instances.push_back({ &primitives[i], transform, primitives[i].getInt("material", -1) });
+            }
+        }
+
+        const JsonValue& children = getMember(node, "children");
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            collectPrimitives(document, static_cast<int>(children[i].asNumber(-1)), transform, depth + 1, instances);
+        }
+    }
+
+    std::vector<PrimitiveInstance> collectScenePrimitives(const GltfDocument& document)
+    {
+        std::vector<PrimitiveInstance> instances;
+        const JsonValue& scenes = getMember(document.json, "scenes");
+        if (scenes.size() == 0)
+        {
+            // No scene: every mesh is placed once at the origin
+            const JsonValue& meshes = getMember(document.json, "meshes");
+            for (size_t m = 0; m < meshes.size(); m++)
+            {
+                const JsonValue& primitives = getMember(meshes[m], "primitives");
+                for (size_t i = 0; i < primitives.size(); i++)
+                {
+                    if (primitives[i].getInt("mode", MODE_TRIANGLES) != MODE_TRIANGLES) continue;
+                    instances.push_back({ &primitives[i], glm::mat4(1.0f), primitives[i].getInt("material", -1) });
+                }
+            }
+            return instances;
+        }
+
+        const JsonValue& scene = document.get("scenes", document.json.getInt("scene", 0));
+        const JsonValue& roots = getMember(scene, "nodes");
+        for (size_t i = 0; i < roots.size(); i++)
+        {
+            collectPrimitives(document, static_cast<int>(roots[i].asNumber(-1)), glm::mat4(1.0f), 0, instances);
+        }
+        return instances;
+    }
+
+    // Area weighted vertex normals for primitives that do not provide any
+    void computeNormals(MeshInfo& mesh, size_t firstVertex, size_t firstIndex)
+    {
+        for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3)
+        {
+            VulkanVertex& a = mesh.vertices[mesh.indices[i + 0]];
+            VulkanVertex& b = mesh.vertices[mesh.indices[i + 1]];
+            VulkanVertex& c = mesh.vertices[mesh.indices[i + 2]];
+            glm::vec3 faceNormal = glm::cross(b.pos - a.pos, c.pos - a.pos);
+            a.normal += faceNormal;
+            b.normal += faceNormal;
+            c.normal += faceNormal;
+        }
+        for (size_t v = firstVertex; v < mesh.vertices.size(); v++)
+        {
+            float length = glm::length(mesh.vertices[v].normal);
+            mesh.vertices[v].normal = length > 0.0f ? mesh.vertices[v].normal / length : glm::vec3(0, 1, 0);
+        }
+    }
+
+    // Appends a primitive baked with its node transform, returns whether it provided tangents
+    bool appendPrimitive(const GltfDocument& document, const PrimitiveInstance& instance, MeshInfo& mesh)
+    {
+        const JsonValue& attributes = getMember(*instance.primitive, "attributes");
+        int positionIndex = attributes.getInt("POSITION", -1);
+        if (positionIndex < 0)
+        {
+            throw std::runtime_error("glTF primitive without POSITION in " + document.path);
+        }
+
+        Accessor positions = getAccessor(document, positionIndex, 3);
+        int normalIndex = attributes.getInt("NORMAL", -1);
+        int tangentIndex = attributes.getInt("TANGENT", -1);
+        int texCoordIndex = attributes.getInt("TEXCOORD_0", -1);
+        Accessor normals = normalIndex >= 0 ? getAccessor(document, normalIndex, 3) : Accessor{};
+        Accessor tangents = tangentIndex >= 0 ? getAccessor(document, tangentIndex, 4) : Accessor{};
+        Accessor texCoords = texCoordIndex >= 0 ? getAccessor(document, texCoordIndex, 2) : Accessor{};
+        bool hasNormals = normalIndex >= 0 && normals.count >= positions.count;
+        bool hasTangents = hasNormals && tangentIndex >= 0 && tangents.count >= positions.count;
+        bool hasTexCoords = texCoordIndex >= 0 && texCoords.count >= positions.count;
+
+        glm::mat3 linear(instance.transform);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        bool mirrored = glm::determinant(linear) < 0.0f;
+
+        size_t firstVertex = mesh.vertices.size();
+        mesh.vertices.resize(firstVertex + positions.count);
+        for (size_t i = 0; i < positions.count; i++)
+        {
+            VulkanVertex& vertex = mesh.vertices[firstVertex + i];
+            vertex.pos = glm::vec3(instance.transform * glm::vec4(positions.readVec3(i), 1.0f));
+            if (hasTexCoords)
+            {
+                // glTF UVs already have their origin at the top left, unlike OBJ
+                vertex.texCoord = texCoords.readVec2(i);
+            }
+            if (hasNormals)
+            {
+                vertex.normal = glm::normalize(normalMatrix * normals.readVec3(i));
+            }
+            if (hasTangents)
+            {
+                vertex.tangent = glm::normalize(linear * tangents.readVec3(i));
+                float handedness = tangents.readFloat(i, 3) < 0.0f ? -1.0f : 1.0f;
+                vertex.bitangent = glm::cross(vertex.normal, vertex.tangent) * (mirrored ? -handedness : handedness);
+            }
+        }
+
+        size_t firstIndex = mesh.indices.size();
+        int indicesIndex = instance.primitive->getInt("indices", -1);
+        if (indicesIndex >= 0)
+        {
+            Accessor indices = getAccessor(document, indicesIndex, 1);
+            mesh.indices.resize(firstIndex + indices.count);
+            uint32_t* out = mesh.indices.data() + firstIndex;
+            if (indices.componentType == COMPONENT_UNSIGNED_INT && indices.stride == sizeof(uint32_t))
+            {
+                // Tightly packed 32 bit indices already have the engine layout
+                std::memcpy(out, indices.data, indices.count * sizeof(uint32_t));
+            }
+            else
+            {
+                for (size_t i = 0; i < indices.count; i++) out[i] = indices.readIndex(i);
+            }
+            for (size_t i = 0; i < indices.count; i++)
+            {
+                if (out[i] >= positions.count)
+                {
+                    throw std::runtime_error("glTF index out of range in " + document.path);
+                }
+                out[i] += static_cast<uint32_t>(firstVertex);
+            }
+        }
+        else
+        {
+            mesh.indices.resize(firstIndex + positions.count);
+            for (size_t i = 0; i < positions.count; i++) mesh.indices[firstIndex + i] = static_cast<uint32_t>(firstVertex + i);
+        }
+
+        // Drop a trailing partial triangle and keep the winding when the transform mirrors the geometry
+        mesh.indices.resize(firstIndex + (mesh.indices.size() - firstIndex) / 3 * 3);
+        if (mirrored)
+        {
+            for (size_t i = firstIndex; i < mesh.indices.size(); i += 3) std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+
+        if (!hasNormals)
+        {
+            computeNormals(mesh, firstVertex, firstIndex);
+        }
+        return hasTangents;
+    }
+
+    // Writes an embedded image next to the model so it can be loaded by path like any other texture
+    std::string extractImage(const GltfDocument& document, int imageIndex, const std::vector<uint8_t>& bytes, const std::string& mimeType)
+    {
+        std::string extension = mimeType == "image/jpeg" ? ".jpg" : ".png";
+        std::string imagePath = document.path + ".image" + std::to_string(imageIndex) + extension;
+
+        std::error_code error;
+        if (std::filesystem::file_size(imagePath, error) != bytes.size() || error)
+        {
+            std::ofstream out(imagePath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            if (!out)
+            {
+                std::cerr << "Cannot extract glTF image to " + imagePath + "\n";
+                return "";
+            }
+        }
+        return imagePath;
+    }
+
+    std::string resolveTexture(const GltfDocument& document, const JsonValue& textureInfo, std::unordered_map<int, std::string>& imagePaths)
+    {
+        int textureIndex = textureInfo.getInt("index", -1);
+        if (textureIndex < 0) return "";
+
+        int imageIndex = document.get("textures", textureIndex).getInt("source", -1);
+        if (imageIndex < 0) return "";
+
+        auto it = imagePaths.find(imageIndex);
+        if (it != imagePaths.end()) return it->second;
+
+        const JsonValue& image = document.get("images", imageIndex);
+        std::string uri = image.getString("uri");
+        std::string imagePath;
+        if (!uri.empty() && !isDataUri(uri))
+        {
+            imagePath = document.baseDir + decodeUri(uri);
+        }
+        else if (!uri.empty())
+        {
+            std::string mimeType = uri.substr(5, uri.find_first_of(";,") - 5);
+            imagePath = extractImage(document, imageIndex, decodeDataUri(uri), mimeType);
+        }
+        else if (image.find("bufferView"))
+        {
+            ByteSpan view = document.getBufferView(image.getInt("bufferView", -1));
+            imagePath = extractImage(document, imageIndex, std::vector<uint8_t>(view.data, view.data + view.size), image.getString("mimeType"));
+        }
+
+        imagePaths[imageIndex] = imagePath;
+        return imagePath;
+    }
+
+    PBRMaterialInfo loadMaterial(const GltfDocument& document, const JsonValue& material, std::unordered_map<int, std::string>& imagePaths)
+    {
+        PBRMaterialInfo matInfo{};
+        matInfo.name = material.getString("name");
+
+        const JsonValue& pbr = getMember(material, "pbrMetallicRoughness");
+        const JsonValue& baseColor = getMember(pbr, "baseColorFactor");
+        for (int i = 0; i < 3; i++)
+        {
+            matInfo.albedoFactor[i] = baseColor.size() == 4 ? static_cast<float>(baseColor[i].asNumber(1.0)) : 1.0f;
+        }
+        matInfo.metallicFactor = static_cast<float>(pbr.getNumber("metallicFactor", 1.0));
+        matInfo.roughnessFactor = static_cast<float>(pbr.getNumber("roughnessFactor", 1.0));
+        matInfo.aoFactor = 0;
+
+        matInfo.albedoTexture = resolveTexture(document, getMember(pbr, "baseColorTexture"), imagePaths);
+
+        // Metalness is stored in blue and roughness in green of the same texture
+        matInfo.metallicTexture = resolveTexture(document, getMember(pbr, "metallicRoughnessTexture"), imagePaths);
+        matInfo.roughnessTexture = matInfo.metallicTexture;
+
+        // The renderer reads normal maps from bumpTexture, like map_Bump in OBJ materials
+        matInfo.normalTexture = resolveTexture(document, getMember(material, "normalTexture"), imagePaths);
+        matInfo.bumpTexture = matInfo.normalTexture;
+        matInfo.aoTexture = resolveTexture(document, getMember(material, "occlusionTexture"), imagePaths);
+        return matInfo;
+    }
+}
+
+ModelInfo GltfLoader::loadGltf(const std::string& path)
+{
+    GltfDocument document(path);
+    ModelInfo model;
+
+    // Load materials
+    std::unordered_map<int, std::string> imagePaths;
+    const JsonValue& materials = getMember(document.json, "materials");
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        model.materials.push_back(loadMaterial(document, materials[i], imagePaths));
+    }
+
+    // Group primitives into meshes, by material like OBJ faces
+    std::vector<PrimitiveInstance> instances = collectScenePrimitives(document);
+    std::vector<std::vector<size_t>> groups;
+    std::unordered_map<int, size_t> groupOfMaterial;
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        int materialIndex = instances[i].materialIndex;
+        if (materialIndex >= static_cast<int>(model.materials.size()))
+        {
+            materialIndex = -1;
+            instances[i].materialIndex = -1;
+        }
+
+        if (!ImportSettings::mergeByMaterial)
+        {
+            groups.push_back({ i });
+            model.meshMaterialIndices.push_back(materialIndex);
+            continue;
+        }
+
+        auto [it, inserted] = groupOfMaterial.try_emplace(materialIndex, groups.size());
+        if (inserted)
+        {
+            groups.emplace_back();
+            model.meshMaterialIndices.push_back(materialIndex);
+        }
+        groups[it->second].push_back(i);
+    }
+
+    model.meshes.resize(groups.size());
+    std::vector<uint8_t> providesTangents(groups.size(), 1);
+    ThreadPool::getShared().parallelFor(groups.size(), [&](size_t g)
+    {
+        for (size_t instance : groups[g])
+        {
+            bool hasTangents = appendPrimitive(document, instances[instance], model.meshes[g]);
+            providesTangents[g] &= hasTangents ? 1 : 0;
+        }
+    });
+
+    if (ImportSettings::cleanMeshes)
+    {
+        std::vector<uint8_t> keptTangents;
+        for (size_t g : MeshCleaner::clean(model, path))
+        {
+            keptTangents.push_back(providesTangents[g]);
+        }
+        providesTangents.swap(keptTangents);
+    }
+
+    if (ImportSettings::clusterTriangleBudget > 0)
+    {
+        MeshClusterizer::clusterize(model.meshes, path);
+    }
+
+    if (ImportSettings::optimizeMeshes)
+    {
+        MeshOptimizer::optimize(model.meshes, path);
+    }
+
+    if (ImportSettings::lodCount > 0)
+    {
+        MeshSimplifier::generateLods(model.meshes);
+    }
+
+    // Only meshes where every primitive came with tangents can skip generation
+    ThreadPool::getShared().parallelFor(model.meshes.size(), [&](size_t i)
+    {
+        if (!providesTangents[i])
+        {
+            TangentGenerator::generate(model.meshes[i]);
+        }
+    });
+
+    return model;
+}
+
+std::vector<std::string> GltfLoader::getDependencies(const std::string& path)
+{
+    std::vector<std::string> dependencies = { path };
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return dependencies;
+    }
+
+    try
+    {
+        ByteSpan binaryChunk;
+        JsonValue json = JsonValue::parse(readJsonChunk(file, binaryChunk, path));
+        std::string baseDir = path.substr(0, path.find_last_of("/\\") + 1);
+        const JsonValue& buffers = getMember(json, "buffers");
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            std::string uri = buffers[i].getString("uri");
+            if (!uri.empty() && !isDataUri(uri))
+            {
+                dependencies.push_back(baseDir + decodeUri(uri));
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        // The load itself reports invalid files
+    }
+    return dependencies;
+}
+
+bool GltfLoader::isGltfPath(const std::string& path)
+{
+    return endsWith(path, ".gltf") || endsWith(path, ".glb");
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// glTF 2.0 importer for .gltf (external or base64 buffers) and binary .glb files.
+/// Triangle primitives of the default scene are baked with their node transforms and grouped by material like OBJ shapes.
+/// Vertices are read straight from the mapped buffers, tangent generation is skipped for meshes that provide TANGENT.
+/// Embedded images are written next to the model so materials keep referencing textures by path.
+/// </summary>
+class GltfLoader
+{
+public:
+    static ModelInfo loadGltf(const std::string& path);
+
+    /// <summary>
+    /// Returns the files a model is built from: the glTF itself and its external buffers.
+    /// </summary>
+    static std::vector<std::string> getDependencies(const std::string& path);
+
+    /// <summary>
+    /// True for .gltf and .glb paths.
+    /// </summary>
+    static bool isGltfPath(const std::string& path);
+};
@@ -0,0 +1,29 @@
+#include "ImportSettings.hpp"
+
+bool ImportSettings::parallelIngest = true;
+bool ImportSettings::progressiveLoading = false;
+bool ImportSettings::useMeshCache = true;
+bool ImportSettings::compressTextures = false;
+bool ImportSettings::streamTextures = false;
+bool ImportSettings::useFastObjParser = false;
+int ImportSettings::workerCount = 0;
+
+float ImportSettings::weldPositionEpsilon = 0.0f;
+float ImportSettings::weldNormalEpsilon = 0.0f;
+float ImportSettings::weldTexCoordEpsilon = 0.0f;
+
+bool ImportSettings::cleanMeshes = false;
+bool ImportSettings::mergeByMaterial = false;
+
+bool ImportSettings::optimizeMeshes = false;
+
+int ImportSettings::lodCount = 0;
+float ImportSettings::lodReduction = 0.5f;
+float ImportSettings::lodMaxError = 0.05f;
+
+int ImportSettings::clusterTriangleBudget = 0;
+
+bool ImportSettings::mergeStaticModels = false;
+int ImportSettings::staticChunkTriangles = 1 << 20;
+
+VertexFormat ImportSettings::vertexFormat = VertexFormat::Full;
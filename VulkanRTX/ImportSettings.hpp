@@ -0,0 +1,37 @@
+#pragma once
+#include "VertexFormat.hpp"
+
+class ImportSettings
+{
+public:
+    static bool parallelIngest; // Load every model of the scene concurrently
+    static bool progressiveLoading; // Render while models are imported in the background, they appear as they finish
+    static bool useMeshCache; // Read and write binary .meshcache files next to the model sources
+    static bool compressTextures; // Upload material textures as BC7 (color) and BC5 (normals), cached as .ktx2 files next to the sources
+    static bool streamTextures; // Materials bind 1x1 placeholders and swap in their textures as they load in the background
+    static bool useFastObjParser; // Parse OBJ files with the chunked parallel FastObjParser instead of tinyobj
+    static int workerCount; // Worker threads used by the asset pipeline, 0 = one per hardware thread
+
+    // Vertex welding tolerances, 0 only merges identical attributes
+    static float weldPositionEpsilon;
+    static float weldNormalEpsilon;
+    static float weldTexCoordEpsilon;
+
+    static bool cleanMeshes; // Drop degenerate and duplicate triangles after welding
+    static bool mergeByMaterial; // Merge the faces of every shape sharing a material into one mesh, shapes are always split per face material
+
+    static bool optimizeMeshes; // Reorder triangles for the vertex cache and vertices for fetch locality after welding
+
+    // LOD chain generation, every LOD keeps lodReduction of the triangles of the previous one
+    static int lodCount;
+    static float lodReduction;
+    static float lodMaxError; // Relative to the mesh extent
+
+    static int clusterTriangleBudget; // Split meshes into spatial clusters of at most this many triangles for the BLAS build, 0 = one geometry per mesh
+
+    // Static models are baked to world space and merged into chunk BLASes of about staticChunkTriangles triangles
+    static bool mergeStaticModels;
+    static int staticChunkTriangles;
+
+    static VertexFormat vertexFormat; // Layout of the vertex buffers uploaded for raster and ray tracing
+};
@@ -0,0 +1,260 @@
+#include "Json.hpp"
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+
+class JsonParser
+{
+private:
+    const char* begin;
+    const char* cursor;
+    const char* end;
+    int depth = 0;
+
+    static constexpr int MAX_DEPTH = 256;
+
+public:
+    explicit JsonParser(std::string_view text)
+        : begin(text.data()), cursor(text.data()), end(text.data() + text.size())
+    {
+    }
+
+    [[noreturn]] void fail(const char* message) const
+    {
+        throw std::runtime_error(std::string("JSON error at byte ") + std::to_string(cursor - begin) + ": " + message);
+    }
+
+    void skipWhitespace()
+    {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) cursor++;
+    }
+
+    void expect(char c)
+    {
+        skipWhitespace();
+        if (cursor == end || *cursor != c)
+        {
+            fail((std::string("expected '") + c + "'").c_str());
+        }
+        cursor++;
+    }
+
+    // Skips a ',' between members or elements
+    bool consumeSeparator()
+    {
+        skipWhitespace();
+        if (cursor < end && *cursor == ',')
+        {
+            cursor++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeLiteral(std::string_view literal)
+    {
+        if (static_cast<size_t>(end - cursor) >= literal.size() && std::string_view(cursor, literal.size()) == literal)
+        {
+            cursor += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    void appendUtf8(std::string& out, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    uint32_t parseHex4()
+    {
+        if (end - cursor < 4) fail("truncated unicode escape");
+        uint32_t value = 0;
+        std::from_chars_result result = std::from_chars(cursor, cursor + 4, value, 16);
+        if (result.ptr != cursor + 4) fail("invalid unicode escape");
+        cursor += 4;
+        return value;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string out;
+        while (true)
+        {
+            // Copy runs without escapes at once
+            const char* runStart = cursor;
+            while (cursor < end && *cursor != '"' && *cursor != '\\') cursor++;
+            out.append(runStart, cursor);
+            if (cursor == end) fail("unterminated string");
+            if (*cursor++ == '"') return out;
+
+            if (cursor == end) fail("unterminated escape");
+            char escaped = *cursor++;
+            switch (escaped)
+            {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                uint32_t codePoint = parseHex4();
+                if (codePoint >= 0xD800 && codePoint < 0xDC00 && consumeLiteral("\\u"))
+                {
+                    uint32_t low = parseHex4();
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                fail("invalid escape");
+            }
+        }
+    }
+
+    void parseValue(JsonValue& value)
+    {
+        skipWhitespace();
+        if (cursor == end) fail("unexpected end of document");
+        if (++depth > MAX_DEPTH) fail("document nested too deeply");
+
+        char c = *cursor;
+        if (c == '{')
+        {
+            value.type = JsonValue::Type::Object;
+            cursor++;
+            skipWhitespace();
+            if (cursor < end && *cursor == '}')
+            {
+                cursor++;
+            }
+            else
+            {
+                while (true)
+                {
+                    std::string key = parseString();
+                    expect(':');
+                    value.members.emplace_back(std::move(key), JsonValue());
+                    parseValue(value.members.back().second);
+                    if (!consumeSeparator()) break;
+                }
+                expect('}');
+            }
+        }
+        else if (c == '[')
+        {
+            value.type = JsonValue::Type::Array;
+            cursor++;
+            skipWhitespace();
+            if (cursor < end && *cursor == ']')
+            {
+                cursor++;
+            }
+            else
+            {
+                while (true)
+                {
+                    value.elements.emplace_back();
+                    parseValue(value.elements.back());
+                    if (!consumeSeparator()) break;
+                }
+                expect(']');
+            }
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue::Type::String;
+            value.stringValue = parseString();
+        }
+        else if (consumeLiteral("true") || consumeLiteral("false"))
+        {
+            value.type = JsonValue::Type::Bool;
+            value.boolValue = c == 't';
+        }
+        else if (consumeLiteral("null"))
+        {
+            value.type = JsonValue::Type::Null;
+        }
+        else
+        {
+            value.type = JsonValue::Type::Number;
+            std::from_chars_result result = std::from_chars(cursor, end, value.numberValue);
+            if (result.ec != std::errc()) fail("invalid value");
+            cursor = result.ptr;
+        }
+
+        depth--;
+    }
+
+    JsonValue parseDocument()
+    {
+        JsonValue root;
+        parseValue(root);
+        skipWhitespace();
+        if (cursor != end) fail("trailing characters after document");
+        return root;
+    }
+};
+
+JsonValue JsonValue::parse(std::string_view text)
+{
+    // Skip a UTF-8 byte order mark
+    if (text.size() >= 3 && text.substr(0, 3) == "\xEF\xBB\xBF")
+    {
+        text.remove_prefix(3);
+    }
+    return JsonParser(text).parseDocument();
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const
+{
+    for (const auto& [name, value] : members)
+    {
+        if (name == key) return &value;
+    }
+    return nullptr;
+}
+
+double JsonValue::getNumber(std::string_view key, double fallback) const
+{
+    const JsonValue* value = find(key);
+    return value ? value->asNumber(fallback) : fallback;
+}
+
+int JsonValue::getInt(std::string_view key, int fallback) const
+{
+    return static_cast<int>(getNumber(key, fallback));
+}
+
+std::string JsonValue::getString(std::string_view key) const
+{
+    const JsonValue* value = find(key);
+    return value ? value->asString() : std::string();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Minimal read-only JSON document, enough for glTF. Objects keep their members in file order and are searched linearly.
+/// </summary>
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+private:
+    Type type = Type::Null;
+    bool boolValue = false;
+    double numberValue = 0.0;
+    std::string stringValue;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    friend class JsonParser;
+
+public:
+    /// <summary>
+    /// Parses a whole document, throws std::runtime_error with the byte offset of the first error.
+    /// </summary>
+    static JsonValue parse(std::string_view text);
+
+    Type getType() const { return type; }
+    bool isObject() const { return type == Type::Object; }
+    bool isArray() const { return type == Type::Array; }
+
+    /// <summary>
+    /// Member of an object, nullptr if this is not an object or the key is missing.
+    /// </summary>
+    const JsonValue* find(std::string_view key) const;
+
+    // Array access, size is 0 for anything but arrays
+    size_t size() const { return elements.size(); }
+    const JsonValue& operator[](size_t index) const { return elements[index]; }
+
+    double asNumber(double fallback = 0.0) const { return type == Type::Number ? numberValue : fallback; }
+    bool asBool(bool fallback = false) const { return type == Type::Bool ? boolValue : fallback; }
+    const std::string& asString() const { return stringValue; }
+
+    // Shortcuts for optional members
+    double getNumber(std::string_view key, double fallback) const;
+    int getInt(std::string_view key, int fallback) const;
+    std::string getString(std::string_view key) const;
+};
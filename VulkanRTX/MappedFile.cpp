@@ -0,0 +1,96 @@
+#include "MappedFile.hpp"
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart == 0)
+        {
+            // Empty files cannot be mapped
+            CloseHandle(file);
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view != nullptr)
+            {
+                fileHandle = file;
+                mappingHandle = mapping;
+                mappedData = static_cast<const char*>(view);
+                mappedSize = static_cast<size_t>(fileSize.QuadPart);
+                return true;
+            }
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#endif
+
+    // Fallback: read the whole file
+    std::ifstream stream(path, std::ios::ate | std::ios::binary);
+    if (!stream.is_open())
+    {
+        return false;
+    }
+
+    fallbackBuffer.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(fallbackBuffer.data(), fallbackBuffer.size());
+
+    mappedData = fallbackBuffer.data();
+    mappedSize = fallbackBuffer.size();
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (mappingHandle != nullptr)
+    {
+        UnmapViewOfFile(mappedData);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+    }
+#endif
+
+    fallbackBuffer.clear();
+    fallbackBuffer.shrink_to_fit();
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+const char* MappedFile::data() const
+{
+    return mappedData;
+}
+
+size_t MappedFile::size() const
+{
+    return mappedSize;
+}
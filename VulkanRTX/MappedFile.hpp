@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Read-only view of a whole file. Uses a memory mapping where available and falls back to reading the file into memory.
+/// </summary>
+class MappedFile
+{
+private:
+    const char* mappedData = nullptr;
+    size_t mappedSize = 0;
+    std::vector<char> fallbackBuffer;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    void close();
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// <summary>
+    /// Maps the file, returns false if it could not be opened.
+    /// </summary>
+    bool open(const std::string& path);
+
+    const char* data() const;
+    size_t size() const;
+};
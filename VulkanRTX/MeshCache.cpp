@@ -0,0 +1,305 @@
+#include "MeshCache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "MappedFile.hpp"
+#include "Utils.hpp"
+
+namespace
+{
+    constexpr uint32_t CACHE_MAGIC = 0x434D4B56; // "VKMC"
+    constexpr uint32_t CACHE_VERSION = 6;
+
+    struct FileStamp
+    {
+        uint64_t size = 0;
+        int64_t modifiedTime = 0;
+    };
+
+    bool getFileStamp(const std::string& path, FileStamp& stamp)
+    {
+        std::error_code error;
+        uint64_t size = std::filesystem::file_size(path, error);
+        if (error) return false;
+        auto modifiedTime = std::filesystem::last_write_time(path, error);
+        if (error) return false;
+
+        stamp.size = size;
+        stamp.modifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+        return true;
+    }
+
+    bool hashFileContent(const std::string& path, uint64_t& hash)
+    {
+        MappedFile file;
+        if (!file.open(path)) return false;
+        hash = hashBytes(file.data(), file.size());
+        return true;
+    }
+
+    class BinaryWriter
+    {
+    public:
+        std::vector<char> buffer;
+
+        void writeBytes(const void* data, size_t size)
+        {
+            const char* bytes = static_cast<const char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        template <typename T>
+        void write(const T& value)
+        {
+            writeBytes(&value, sizeof(T));
+        }
+
+        void writeString(const std::string& value)
+        {
+            write(static_cast<uint32_t>(value.size()));
+            writeBytes(value.data(), value.size());
+        }
+    };
+
+    class BinaryReader
+    {
+    private:
+        const char* cursor;
+        const char* end;
+
+    public:
+        BinaryReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+
+        void readBytes(void* data, size_t size)
+        {
+            if (static_cast<size_t>(end - cursor) < size)
+            {
+                throw std::runtime_error("truncated cache file");
+            }
+            if (size > 0)
+            {
+                std::memcpy(data, cursor, size);
+            }
+            cursor += size;
+        }
+
+        template <typename T>
+        T read()
+        {
+            T value;
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+
+        std::string readString()
+        {
+            uint32_t size = read<uint32_t>();
+            std::string value(size, '\0');
+            readBytes(value.data(), size);
+            return value;
+        }
+    };
+
+    bool dependenciesUpToDate(BinaryReader& reader)
+    {
+        uint32_t dependencyCount = reader.read<uint32_t>();
+        bool upToDate = true;
+        for (uint32_t i = 0; i < dependencyCount; i++)
+        {
+            std::string path = reader.readString();
+            FileStamp cachedStamp;
+            cachedStamp.size = reader.read<uint64_t>();
+            cachedStamp.modifiedTime = reader.read<int64_t>();
+            uint64_t cachedHash = reader.read<uint64_t>();
+
+            if (!upToDate) continue;
+
+            FileStamp stamp;
+            if (!getFileStamp(path, stamp) || stamp.size != cachedStamp.size)
+            {
+                upToDate = false;
+            }
+            else if (stamp.modifiedTime != cachedStamp.modifiedTime)
+            {
+                // Touched but maybe not modified, compare the content
+                uint64_t hash;
+                upToDate = hashFileContent(path, hash) && hash == cachedHash;
+            }
+        }
+        return upToDate;
+    }
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".meshcache";
+}
+
+bool MeshCache::load(const std::string& sourcePath, uint64_t optionsSignature, ModelInfo& model)
+{
+    std::string cachePath = getCachePath(sourcePath);
+    if (!std::filesystem::exists(cachePath)) return false;
+
+    MappedFile file;
+    if (!file.open(cachePath)) return false;
+
+    try
+    {
+        BinaryReader reader(file.data(), file.size());
+        if (reader.read<uint32_t>() != CACHE_MAGIC) return false;
+        if (reader.read<uint32_t>() != CACHE_VERSION) return false;
+        if (reader.read<uint32_t>() != sizeof(VulkanVertex)) return false;
+        if (reader.read<uint64_t>() != optionsSignature) return false;
+        if (!dependenciesUpToDate(reader)) return false;
+
+        ModelInfo cached;
+
+        uint32_t materialCount = reader.read<uint32_t>();
+        cached.materials.resize(materialCount);
+        for (PBRMaterialInfo& material : cached.materials)
+        {
+            material.name = reader.readString();
+            material.albedoTexture = reader.readString();
+            material.normalTexture = reader.readString();
+            material.metallicTexture = reader.readString();
+            material.roughnessTexture = reader.readString();
+            material.aoTexture = reader.readString();
+            material.bumpTexture = reader.readString();
+            material.displacementTexture = reader.readString();
+            reader.readBytes(material.albedoFactor, sizeof(material.albedoFactor));
+            material.metallicFactor = reader.read<float>();
+            material.roughnessFactor = reader.read<float>();
+            material.aoFactor = reader.read<float>();
+        }
+
+        uint32_t meshCount = reader.read<uint32_t>();
+        cached.meshes.resize(meshCount);
+        cached.meshMaterialIndices.resize(meshCount);
+        for (uint32_t i = 0; i < meshCount; i++)
+        {
+            MeshInfo& mesh = cached.meshes[i];
+            cached.meshMaterialIndices[i] = reader.read<int32_t>();
+
+            uint32_t vertexCount = reader.read<uint32_t>();
+            uint32_t indexCount = reader.read<uint32_t>();
+            mesh.vertices.resize(vertexCount);
+            mesh.indices.resize(indexCount);
+            reader.readBytes(mesh.vertices.data(), vertexCount * sizeof(VulkanVertex));
+            reader.readBytes(mesh.indices.data(), indexCount * sizeof(uint32_t));
+
+            mesh.lods.resize(reader.read<uint32_t>());
+            for (MeshLod& lod : mesh.lods)
+            {
+                lod.error = reader.read<float>();
+                lod.indices.resize(reader.read<uint32_t>());
+                reader.readBytes(lod.indices.data(), lod.indices.size() * sizeof(uint32_t));
+            }
+
+            mesh.clusters.resize(reader.read<uint32_t>());
+            reader.readBytes(mesh.clusters.data(), mesh.clusters.size() * sizeof(MeshCluster));
+            mesh.bounds = reader.read<BoundingVolume>();
+        }
+        cached.bounds = reader.read<BoundingVolume>();
+
+        model = std::move(cached);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Ignoring mesh cache " + cachePath + ": " + e.what() + "\n";
+        return false;
+    }
+}
+
+void MeshCache::store(const std::string& sourcePath, const std::vector<std::string>& dependencies, uint64_t optionsSignature, const ModelInfo& model)
+{
+    BinaryWriter writer;
+    writer.write(CACHE_MAGIC);
+    writer.write(CACHE_VERSION);
+    writer.write(static_cast<uint32_t>(sizeof(VulkanVertex)));
+    writer.write(optionsSignature);
+
+    writer.write(static_cast<uint32_t>(dependencies.size()));
+    for (const std::string& path : dependencies)
+    {
+        FileStamp stamp;
+        uint64_t hash;
+        if (!getFileStamp(path, stamp) || !hashFileContent(path, hash))
+        {
+            std::cerr << "Cannot cache " + sourcePath + ", missing dependency " + path + "\n";
+            return;
+        }
+        writer.writeString(path);
+        writer.write(stamp.size);
+        writer.write(stamp.modifiedTime);
+        writer.write(hash);
+    }
+
+    writer.write(static_cast<uint32_t>(model.materials.size()));
+    for (const PBRMaterialInfo& material : model.materials)
+    {
+        writer.writeString(material.name);
+        writer.writeString(material.albedoTexture);
+        writer.writeString(material.normalTexture);
+        writer.writeString(material.metallicTexture);
+        writer.writeString(material.roughnessTexture);
+        writer.writeString(material.aoTexture);
+        writer.writeString(material.bumpTexture);
+        writer.writeString(material.displacementTexture);
+        writer.writeBytes(material.albedoFactor, sizeof(material.albedoFactor));
+        writer.write(material.metallicFactor);
+        writer.write(material.roughnessFactor);
+        writer.write(material.aoFactor);
+    }
+
+    writer.write(static_cast<uint32_t>(model.meshes.size()));
+    for (size_t i = 0; i < model.meshes.size(); i++)
+    {
+        const MeshInfo& mesh = model.meshes[i];
+        writer.write(static_cast<int32_t>(model.meshMaterialIndices[i]));
+        writer.write(static_cast<uint32_t>(mesh.vertices.size()));
+        writer.write(static_cast<uint32_t>(mesh.indices.size()));
+        writer.writeBytes(mesh.vertices.data(), mesh.vertices.size() * sizeof(VulkanVertex));
+        writer.writeBytes(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+
+        writer.write(static_cast<uint32_t>(mesh.lods.size()));
+        for (const MeshLod& lod : mesh.lods)
+        {
+            writer.write(lod.error);
+            writer.write(static_cast<uint32_t>(lod.indices.size()));
+            writer.writeBytes(lod.indices.data(), lod.indices.size() * sizeof(uint32_t));
+        }
+
+        writer.write(static_cast<uint32_t>(mesh.clusters.size()));
+        writer.writeBytes(mesh.clusters.data(), mesh.clusters.size() * sizeof(MeshCluster));
+        writer.write(mesh.bounds);
+    }
+    writer.write(model.bounds);
+
+    // Write to a temporary file first so a concurrent or interrupted write never leaves a broken cache behind
+    std::string cachePath = getCachePath(sourcePath);
+    std::ostringstream tempPath;
+    tempPath << cachePath << "." << std::this_thread::get_id() << ".tmp";
+
+    {
+        std::ofstream file(tempPath.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to write mesh cache " + cachePath + "\n";
+            return;
+        }
+        file.write(writer.buffer.data(), writer.buffer.size());
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath.str(), cachePath, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath.str(), error);
+        std::cerr << "Failed to write mesh cache " + cachePath + "\n";
+    }
+}
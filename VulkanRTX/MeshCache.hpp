@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// Versioned binary cache of imported models, stored next to the source file.
+/// A cache entry is valid while every source it was built from keeps its size and mtime (or content hash).
+/// </summary>
+class MeshCache
+{
+public:
+    static std::string getCachePath(const std::string& sourcePath);
+
+    /// <summary>
+    /// Loads the cached model of the given source, returns false when there is no valid cache entry.
+    /// optionsSignature identifies the import settings the entry must have been built with.
+    /// </summary>
+    static bool load(const std::string& sourcePath, uint64_t optionsSignature, ModelInfo& model);
+
+    /// <summary>
+    /// Writes the cache entry of a model. dependencies lists every file the model was built from.
+    /// </summary>
+    static void store(const std::string& sourcePath, const std::vector<std::string>& dependencies, uint64_t optionsSignature, const ModelInfo& model);
+};
@@ -0,0 +1,145 @@
+#include "MeshCleaner.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+#include "ThreadPool.hpp"
+
+namespace
+{
+    // Twice the area over the longest squared edge, below this the corners are collinear within float precision
+    constexpr float COLLINEAR_EPSILON = 1e-6f;
+
+    struct TriangleKey
+    {
+        uint32_t a, b, c;
+
+        bool operator==(const TriangleKey& other) const
+        {
+            return a == other.a && b == other.b && c == other.c;
+        }
+    };
+
+    struct TriangleKeyHash
+    {
+        size_t operator()(const TriangleKey& key) const
+        {
+            uint64_t hash = (static_cast<uint64_t>(key.a) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(key.b) * 0xC2B2AE3D27D4EB4Full) ^ (static_cast<uint64_t>(key.c) * 0x165667B19E3779F9ull);
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    // Rotated so the smallest index comes first, the winding is kept
+    TriangleKey getKey(uint32_t a, uint32_t b, uint32_t c)
+    {
+        if (b < a && b < c) return { b, c, a };
+        if (c < a && c < b) return { c, a, b };
+        return { a, b, c };
+    }
+
+    bool hasZeroArea(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        glm::vec3 ab = b - a;
+        glm::vec3 ac = c - a;
+        glm::vec3 bc = c - b;
+        float longestEdge = std::max({ glm::dot(ab, ab), glm::dot(ac, ac), glm::dot(bc, bc) });
+        return glm::length(glm::cross(ab, ac)) <= COLLINEAR_EPSILON * longestEdge;
+    }
+}
+
+MeshCleanupStatistics MeshCleaner::clean(MeshInfo& mesh)
+{
+    MeshCleanupStatistics statistics;
+
+    std::unordered_set<TriangleKey, TriangleKeyHash> triangles;
+    triangles.reserve(mesh.indices.size() / 3);
+
+    size_t kept = 0;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        uint32_t a = mesh.indices[i];
+        uint32_t b = mesh.indices[i + 1];
+        uint32_t c = mesh.indices[i + 2];
+        if (a == b || b == c || a == c || hasZeroArea(mesh.vertices[a].pos, mesh.vertices[b].pos, mesh.vertices[c].pos))
+        {
+            statistics.degenerateTriangles++;
+            continue;
+        }
+        if (!triangles.insert(getKey(a, b, c)).second)
+        {
+            statistics.duplicateTriangles++;
+            continue;
+        }
+
+        mesh.indices[kept++] = a;
+        mesh.indices[kept++] = b;
+        mesh.indices[kept++] = c;
+    }
+    mesh.indices.resize(kept);
+
+    if (statistics.degenerateTriangles == 0 && statistics.duplicateTriangles == 0)
+    {
+        return statistics;
+    }
+
+    // Compact the vertices still referenced, in their original order
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    for (uint32_t index : mesh.indices)
+    {
+        remap[index] = 0;
+    }
+    uint32_t vertexCount = 0;
+    for (size_t v = 0; v < mesh.vertices.size(); v++)
+    {
+        if (remap[v] == UINT32_MAX) continue;
+        remap[v] = vertexCount;
+        mesh.vertices[vertexCount++] = mesh.vertices[v];
+    }
+    statistics.unusedVertices = mesh.vertices.size() - vertexCount;
+    mesh.vertices.resize(vertexCount);
+
+    for (uint32_t& index : mesh.indices)
+    {
+        index = remap[index];
+    }
+    return statistics;
+}
+
+std::vector<size_t> MeshCleaner::clean(ModelInfo& model, const std::string& modelPath)
+{
+    std::vector<MeshCleanupStatistics> statistics(model.meshes.size());
+    ThreadPool::getShared().parallelFor(model.meshes.size(), [&](size_t i)
+    {
+        statistics[i] = clean(model.meshes[i]);
+    });
+
+    // One line per mesh that lost triangles under the model path, buffered and written at once so models imported in
+    // parallel do not interleave
+    std::ostringstream report;
+    std::vector<size_t> keptMeshes;
+    for (size_t i = 0; i < model.meshes.size(); i++)
+    {
+        const MeshCleanupStatistics& mesh = statistics[i];
+        if (mesh.degenerateTriangles > 0 || mesh.duplicateTriangles > 0)
+        {
+            report << modelPath << ": mesh " << i << " cleanup dropped " << mesh.degenerateTriangles << " degenerate and " << mesh.duplicateTriangles
+                << " duplicate triangles, " << mesh.unusedVertices << " unused vertices, " << model.meshes[i].indices.size() / 3 << " triangles left\n";
+        }
+
+        if (model.meshes[i].indices.empty())
+        {
+            continue;
+        }
+        if (keptMeshes.size() != i)
+        {
+            model.meshes[keptMeshes.size()] = std::move(model.meshes[i]);
+            model.meshMaterialIndices[keptMeshes.size()] = model.meshMaterialIndices[i];
+        }
+        keptMeshes.push_back(i);
+    }
+    std::cout << report.str() << std::flush;
+
+    model.meshes.resize(keptMeshes.size());
+    model.meshMaterialIndices.resize(keptMeshes.size());
+    return keptMeshes;
+}
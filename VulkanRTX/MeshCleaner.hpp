@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+struct MeshCleanupStatistics
+{
+    size_t degenerateTriangles = 0; // Repeated index, collapsed by welding, or zero area
+    size_t duplicateTriangles = 0; // Same three vertices with the same winding as an earlier triangle
+    size_t unusedVertices = 0; // Only referenced by removed triangles
+};
+
+/// <summary>
+/// Removes triangles that add BLAS primitives and vertex work without covering any surface: triangles with a repeated index,
+/// triangles whose corners are collinear or coincident, and exact duplicates. A triangle and its reverse both stay, they face
+/// opposite ways. Vertices left unreferenced are dropped and the remaining ones keep their order.
+/// Runs on the base indices, before clustering and LOD generation.
+/// </summary>
+class MeshCleaner
+{
+public:
+    static MeshCleanupStatistics clean(MeshInfo& mesh);
+
+    /// <summary>
+    /// Cleans every mesh in parallel, prints what was dropped from each mesh and removes meshes left without triangles along
+    /// with their material index. Returns the original index of every mesh kept, in order.
+    /// </summary>
+    static std::vector<size_t> clean(ModelInfo& model, const std::string& modelPath);
+};
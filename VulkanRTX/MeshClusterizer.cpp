@@ -0,0 +1,293 @@
+#include "MeshClusterizer.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include "ImportSettings.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    constexpr int BIN_COUNT = 16;
+
+    // Clusters smaller than this cost more as separate geometries than they save in traversal
+    constexpr uint32_t MIN_CLUSTER_TRIANGLES = 256;
+
+    // Under the budget, a node is only split when its SAH cost drops below this fraction of the unsplit cost.
+    // Halving a compact or flat patch costs about 0.5, disjoint parts go well below.
+    constexpr float INCOHERENT_SPLIT_COST = 0.4f;
+
+    struct Bounds
+    {
+        glm::vec3 min = glm::vec3(FLT_MAX);
+        glm::vec3 max = glm::vec3(-FLT_MAX);
+
+        void grow(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void grow(const Bounds& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        float getArea() const
+        {
+            if (min.x > max.x) return 0.0f;
+            glm::vec3 extent = max - min;
+            return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        }
+    };
+
+    Bounds getTriangleBounds(const MeshInfo& mesh, size_t triangle)
+    {
+        Bounds bounds;
+        for (int k = 0; k < 3; k++)
+        {
+            bounds.grow(mesh.vertices[mesh.indices[triangle * 3 + k]].pos);
+        }
+        return bounds;
+    }
+
+    Bounds getRangeBounds(const MeshInfo& mesh, uint32_t firstIndex, uint32_t indexCount)
+    {
+        Bounds bounds;
+        for (uint32_t i = firstIndex; i < firstIndex + indexCount; i++)
+        {
+            bounds.grow(mesh.vertices[mesh.indices[i]].pos);
+        }
+        return bounds;
+    }
+
+    class ClusterBuilder
+    {
+    private:
+        const std::vector<Bounds>& triangleBounds;
+        const std::vector<glm::vec3>& centroids;
+        std::vector<uint32_t>& order;
+        uint32_t maxTriangles;
+
+    public:
+        std::vector<std::pair<uint32_t, uint32_t>> leaves; // Ranges of order
+
+        ClusterBuilder(const std::vector<Bounds>& triangleBounds, const std::vector<glm::vec3>& centroids, std::vector<uint32_t>& order, uint32_t maxTriangles)
+            : triangleBounds(triangleBounds), centroids(centroids), order(order), maxTriangles(maxTriangles)
+        {
+        }
+
+        void build(uint32_t begin, uint32_t end)
+        {
+            uint32_t count = end - begin;
+            bool forced = count > maxTriangles;
+            if (!forced && count < 2 * MIN_CLUSTER_TRIANGLES)
+            {
+                leaves.emplace_back(begin, end);
+                return;
+            }
+
+            Bounds bounds;
+            Bounds centroidBounds;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                bounds.grow(triangleBounds[order[i]]);
+                centroidBounds.grow(centroids[order[i]]);
+            }
+
+            // Binned SAH over the centroids on every axis
+            int bestAxis = -1;
+            int bestBin = 0;
+            float bestCost = FLT_MAX;
+            uint32_t bestLeftCount = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+                if (extent <= 0.0f) continue;
+                float binScale = BIN_COUNT / extent;
+
+                Bounds binBounds[BIN_COUNT];
+                uint32_t binCounts[BIN_COUNT] = {};
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    int bin = std::min(BIN_COUNT - 1, static_cast<int>((centroids[order[i]][axis] - centroidBounds.min[axis]) * binScale));
+                    binBounds[bin].grow(triangleBounds[order[i]]);
+                    binCounts[bin]++;
+                }
+
+                // Sweep from the right to get the cost of the right side of every split plane
+                float rightCosts[BIN_COUNT] = {};
+                Bounds right;
+                uint32_t rightCount = 0;
+                for (int bin = BIN_COUNT - 1; bin > 0; bin--)
+                {
+                    right.grow(binBounds[bin]);
+                    rightCount += binCounts[bin];
+                    rightCosts[bin] = right.getArea() * rightCount;
+                }
+
+                Bounds left;
+                uint32_t leftCount = 0;
+                for (int bin = 0; bin < BIN_COUNT - 1; bin++)
+                {
+                    left.grow(binBounds[bin]);
+                    leftCount += binCounts[bin];
+                    if (leftCount == 0 || leftCount == count) continue;
+
+                    float cost = left.getArea() * leftCount + rightCosts[bin + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = bin;
+                        bestLeftCount = leftCount;
+                    }
+                }
+            }
+
+            uint32_t middle = begin + count / 2;
+            if (bestAxis >= 0)
+            {
+                float parentArea = bounds.getArea();
+                float relativeCost = parentArea > 0.0f ? bestCost / (parentArea * count) : 1.0f;
+                bool balanced = bestLeftCount >= MIN_CLUSTER_TRIANGLES && count - bestLeftCount >= MIN_CLUSTER_TRIANGLES;
+                if (!forced && !(balanced && relativeCost < INCOHERENT_SPLIT_COST))
+                {
+                    leaves.emplace_back(begin, end);
+                    return;
+                }
+
+                float binScale = BIN_COUNT / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+                float minimum = centroidBounds.min[bestAxis];
+                middle = static_cast<uint32_t>(std::partition(order.begin() + begin, order.begin() + end, [&](uint32_t triangle)
+                {
+                    return std::min(BIN_COUNT - 1, static_cast<int>((centroids[triangle][bestAxis] - minimum) * binScale)) <= bestBin;
+                }) - order.begin());
+            }
+            else if (!forced)
+            {
+                leaves.emplace_back(begin, end);
+                return;
+            }
+            // Over budget with every centroid at the same place: any split works
+
+            build(begin, middle);
+            build(middle, end);
+        }
+    };
+
+    void accumulate(GeometryStatistics& statistics, const Bounds& bounds, uint32_t triangleCount, std::vector<std::pair<float, uint32_t>>& geometries)
+    {
+        statistics.geometryCount++;
+        statistics.triangleCount += triangleCount;
+        geometries.emplace_back(bounds.getArea(), triangleCount);
+    }
+}
+
+void MeshClusterizer::clusterize(MeshInfo& mesh, uint32_t maxTriangles)
+{
+    mesh.clusters.clear();
+    uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+    if (maxTriangles == 0 || triangleCount < 2 * MIN_CLUSTER_TRIANGLES)
+    {
+        return;
+    }
+    maxTriangles = std::max(maxTriangles, MIN_CLUSTER_TRIANGLES);
+
+    std::vector<Bounds> triangleBounds(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        triangleBounds[t] = getTriangleBounds(mesh, t);
+        centroids[t] = (triangleBounds[t].min + triangleBounds[t].max) * 0.5f;
+    }
+
+    std::vector<uint32_t> order(triangleCount);
+    std::iota(order.begin(), order.end(), 0);
+    ClusterBuilder builder(triangleBounds, centroids, order, maxTriangles);
+    builder.build(0, triangleCount);
+    if (builder.leaves.size() <= 1)
+    {
+        return;
+    }
+
+    // Depth first leaf order keeps neighbouring clusters close in the index buffer
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh.indices.size());
+    for (const auto& [begin, end] : builder.leaves)
+    {
+        mesh.clusters.push_back({ static_cast<uint32_t>(indices.size()), (end - begin) * 3 });
+        for (uint32_t i = begin; i < end; i++)
+        {
+            uint32_t triangle = order[i];
+            indices.insert(indices.end(), mesh.indices.begin() + triangle * 3, mesh.indices.begin() + triangle * 3 + 3);
+        }
+    }
+    mesh.indices.swap(indices);
+}
+
+void MeshClusterizer::clusterize(std::vector<MeshInfo>& meshes, const std::string& modelPath)
+{
+    GeometryStatistics before = analyze(meshes, false);
+
+    uint32_t maxTriangles = static_cast<uint32_t>(std::max(ImportSettings::clusterTriangleBudget, 0));
+    ThreadPool::getShared().parallelFor(meshes.size(), [&](size_t i)
+    {
+        clusterize(meshes[i], maxTriangles);
+    });
+
+    GeometryStatistics after = analyze(meshes, true);
+    if (after.geometryCount == before.geometryCount)
+    {
+        return;
+    }
+
+    // Formatted locally and written at once, models are imported in parallel
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2) << modelPath << ": BLAS geometries " << before.geometryCount << " -> " << after.geometryCount
+        << ", SAH cost " << before.sahCost << " -> " << after.sahCost
+        << ", overlap " << before.overlap << " -> " << after.overlap << "\n";
+    std::cout << report.str() << std::flush;
+}
+
+GeometryStatistics MeshClusterizer::analyze(const std::vector<MeshInfo>& meshes, bool clustered)
+{
+    GeometryStatistics statistics;
+    std::vector<std::pair<float, uint32_t>> geometries; // Area and triangle count
+    Bounds total;
+    for (const MeshInfo& mesh : meshes)
+    {
+        if (!clustered || mesh.clusters.empty())
+        {
+            Bounds bounds = getRangeBounds(mesh, 0, static_cast<uint32_t>(mesh.indices.size()));
+            accumulate(statistics, bounds, static_cast<uint32_t>(mesh.indices.size() / 3), geometries);
+            total.grow(bounds);
+            continue;
+        }
+
+        for (const MeshCluster& cluster : mesh.clusters)
+        {
+            Bounds bounds = getRangeBounds(mesh, cluster.firstIndex, cluster.indexCount);
+            accumulate(statistics, bounds, cluster.indexCount / 3, geometries);
+            total.grow(bounds);
+        }
+    }
+
+    float totalArea = total.getArea();
+    if (totalArea <= 0.0f)
+    {
+        statistics.sahCost = static_cast<float>(statistics.triangleCount);
+        statistics.overlap = 1.0f;
+        return statistics;
+    }
+
+    for (const auto& [area, triangleCount] : geometries)
+    {
+        statistics.sahCost += area / totalArea * triangleCount;
+        statistics.overlap += area / totalArea;
+    }
+    return statistics;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// Surface area heuristic of the geometries handed to a BLAS build. Areas are relative to the bounds of everything analyzed,
+/// so the cost is the expected number of triangles in geometries whose bounds a ray through the whole model enters.
+/// </summary>
+struct GeometryStatistics
+{
+    size_t geometryCount = 0;
+    size_t triangleCount = 0;
+    float sahCost = 0.0f;
+    float overlap = 0.0f; // Summed geometry bounds area over the total bounds area, 1 for a single geometry
+};
+
+/// <summary>
+/// Splits meshes into spatially compact clusters of at most a triangle budget, with a binned SAH partition of the triangle
+/// centroids. Meshes under the budget are still split when the SAH shows disjoint parts, like the floors of a building merged
+/// by material. Triangles are reordered so every cluster is a contiguous index range; raster draws are unchanged while the
+/// BLAS gets one geometry per cluster.
+/// </summary>
+class MeshClusterizer
+{
+public:
+    static void clusterize(MeshInfo& mesh, uint32_t maxTriangles);
+
+    /// <summary>
+    /// Clusterizes every mesh in parallel with ImportSettings::clusterTriangleBudget and prints the geometry SAH of the model
+    /// before and after.
+    /// </summary>
+    static void clusterize(std::vector<MeshInfo>& meshes, const std::string& modelPath);
+
+    /// <summary>
+    /// Statistics of one geometry per cluster, or per mesh when clustered is false.
+    /// </summary>
+    static GeometryStatistics analyze(const std::vector<MeshInfo>& meshes, bool clustered);
+};
@@ -0,0 +1,313 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "ThreadPool.hpp"
+
+namespace
+{
+    // Cache modelled by the optimizer, scores are precomputed for every cache position and valence below these limits
+    constexpr uint32_t CACHE_SIZE = 32;
+    constexpr uint32_t MAX_VALENCE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    struct ScoreTables
+    {
+        float cache[CACHE_SIZE];
+        float valence[MAX_VALENCE];
+
+        ScoreTables()
+        {
+            for (uint32_t i = 0; i < CACHE_SIZE; i++)
+            {
+                if (i < 3)
+                {
+                    // The vertices of the last triangle are penalized so strips do not loop back on themselves
+                    cache[i] = LAST_TRIANGLE_SCORE;
+                }
+                else
+                {
+                    float scaler = 1.0f / (CACHE_SIZE - 3);
+                    cache[i] = std::pow(1.0f - (i - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+
+            valence[0] = 0.0f;
+            for (uint32_t i = 1; i < MAX_VALENCE; i++)
+            {
+                valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+            }
+        }
+    };
+
+    const ScoreTables& getScoreTables()
+    {
+        static const ScoreTables tables;
+        return tables;
+    }
+
+    float getVertexScore(int32_t cachePosition, uint32_t liveTriangles)
+    {
+        if (liveTriangles == 0)
+        {
+            // No triangle left to emit
+            return -1.0f;
+        }
+
+        const ScoreTables& tables = getScoreTables();
+        float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+        return score + tables.valence[std::min(liveTriangles, MAX_VALENCE - 1)];
+    }
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+        return;
+    }
+
+    // Vertex to triangle adjacency
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices)
+    {
+        liveTriangles[index]++;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = indices[t * 3 + k];
+            adjacency[adjacencyFill[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        vertexScores[v] = getVertexScore(-1, liveTriangles[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    // The cache briefly holds the 3 vertices of the emitted triangle on top of its size
+    uint32_t cache[CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    size_t scanCursor = 0;
+    int64_t bestTriangle = -1;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle < 0)
+        {
+            // Nothing in the cache has triangles left, continue with the next unemitted triangle in input order
+            while (emitted[scanCursor]) scanCursor++;
+            bestTriangle = static_cast<int64_t>(scanCursor);
+        }
+
+        uint32_t triangle = static_cast<uint32_t>(bestTriangle);
+        const uint32_t* triangleIndices = &indices[static_cast<size_t>(triangle) * 3];
+        result.insert(result.end(), triangleIndices, triangleIndices + 3);
+        emitted[triangle] = 1;
+
+        // Move the triangle vertices to the front of the cache, the rest keeps its order
+        uint32_t newCache[CACHE_SIZE + 3];
+        uint32_t newCacheCount = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            newCache[newCacheCount++] = triangleIndices[k];
+        }
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            uint32_t v = cache[i];
+            if (v != triangleIndices[0] && v != triangleIndices[1] && v != triangleIndices[2])
+            {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        // Remove the triangle from the adjacency of its vertices
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = triangleIndices[k];
+            uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+            uint32_t* end = begin + liveTriangles[v];
+            uint32_t* found = std::find(begin, end, triangle);
+            std::swap(*found, *(end - 1));
+            liveTriangles[v]--;
+        }
+
+        // Update the scores of everything that was in the cache, vertices pushed out now score as uncached
+        for (uint32_t i = 0; i < newCacheCount; i++)
+        {
+            uint32_t v = newCache[i];
+            int32_t position = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+
+            float score = getVertexScore(position, liveTriangles[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            const uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+            for (uint32_t a = 0; a < liveTriangles[v]; a++)
+            {
+                triangleScores[begin[a]] += delta;
+            }
+        }
+
+        // Next triangle is the best one touching the cache
+        float bestScore = -1.0f;
+        bestTriangle = -1;
+        for (uint32_t i = 0; i < std::min(newCacheCount, CACHE_SIZE); i++)
+        {
+            uint32_t v = newCache[i];
+            const uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+            for (uint32_t a = 0; a < liveTriangles[v]; a++)
+            {
+                uint32_t t = begin[a];
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(newCacheCount, CACHE_SIZE);
+        std::copy(newCache, newCache + cacheCount, cache);
+    }
+
+    // Keep any trailing indices of an incomplete triangle
+    result.insert(result.end(), indices.begin() + triangleCount * 3, indices.end());
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(MeshInfo& mesh)
+{
+    constexpr uint32_t UNUSED = ~0u;
+    std::vector<uint32_t> remap(mesh.vertices.size(), UNUSED);
+
+    // Number vertices in the order the index buffer first references them, unreferenced vertices are dropped
+    std::vector<VulkanVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (uint32_t& index : mesh.indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(vertices);
+}
+
+VertexCacheStatistics MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStatistics statistics;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+    {
+        return statistics;
+    }
+
+    // A vertex is in the FIFO when it was inserted less than cacheSize misses ago
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    uint64_t misses = 0;
+    size_t uniqueVertices = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        uint32_t v = indices[i];
+        if (!referenced[v])
+        {
+            referenced[v] = 1;
+            uniqueVertices++;
+        }
+
+        if (insertedAt[v] == 0 || misses - insertedAt[v] >= cacheSize)
+        {
+            misses++;
+            insertedAt[v] = misses;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(misses) / triangleCount;
+    statistics.atvr = static_cast<float>(misses) / uniqueVertices;
+    return statistics;
+}
+
+void MeshOptimizer::optimizeVertexCache(MeshInfo& mesh)
+{
+    if (mesh.clusters.empty())
+    {
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    }
+    else
+    {
+        // Triangles only move inside their cluster so cluster ranges stay valid
+        std::vector<uint32_t> clusterIndices;
+        for (const MeshCluster& cluster : mesh.clusters)
+        {
+            auto first = mesh.indices.begin() + cluster.firstIndex;
+            clusterIndices.assign(first, first + cluster.indexCount);
+            optimizeVertexCache(clusterIndices, mesh.vertices.size());
+            std::copy(clusterIndices.begin(), clusterIndices.end(), first);
+        }
+    }
+}
+
+void MeshOptimizer::optimize(MeshInfo& mesh)
+{
+    optimizeVertexCache(mesh);
+    optimizeVertexFetch(mesh);
+}
+
+void MeshOptimizer::optimize(std::vector<MeshInfo>& meshes, const std::string& modelPath)
+{
+    std::vector<VertexCacheStatistics> before(meshes.size());
+    std::vector<VertexCacheStatistics> after(meshes.size());
+
+    ThreadPool::getShared().parallelFor(meshes.size(), [&](size_t i)
+    {
+        before[i] = analyzeVertexCache(meshes[i].indices, meshes[i].vertices.size());
+        optimize(meshes[i]);
+        after[i] = analyzeVertexCache(meshes[i].indices, meshes[i].vertices.size());
+    });
+
+    // One line per mesh under the model path, buffered and written at once so models imported in parallel do not interleave
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        report << modelPath << ": mesh " << i << " (" << meshes[i].indices.size() / 3 << " triangles): ACMR " << before[i].acmr << " -> " << after[i].acmr
+            << ", ATVR " << before[i].atvr << " -> " << after[i].atvr << "\n";
+    }
+    std::cout << report.str() << std::flush;
+}
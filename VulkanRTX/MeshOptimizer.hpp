@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+struct VertexCacheStatistics
+{
+    float acmr = 0.0f; // Average cache miss ratio, transformed vertices per triangle
+    float atvr = 0.0f; // Average transformed vertex ratio, transformed vertices per referenced vertex
+};
+
+/// <summary>
+/// Reorders mesh data for the GPU: triangles are sorted for the post-transform vertex cache (Forsyth, "Linear-Speed Vertex
+/// Cache Optimisation"), then vertices are renumbered in first use order so fetches walk the vertex buffer linearly.
+/// The mesh keeps the same triangles with the same winding, triangles of a cluster stay in its index range.
+/// </summary>
+class MeshOptimizer
+{
+public:
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    /// <summary>
+    /// Optimizes the base indices of a mesh for the vertex cache, one cluster at a time when the mesh is clustered.
+    /// </summary>
+    static void optimizeVertexCache(MeshInfo& mesh);
+    static void optimizeVertexFetch(MeshInfo& mesh);
+
+    /// <summary>
+    /// Simulates a FIFO post-transform cache of the given size over the index buffer.
+    /// </summary>
+    static VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+    static void optimize(MeshInfo& mesh);
+
+    /// <summary>
+    /// Optimizes every mesh in parallel and prints the ACMR/ATVR of each mesh before and after.
+    /// </summary>
+    static void optimize(std::vector<MeshInfo>& meshes, const std::string& modelPath);
+};
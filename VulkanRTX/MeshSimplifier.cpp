@@ -0,0 +1,634 @@
+#include "MeshSimplifier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "ImportSettings.hpp"
+#include "MeshOptimizer.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    constexpr uint32_t NONE = ~0u;
+    constexpr uint32_t MULTIPLE = ~0u - 1;
+
+    // Edge quadrics keep borders and seams in place, borders are the visible ones
+    constexpr double BORDER_EDGE_WEIGHT = 10.0;
+    constexpr double SEAM_EDGE_WEIGHT = 1.0;
+
+    // Attribute differences are compared with squared distances relative to the mesh extent
+    constexpr float NORMAL_WEIGHT = 0.1f;
+    constexpr float TEXCOORD_WEIGHT = 0.2f;
+
+    // A pass collapses edges up to this factor above the error expected to reach the target
+    constexpr float PASS_ERROR_BOUND = 1.5f;
+
+    enum class VertexKind : uint8_t
+    {
+        Manifold, // Interior vertex with continuous attributes
+        Border,   // On an open boundary
+        Seam,     // On an attribute seam, two wedges share the position
+        Locked
+    };
+
+    struct Quadric
+    {
+        double a00 = 0, a11 = 0, a22 = 0;
+        double a10 = 0, a20 = 0, a21 = 0;
+        double b0 = 0, b1 = 0, b2 = 0;
+        double c = 0;
+        double w = 0;
+
+        void addPlane(const glm::dvec3& n, double d, double weight)
+        {
+            a00 += weight * n.x * n.x;
+            a11 += weight * n.y * n.y;
+            a22 += weight * n.z * n.z;
+            a10 += weight * n.y * n.x;
+            a20 += weight * n.z * n.x;
+            a21 += weight * n.z * n.y;
+            b0 += weight * n.x * d;
+            b1 += weight * n.y * d;
+            b2 += weight * n.z * d;
+            c += weight * d * d;
+            w += weight;
+        }
+
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a11 += q.a11; a22 += q.a22;
+            a10 += q.a10; a20 += q.a20; a21 += q.a21;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2;
+            c += q.c;
+            w += q.w;
+        }
+
+        // Weighted mean of the squared distances to the accumulated planes
+        double error(const glm::dvec3& p) const
+        {
+            double rx = a00 * p.x + a10 * p.y + a20 * p.z + b0;
+            double ry = a10 * p.x + a11 * p.y + a21 * p.z + b1;
+            double rz = a20 * p.x + a21 * p.y + a22 * p.z + b2;
+            double e = rx * p.x + ry * p.y + rz * p.z + b0 * p.x + b1 * p.y + b2 * p.z + c;
+            return w > 0 ? std::fabs(e) / w : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        float error;
+    };
+
+    // Outgoing half edges of every vertex, rebuilt each pass
+    struct EdgeAdjacency
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> triangles; // Vertex to triangle lists use the same offsets
+
+        void build(const std::vector<uint32_t>& indices, size_t vertexCount)
+        {
+            offsets.assign(vertexCount + 1, 0);
+            for (uint32_t index : indices)
+            {
+                offsets[index + 1]++;
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            targets.resize(indices.size());
+            triangles.resize(indices.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < indices.size() / 3; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t v = indices[t * 3 + k];
+                    uint32_t next = indices[t * 3 + (k + 1) % 3];
+                    targets[fill[v]] = next;
+                    triangles[fill[v]] = static_cast<uint32_t>(t);
+                    fill[v]++;
+                }
+            }
+        }
+
+        bool hasEdge(uint32_t from, uint32_t to) const
+        {
+            for (uint32_t e = offsets[from]; e < offsets[from + 1]; e++)
+            {
+                if (targets[e] == to) return true;
+            }
+            return false;
+        }
+    };
+
+    glm::dvec3 toDouble(const glm::vec3& v)
+    {
+        return glm::dvec3(v.x, v.y, v.z);
+    }
+
+    class Simplifier
+    {
+    private:
+        const std::vector<VulkanVertex>& vertices;
+        size_t vertexCount;
+
+        std::vector<glm::dvec3> positions; // Normalized to the unit cube
+        std::vector<uint32_t> remap;       // First vertex with the same position
+        std::vector<uint32_t> wedge;       // Next referenced vertex with the same position, circular
+        std::vector<Quadric> quadrics;     // Indexed by remap
+
+        EdgeAdjacency adjacency;
+        std::vector<VertexKind> kinds;
+        std::vector<uint32_t> openOut;
+        std::vector<uint32_t> openIn;
+
+        void buildPositionRemap()
+        {
+            glm::vec3 minPos(0.0f);
+            glm::vec3 maxPos(0.0f);
+            if (vertexCount > 0)
+            {
+                minPos = maxPos = vertices[0].pos;
+            }
+            for (const VulkanVertex& vertex : vertices)
+            {
+                minPos = glm::min(minPos, vertex.pos);
+                maxPos = glm::max(maxPos, vertex.pos);
+            }
+            glm::vec3 extent = maxPos - minPos;
+            double scale = std::max({ extent.x, extent.y, extent.z });
+            scale = scale > 0 ? 1.0 / scale : 1.0;
+
+            positions.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                positions[i] = (toDouble(vertices[i].pos) - toDouble(minPos)) * scale;
+            }
+
+            std::vector<uint32_t> order(vertexCount);
+            std::iota(order.begin(), order.end(), 0);
+            auto less = [&](uint32_t a, uint32_t b)
+            {
+                const glm::vec3& pa = vertices[a].pos;
+                const glm::vec3& pb = vertices[b].pos;
+                if (pa.x != pb.x) return pa.x < pb.x;
+                if (pa.y != pb.y) return pa.y < pb.y;
+                if (pa.z != pb.z) return pa.z < pb.z;
+                return a < b;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            remap.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                bool samePosition = i > 0 && vertices[order[i]].pos == vertices[order[i - 1]].pos;
+                remap[order[i]] = samePosition ? remap[order[i - 1]] : order[i];
+            }
+        }
+
+        void buildWedges(const std::vector<uint32_t>& indices)
+        {
+            std::vector<uint8_t> referenced(vertexCount, 0);
+            for (uint32_t index : indices)
+            {
+                referenced[index] = 1;
+            }
+
+            // Link the referenced vertices of each position into a ring
+            wedge.resize(vertexCount);
+            std::vector<uint32_t> last(vertexCount, NONE);
+            std::vector<uint32_t> first(vertexCount, NONE);
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                wedge[i] = i;
+                if (!referenced[i]) continue;
+
+                uint32_t r = remap[i];
+                if (first[r] == NONE)
+                {
+                    first[r] = i;
+                }
+                else
+                {
+                    wedge[last[r]] = i;
+                }
+                last[r] = i;
+            }
+            for (uint32_t r = 0; r < vertexCount; r++)
+            {
+                if (first[r] != NONE)
+                {
+                    wedge[last[r]] = first[r];
+                }
+            }
+        }
+
+        // An edge without opposite at the wedge level may still have one at the position level, that is a seam
+        bool hasPositionEdge(uint32_t from, uint32_t to) const
+        {
+            uint32_t target = remap[to];
+            uint32_t v = from;
+            do
+            {
+                for (uint32_t e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; e++)
+                {
+                    if (remap[adjacency.targets[e]] == target) return true;
+                }
+                v = wedge[v];
+            } while (v != from);
+            return false;
+        }
+
+        void classifyVertices()
+        {
+            openOut.assign(vertexCount, NONE);
+            openIn.assign(vertexCount, NONE);
+
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                for (uint32_t e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; e++)
+                {
+                    uint32_t target = adjacency.targets[e];
+                    if (adjacency.hasEdge(target, v)) continue;
+
+                    openOut[v] = openOut[v] == NONE ? target : MULTIPLE;
+                    openIn[target] = openIn[target] == NONE ? v : MULTIPLE;
+                }
+            }
+
+            auto single = [](uint32_t v) { return v != NONE && v != MULTIPLE; };
+
+            kinds.assign(vertexCount, VertexKind::Locked);
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                if (adjacency.offsets[v] == adjacency.offsets[v + 1]) continue;
+
+                if (wedge[v] == v)
+                {
+                    if (openOut[v] == NONE && openIn[v] == NONE)
+                    {
+                        kinds[v] = VertexKind::Manifold;
+                    }
+                    else if (single(openOut[v]) && single(openIn[v])
+                        && !hasPositionEdge(openOut[v], v) && !hasPositionEdge(v, openIn[v]))
+                    {
+                        kinds[v] = VertexKind::Border;
+                    }
+                }
+                else if (wedge[wedge[v]] == v)
+                {
+                    // Both wedges must run along the same seam in opposite directions
+                    uint32_t w = wedge[v];
+                    if (single(openOut[v]) && single(openIn[v]) && single(openOut[w]) && single(openIn[w])
+                        && remap[openOut[v]] == remap[openIn[w]] && remap[openIn[v]] == remap[openOut[w]])
+                    {
+                        kinds[v] = VertexKind::Seam;
+                    }
+                }
+            }
+        }
+
+        void computeQuadrics(const std::vector<uint32_t>& indices)
+        {
+            quadrics.assign(vertexCount, Quadric());
+
+            for (size_t t = 0; t < indices.size() / 3; t++)
+            {
+                const glm::dvec3& p0 = positions[indices[t * 3 + 0]];
+                const glm::dvec3& p1 = positions[indices[t * 3 + 1]];
+                const glm::dvec3& p2 = positions[indices[t * 3 + 2]];
+
+                glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+                double area = glm::length(normal);
+                if (area <= 0) continue;
+                normal /= area;
+
+                double d = -glm::dot(normal, p0);
+                for (int k = 0; k < 3; k++)
+                {
+                    quadrics[remap[indices[t * 3 + k]]].addPlane(normal, d, area);
+                }
+
+                // Planes through open edges, perpendicular to the triangle, keep borders and seams from moving inward
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t i0 = indices[t * 3 + k];
+                    uint32_t i1 = indices[t * 3 + (k + 1) % 3];
+                    bool border = kinds[i0] == VertexKind::Border && openOut[i0] == i1;
+                    bool seam = kinds[i0] == VertexKind::Seam && openOut[i0] == i1;
+                    if (!border && !seam) continue;
+
+                    const glm::dvec3& e0 = positions[i0];
+                    const glm::dvec3& e1 = positions[i1];
+                    glm::dvec3 edge = e1 - e0;
+                    double length = glm::length(edge);
+                    glm::dvec3 edgeNormal = glm::cross(edge, normal);
+                    double edgeNormalLength = glm::length(edgeNormal);
+                    if (edgeNormalLength <= 0) continue;
+                    edgeNormal /= edgeNormalLength;
+
+                    double edgeD = -glm::dot(edgeNormal, e0);
+                    double weight = length * length * (border ? BORDER_EDGE_WEIGHT : SEAM_EDGE_WEIGHT);
+                    quadrics[remap[i0]].addPlane(edgeNormal, edgeD, weight);
+                    quadrics[remap[i1]].addPlane(edgeNormal, edgeD, weight);
+                }
+            }
+        }
+
+        float attributeError(uint32_t a, uint32_t b) const
+        {
+            glm::vec3 normalDelta = vertices[a].normal - vertices[b].normal;
+            glm::vec2 texCoordDelta = vertices[a].texCoord - vertices[b].texCoord;
+            return glm::dot(normalDelta, normalDelta) * NORMAL_WEIGHT * NORMAL_WEIGHT
+                + glm::dot(texCoordDelta, texCoordDelta) * TEXCOORD_WEIGHT * TEXCOORD_WEIGHT;
+        }
+
+        bool canCollapse(uint32_t from, uint32_t to) const
+        {
+            VertexKind kindFrom = kinds[from];
+            VertexKind kindTo = kinds[to];
+            switch (kindFrom)
+            {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border:
+                // Only along the border itself
+                return kindTo == VertexKind::Border && (openOut[from] == to || openIn[from] == to);
+            case VertexKind::Seam:
+            {
+                // Along the seam, the other wedge has to follow the sibling edge
+                if (kindTo != VertexKind::Seam || (openOut[from] != to && openIn[from] != to)) return false;
+                uint32_t siblingFrom = wedge[from];
+                uint32_t siblingTo = wedge[to];
+                return openOut[siblingFrom] == siblingTo || openIn[siblingFrom] == siblingTo;
+            }
+            default:
+                return false;
+            }
+        }
+
+        float collapseError(uint32_t from, uint32_t to) const
+        {
+            double error = quadrics[remap[from]].error(positions[to]);
+            float attributes = attributeError(from, to);
+            if (kinds[from] == VertexKind::Seam)
+            {
+                attributes = std::max(attributes, attributeError(wedge[from], wedge[to]));
+            }
+            return static_cast<float>(error) + attributes;
+        }
+
+        std::vector<Collapse> pickCollapses(const std::vector<uint32_t>& indices) const
+        {
+            std::vector<Collapse> collapses;
+            collapses.reserve(indices.size());
+
+            for (size_t t = 0; t < indices.size() / 3; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t i0 = indices[t * 3 + k];
+                    uint32_t i1 = indices[t * 3 + (k + 1) % 3];
+
+                    // Interior edges are seen from both triangles, keep one of them
+                    if (remap[i0] == remap[i1]) continue;
+                    if (remap[i0] > remap[i1] && hasPositionEdge(i1, i0)) continue;
+
+                    bool forward = canCollapse(i0, i1);
+                    bool backward = canCollapse(i1, i0);
+                    if (!forward && !backward) continue;
+
+                    float forwardError = forward ? collapseError(i0, i1) : 0.0f;
+                    float backwardError = backward ? collapseError(i1, i0) : 0.0f;
+
+                    if (forward && (!backward || forwardError <= backwardError))
+                    {
+                        collapses.push_back({ i0, i1, forwardError });
+                    }
+                    else
+                    {
+                        collapses.push_back({ i1, i0, backwardError });
+                    }
+                }
+            }
+            return collapses;
+        }
+
+        // Rejects collapses that would flip a triangle around the collapsed position
+        bool flipsTriangles(uint32_t from, uint32_t to, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& collapseRemap) const
+        {
+            uint32_t fromPosition = remap[from];
+            uint32_t toPosition = remap[to];
+            const glm::dvec3& target = positions[to];
+
+            uint32_t v = from;
+            do
+            {
+                for (uint32_t e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; e++)
+                {
+                    uint32_t t = adjacency.triangles[e];
+                    uint32_t corners[3];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        corners[k] = collapseRemap[indices[t * 3 + k]];
+                    }
+
+                    if (remap[corners[0]] == remap[corners[1]] || remap[corners[1]] == remap[corners[2]] || remap[corners[0]] == remap[corners[2]])
+                    {
+                        // Already removed by an earlier collapse of this pass
+                        continue;
+                    }
+
+                    bool removed = false;
+                    glm::dvec3 before[3];
+                    glm::dvec3 after[3];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        uint32_t position = remap[corners[k]];
+                        removed |= position == toPosition;
+                        before[k] = positions[corners[k]];
+                        after[k] = position == fromPosition ? target : before[k];
+                    }
+                    if (removed) continue;
+
+                    glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    if (glm::dot(normalBefore, normalAfter) <= 0) return true;
+                }
+                v = wedge[v];
+            } while (v != from);
+
+            return false;
+        }
+
+    public:
+        Simplifier(const std::vector<VulkanVertex>& vertices) : vertices(vertices), vertexCount(vertices.size()) {}
+
+        std::vector<uint32_t> run(std::vector<uint32_t> indices, size_t targetIndexCount, float targetError, float& resultError)
+        {
+            indices.resize(indices.size() / 3 * 3);
+            buildPositionRemap();
+
+            buildWedges(indices);
+            adjacency.build(indices, vertexCount);
+            classifyVertices();
+            computeQuadrics(indices);
+
+            double errorLimit = static_cast<double>(targetError) * targetError;
+            double maxError = 0;
+            size_t triangleCount = indices.size() / 3;
+            size_t targetTriangles = targetIndexCount / 3;
+
+            std::vector<uint32_t> collapseRemap(vertexCount);
+            std::vector<uint8_t> collapseLocked(vertexCount);
+
+            while (triangleCount > targetTriangles)
+            {
+                std::vector<Collapse> collapses = pickCollapses(indices);
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+                if (collapses.empty()) break;
+
+                // Each collapse removes about two triangles, cheaper ones first
+                size_t expected = std::min(collapses.size() - 1, (triangleCount - targetTriangles) / 2);
+                double passLimit = std::min(errorLimit, static_cast<double>(collapses[expected].error) * PASS_ERROR_BOUND);
+
+                std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+                std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+                size_t collapsed = 0;
+
+                for (const Collapse& collapse : collapses)
+                {
+                    if (triangleCount <= targetTriangles) break;
+                    if (collapse.error > passLimit && collapsed > 0) break;
+                    if (collapse.error > errorLimit) break;
+
+                    uint32_t fromPosition = remap[collapse.from];
+                    uint32_t toPosition = remap[collapse.to];
+                    if (collapseLocked[fromPosition] || collapseLocked[toPosition]) continue;
+                    if (flipsTriangles(collapse.from, collapse.to, indices, collapseRemap)) continue;
+
+                    // Triangles using both positions disappear
+                    uint32_t v = collapse.from;
+                    do
+                    {
+                        for (uint32_t e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; e++)
+                        {
+                            uint32_t t = adjacency.triangles[e];
+                            for (int k = 0; k < 3; k++)
+                            {
+                                if (remap[collapseRemap[indices[t * 3 + k]]] == toPosition)
+                                {
+                                    triangleCount--;
+                                    break;
+                                }
+                            }
+                        }
+                        v = wedge[v];
+                    } while (v != collapse.from);
+
+                    if (kinds[collapse.from] == VertexKind::Seam)
+                    {
+                        collapseRemap[collapse.from] = collapse.to;
+                        collapseRemap[wedge[collapse.from]] = wedge[collapse.to];
+                    }
+                    else
+                    {
+                        v = collapse.from;
+                        do
+                        {
+                            collapseRemap[v] = collapse.to;
+                            v = wedge[v];
+                        } while (v != collapse.from);
+                    }
+
+                    quadrics[toPosition].add(quadrics[fromPosition]);
+                    collapseLocked[fromPosition] = 1;
+                    collapseLocked[toPosition] = 1;
+                    maxError = std::max(maxError, static_cast<double>(collapse.error));
+                    collapsed++;
+                }
+
+                if (collapsed == 0) break;
+
+                // Apply the pass and drop triangles that became degenerate
+                size_t write = 0;
+                for (size_t t = 0; t < indices.size() / 3; t++)
+                {
+                    uint32_t a = collapseRemap[indices[t * 3 + 0]];
+                    uint32_t b = collapseRemap[indices[t * 3 + 1]];
+                    uint32_t c = collapseRemap[indices[t * 3 + 2]];
+                    if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c]) continue;
+
+                    indices[write++] = a;
+                    indices[write++] = b;
+                    indices[write++] = c;
+                }
+                indices.resize(write);
+                triangleCount = write / 3;
+
+                buildWedges(indices);
+                adjacency.build(indices, vertexCount);
+                classifyVertices();
+            }
+
+            resultError = static_cast<float>(std::sqrt(maxError));
+            return indices;
+        }
+    };
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<VulkanVertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, float* resultError)
+{
+    Simplifier simplifier(vertices);
+    float error = 0.0f;
+    std::vector<uint32_t> result = simplifier.run(indices, targetIndexCount, targetError, error);
+    if (resultError)
+    {
+        *resultError = error;
+    }
+    return result;
+}
+
+void MeshSimplifier::generateLods(MeshInfo& mesh, int lodCount, float reduction, float maxError)
+{
+    mesh.lods.clear();
+    mesh.lods.reserve(lodCount);
+
+    // Each LOD is simplified from the previous one, errors add up along the chain
+    const std::vector<uint32_t>* source = &mesh.indices;
+    float accumulatedError = 0.0f;
+    for (int lod = 0; lod < lodCount; lod++)
+    {
+        size_t targetIndexCount = static_cast<size_t>(source->size() / 3 * reduction) * 3;
+        if (targetIndexCount == 0) break;
+
+        float error = 0.0f;
+        MeshLod meshLod;
+        meshLod.indices = simplify(mesh.vertices, *source, targetIndexCount, maxError - accumulatedError, &error);
+
+        // Stop once the error bound prevents a meaningful reduction
+        if (meshLod.indices.empty() || meshLod.indices.size() > source->size() * (1.0f + reduction) / 2.0f)
+        {
+            break;
+        }
+
+        accumulatedError += error;
+        meshLod.error = accumulatedError;
+        if (ImportSettings::optimizeMeshes)
+        {
+            MeshOptimizer::optimizeVertexCache(meshLod.indices, mesh.vertices.size());
+        }
+
+        mesh.lods.push_back(std::move(meshLod));
+        source = &mesh.lods.back().indices;
+    }
+}
+
+void MeshSimplifier::generateLods(std::vector<MeshInfo>& meshes)
+{
+    ThreadPool::getShared().parallelFor(meshes.size(), [&](size_t i)
+    {
+        generateLods(meshes[i], ImportSettings::lodCount, ImportSettings::lodReduction, ImportSettings::lodMaxError);
+    });
+}
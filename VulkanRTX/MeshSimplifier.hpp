@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// Quadric error metric simplification (Garland and Heckbert) that only rewrites the index buffer, so every LOD shares
+/// the vertices of the base mesh. Vertices are classified as in meshoptimizer: open borders and attribute seams may only
+/// collapse along themselves and carry an extra edge quadric, so outlines and UV seams are preserved.
+/// Collapses are also penalized by the normal and UV difference of the merged vertices.
+/// </summary>
+class MeshSimplifier
+{
+public:
+    /// <summary>
+    /// Collapses edges until the index count reaches targetIndexCount or the next collapse would exceed targetError.
+    /// Errors are relative to the largest extent of the mesh. resultError receives the error of the result.
+    /// </summary>
+    static std::vector<uint32_t> simplify(const std::vector<VulkanVertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+    /// <summary>
+    /// Builds up to lodCount LODs, each one keeping reduction times the triangles of the previous one.
+    /// The chain stops early when the error bound prevents a meaningful reduction.
+    /// </summary>
+    static void generateLods(MeshInfo& mesh, int lodCount, float reduction, float maxError);
+
+    /// <summary>
+    /// Generates the LODs of every mesh from the ImportSettings, meshes are processed in parallel.
+    /// </summary>
+    static void generateLods(std::vector<MeshInfo>& meshes);
+};
@@ -0,0 +1,61 @@
+#include "ModelImporter.hpp"
+#include "GltfLoader.hpp"
+#include "ImportSettings.hpp"
+#include "MeshCache.hpp"
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
+
+ModelInfo ModelImporter::import(const std::string& path)
+{
+    uint64_t optionsSignature = getOptionsSignature();
+
+    ModelInfo model;
+    if (ImportSettings::useMeshCache && MeshCache::load(path, optionsSignature, model))
+    {
+        return model;
+    }
+
+    bool isGltf = GltfLoader::isGltfPath(path);
+    model = isGltf ? GltfLoader::loadGltf(path) : ObjLoader::loadObj(path);
+    computeBounds(model);
+
+    if (ImportSettings::useMeshCache)
+    {
+        std::vector<std::string> dependencies = isGltf ? GltfLoader::getDependencies(path) : ObjLoader::getDependencies(path);
+        MeshCache::store(path, dependencies, optionsSignature, model);
+    }
+    return model;
+}
+
+void ModelImporter::computeBounds(ModelInfo& model)
+{
+    ThreadPool::getShared().parallelFor(model.meshes.size(), [&](size_t i)
+    {
+        model.meshes[i].bounds = BoundingVolume::compute(model.meshes[i].vertices);
+    });
+
+    model.bounds = BoundingVolume();
+    for (const MeshInfo& mesh : model.meshes)
+    {
+        model.bounds.grow(mesh.bounds);
+    }
+}
+
+uint64_t ModelImporter::getOptionsSignature()
+{
+    float weldTolerances[] =
+    {
+        ImportSettings::weldPositionEpsilon,
+        ImportSettings::weldNormalEpsilon,
+        ImportSettings::weldTexCoordEpsilon
+    };
+    uint64_t signature = hashBytes(weldTolerances, sizeof(weldTolerances));
+    signature = hashBytes(&ImportSettings::cleanMeshes, sizeof(ImportSettings::cleanMeshes), signature);
+    signature = hashBytes(&ImportSettings::mergeByMaterial, sizeof(ImportSettings::mergeByMaterial), signature);
+    signature = hashBytes(&ImportSettings::optimizeMeshes, sizeof(ImportSettings::optimizeMeshes), signature);
+    signature = hashBytes(&ImportSettings::useFastObjParser, sizeof(ImportSettings::useFastObjParser), signature);
+    signature = hashBytes(&ImportSettings::lodCount, sizeof(ImportSettings::lodCount), signature);
+    signature = hashBytes(&ImportSettings::clusterTriangleBudget, sizeof(ImportSettings::clusterTriangleBudget), signature);
+    float lodParameters[] = { ImportSettings::lodReduction, ImportSettings::lodMaxError };
+    return hashBytes(lodParameters, sizeof(lodParameters), signature);
+}
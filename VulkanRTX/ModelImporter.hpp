@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// Entry point of the asset pipeline: returns the ModelInfo of a model file, going through the mesh cache when possible.
+/// </summary>
+class ModelImporter
+{
+public:
+    static ModelInfo import(const std::string& path);
+
+    /// <summary>
+    /// Computes the bounds of every mesh in parallel, then the model bounds.
+    /// </summary>
+    static void computeBounds(ModelInfo& model);
+
+    /// <summary>
+    /// Hash of the import settings that change the imported geometry, cache entries built with other settings are ignored.
+    /// </summary>
+    static uint64_t getOptionsSignature();
+};
@@ -1,12 +1,25 @@
 #include "ObjLoader.hpp"
-#include <unordered_map>
+#include <string_view>
+#include <cctype>
 #include "VulkanGeometry.hpp"
+#include "MappedFile.hpp"
+#include "VertexWelder.hpp"
+#include "TangentGenerator.hpp"
+#include "MeshCleaner.hpp"
+#include "MeshClusterizer.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "ImportSettings.hpp"
+#include "ThreadPool.hpp"
+#include <unordered_map>
 
 #ifndef TINYOBJLOADER_IMPLEMENTATION
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 #endif
 
+#include "FastObjParser.hpp"
+
 std::string normalizePath(const std::string& baseDir, const std::string& textureName)
 {
     if (textureName.empty()) return "";
@@ -21,48 +34,57 @@ std::string normalizePath(const std::string& baseDir, const std::string& texture
     return baseDir + cleanTextureName;
 }
 
-void computeTangents(MeshInfo& mesh)
+// Consecutive triangles of one shape that share a material
+struct FaceRun
 {
-    // Iterate over each triangle
-    for (int i = 0; i < mesh.indices.size(); i += 3)
-    {
-        uint32_t i1 = mesh.indices[i];
-        uint32_t i2 = mesh.indices[i+1];
-        uint32_t i3 = mesh.indices[i+2];
-
-        VulkanVertex& v1 = mesh.vertices[i1];
-        VulkanVertex& v2 = mesh.vertices[i2];
-        VulkanVertex& v3 = mesh.vertices[i3];
-
-        glm::vec3 edge1 = v2.pos - v1.pos;
-        glm::vec3 edge2 = v3.pos - v1.pos;
-        glm::vec2 deltaUV1 = v2.texCoord - v1.texCoord;
-        glm::vec2 deltaUV2 = v3.texCoord - v1.texCoord;
-
-        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-        glm::vec3 tangent;
-        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-
-        v1.tangent += tangent;
-        v2.tangent += tangent;
-        v3.tangent += tangent;
-        
-        glm::vec3 bitangent;
-        bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-        bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-        bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-
-        v1.bitangent += bitangent;
-        v2.bitangent += bitangent;
-        v3.bitangent += bitangent;
-    }
-    for (VulkanVertex& vertex : mesh.vertices)
+    size_t shape;
+    size_t firstFace;
+    size_t faceCount;
+};
+
+struct FaceGroup
+{
+    int materialIndex = -1;
+    size_t faceCount = 0;
+    std::vector<FaceRun> runs;
+};
+
+// Splits triangulated shapes by their per-face material. With mergeShapes every face sharing a material lands in one group,
+// otherwise shapes are only split where their material changes. Groups keep the order in which they first appear.
+std::vector<FaceGroup> groupFacesByMaterial(const std::vector<tinyobj::shape_t>& shapes, bool mergeShapes)
+{
+    std::vector<FaceGroup> groups;
+    std::unordered_map<int, size_t> groupOfMaterial;
+    for (size_t s = 0; s < shapes.size(); s++)
     {
-        vertex.tangent = glm::normalize(vertex.tangent);
-        vertex.bitangent = glm::normalize(vertex.bitangent);
+        const tinyobj::mesh_t& mesh = shapes[s].mesh;
+        if (!mergeShapes) groupOfMaterial.clear();
+
+        size_t faceCount = mesh.indices.size() / 3;
+        size_t face = 0;
+        while (face < faceCount)
+        {
+            int materialIndex = face < mesh.material_ids.size() ? mesh.material_ids[face] : -1;
+            size_t runEnd = face + 1;
+            while (runEnd < faceCount && (runEnd < mesh.material_ids.size() ? mesh.material_ids[runEnd] : -1) == materialIndex)
+            {
+                runEnd++;
+            }
+
+            auto [it, inserted] = groupOfMaterial.try_emplace(materialIndex, groups.size());
+            if (inserted)
+            {
+                FaceGroup group;
+                group.materialIndex = materialIndex;
+                groups.push_back(std::move(group));
+            }
+            FaceGroup& group = groups[it->second];
+            group.runs.push_back({ s, face, runEnd - face });
+            group.faceCount += runEnd - face;
+            face = runEnd;
+        }
     }
+    return groups;
 }
 
 ModelInfo ObjLoader::loadObj(const std::string& objPath)
@@ -74,13 +96,22 @@ ModelInfo ObjLoader::loadObj(const std::string& objPath)
 
     std::string baseDir = objPath.substr(0, objPath.find_last_of("/\\") + 1);
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objPath.c_str(), baseDir.c_str(), true))
+    if (ImportSettings::useFastObjParser)
+    {
+        FastObjParser::parse(objPath, attrib, shapes, materials);
+    }
+    else if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objPath.c_str(), baseDir.c_str(), true))
     {
         throw std::runtime_error("Failed to load OBJ: " + warn + err);
     }
 
     ModelInfo model;
 
+    WeldTolerance weldTolerance;
+    weldTolerance.position = ImportSettings::weldPositionEpsilon;
+    weldTolerance.normal = ImportSettings::weldNormalEpsilon;
+    weldTolerance.texCoord = ImportSettings::weldTexCoordEpsilon;
+
     // Load materials
     for (const auto& mat : materials)
     {
@@ -106,56 +137,127 @@ ModelInfo ObjLoader::loadObj(const std::string& objPath)
         model.materials.push_back(matInfo);
     }
 
-    // Load meshes
-    for (const auto& shape : shapes)
+    // Load meshes, one per material group
+    std::vector<FaceGroup> groups = groupFacesByMaterial(shapes, ImportSettings::mergeByMaterial);
+    model.meshes.resize(groups.size());
+    ThreadPool::getShared().parallelFor(groups.size(), [&](size_t g)
     {
-        MeshInfo mesh;
-        std::unordered_map<VulkanVertex, uint32_t> uniqueVertices;
+        const FaceGroup& group = groups[g];
+        MeshInfo& mesh = model.meshes[g];
+        mesh.indices.reserve(group.faceCount * 3);
+        VertexWelder welder(mesh.vertices, group.faceCount * 3, weldTolerance);
 
-        for (const auto& index : shape.mesh.indices)
+        for (const FaceRun& run : group.runs)
         {
-            VulkanVertex vertex{};
-            vertex.pos =
+            const std::vector<tinyobj::index_t>& shapeIndices = shapes[run.shape].mesh.indices;
+            for (size_t i = run.firstFace * 3; i < (run.firstFace + run.faceCount) * 3; i++)
             {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-
-            if (index.normal_index >= 0) 
-            {
-                vertex.normal = 
+                const tinyobj::index_t& index = shapeIndices[i];
+                VulkanVertex vertex{};
+                vertex.pos =
                 {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
+                    attrib.vertices[3 * index.vertex_index + 0],
+                    attrib.vertices[3 * index.vertex_index + 1],
+                    attrib.vertices[3 * index.vertex_index + 2]
                 };
-            }
 
-            if (index.texcoord_index >= 0) 
-            {
-                vertex.texCoord =
+                if (index.normal_index >= 0) 
                 {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+                    vertex.normal = 
+                    {
+                        attrib.normals[3 * index.normal_index + 0],
+                        attrib.normals[3 * index.normal_index + 1],
+                        attrib.normals[3 * index.normal_index + 2]
+                    };
+                }
+
+                if (index.texcoord_index >= 0) 
+                {
+                    vertex.texCoord =
+                    {
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                    };
+                }
+
+                mesh.indices.push_back(welder.weld(vertex));
             }
+        }
+    });
+
+    model.meshMaterialIndices.reserve(groups.size());
+    for (const FaceGroup& group : groups)
+    {
+        model.meshMaterialIndices.push_back(group.materialIndex);
+    }
+
+    if (ImportSettings::cleanMeshes)
+    {
+        MeshCleaner::clean(model, objPath);
+    }
+
+    if (ImportSettings::clusterTriangleBudget > 0)
+    {
+        MeshClusterizer::clusterize(model.meshes, objPath);
+    }
+
+    if (ImportSettings::optimizeMeshes)
+    {
+        MeshOptimizer::optimize(model.meshes, objPath);
+    }
+
+    if (ImportSettings::lodCount > 0)
+    {
+        MeshSimplifier::generateLods(model.meshes);
+    }
+
+    TangentGenerator::generate(model.meshes);
 
-            if (uniqueVertices.count(vertex) == 0)
+    return model;
+}
+
+std::vector<std::string> ObjLoader::getDependencies(const std::string& objPath)
+{
+    std::vector<std::string> dependencies = { objPath };
+    std::string baseDir = objPath.substr(0, objPath.find_last_of("/\\") + 1);
+
+    MappedFile file;
+    if (!file.open(objPath))
+    {
+        return dependencies;
+    }
+
+    // Look for "mtllib a.mtl [b.mtl ...]" lines
+    const char* data = file.data();
+    size_t size = file.size();
+    size_t lineStart = 0;
+    while (lineStart < size)
+    {
+        size_t lineEnd = lineStart;
+        while (lineEnd < size && data[lineEnd] != '\n') lineEnd++;
+
+        std::string_view line(data + lineStart, lineEnd - lineStart);
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+
+        if (line.substr(0, 7) == "mtllib " || line.substr(0, 7) == "mtllib\t")
+        {
+            line.remove_prefix(7);
+            size_t nameStart = 0;
+            while (nameStart < line.size())
             {
-                uniqueVertices[vertex] = static_cast<uint32_t>(mesh.vertices.size());
-                mesh.vertices.push_back(vertex);
+                while (nameStart < line.size() && std::isspace(static_cast<unsigned char>(line[nameStart]))) nameStart++;
+                size_t nameEnd = nameStart;
+                while (nameEnd < line.size() && !std::isspace(static_cast<unsigned char>(line[nameEnd]))) nameEnd++;
+                if (nameEnd > nameStart)
+                {
+                    dependencies.push_back(normalizePath(baseDir, std::string(line.substr(nameStart, nameEnd - nameStart))));
+                }
+                nameStart = nameEnd;
             }
-
-            mesh.indices.push_back(uniqueVertices[vertex]);
         }
-        computeTangents(mesh);
-        model.meshes.push_back(mesh);
 
-        // Assign material index
-        int materialIndex = shape.mesh.material_ids.empty() ? -1 : shape.mesh.material_ids[0];
-        model.meshMaterialIndices.push_back(materialIndex);
+        lineStart = lineEnd + 1;
     }
 
-    return model;
-}
\ No newline at end of file
+    return dependencies;
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include "VulkanGeometry.hpp";
+#include "BoundingVolume.hpp"
 
 struct PBRMaterialInfo 
 {
@@ -23,10 +24,26 @@ struct PBRMaterialInfo
     std::string displacementTexture;
 };
 
+struct MeshLod
+{
+    std::vector<uint32_t> indices;
+    float error = 0.0f; // Simplification error relative to the mesh extent
+};
+
+// Contiguous range of the base index buffer, built as its own BLAS geometry
+struct MeshCluster
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
 struct MeshInfo
 {
     std::vector<VulkanVertex> vertices;
     std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods; // Simplified index buffers over the same vertices, coarsest last
+    std::vector<MeshCluster> clusters; // Spatial clusters covering indices in order, empty when the mesh is a single geometry
+    BoundingVolume bounds; // Object space, set by ModelImporter
 };
 
 struct ModelInfo
@@ -34,10 +51,16 @@ struct ModelInfo
     std::vector<MeshInfo> meshes;
     std::vector<PBRMaterialInfo> materials;
     std::vector<int> meshMaterialIndices;
+    BoundingVolume bounds; // Union of the mesh bounds
 };
 
 class ObjLoader
 {
 public:
     static ModelInfo loadObj(const std::string& objPath);
+
+    /// <summary>
+    /// Returns the files a model is built from: the OBJ itself and every material library it references.
+    /// </summary>
+    static std::vector<std::string> getDependencies(const std::string& objPath);
 };
\ No newline at end of file
@@ -4,6 +4,9 @@ float RunTimeSettings::renderScale = 1;
 int RunTimeSettings::spp = 1;
 int RunTimeSettings::rt_recursion_depth = 6;
 bool RunTimeSettings::displayRayTracing = false;
+int RunTimeSettings::rasterLod = 0;
+glm::vec3 RunTimeSettings::sunDirection = glm::normalize(-glm::vec3(0.5, 1, 0.5));
+glm::vec3 RunTimeSettings::sunColor = glm::vec3(10.0, 10.0, 10.0) * 50.0f;
 
 int RunTimeSettings::debugIndex1 = 0;
 int RunTimeSettings::debugIndex2 = 0;
@@ -1,3 +1,6 @@
+#pragma once
+#include "GLM_defines.hpp"
+
 class RunTimeSettings
 {
 public:
@@ -5,6 +8,9 @@ public:
     static int spp;
     static int rt_recursion_depth;
     static bool displayRayTracing;
+    static int rasterLod; // LOD drawn by the geometry pass, clamped per mesh
+    static glm::vec3 sunDirection; // Direction the sun light travels, normalized
+    static glm::vec3 sunColor;
     static int debugIndex1;
     static int debugIndex2;
     static bool debugBool1;
@@ -1,154 +1,63 @@
 #include "Scene.hpp"
 #include <chrono>
+#include <iostream>
 #include "Time.hpp"
+#include "ImportSettings.hpp"
+#include "ModelImporter.hpp"
+#include "AssetLoader.hpp"
+#include "StaticSceneBaker.hpp"
+#include "TextureManager.hpp"
+#include "ThreadPool.hpp"
+#include "VulkanGraphicsPipelineManager.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
 
-const ModelLoadInfo Scene::modelLoadInfos[] =
-{
-	// FOR DEBUG:
-	// arrowGizmo must be the first model
-	// the first model is currently used as a gizmo for debug purposes
-	{
-		"arrowGizmo",
-		"models/gizmos/arrow/arrow.obj",
-		glm::vec3(0, 0, 0),
-		glm::vec3(0.25, 0.25, 0.25),
-		glm::vec3(0, 0, 0)
-	},
-	{
-		"atrium",
-		"models/Atrium/atrium.obj",
-		glm::vec3(0, 0, 0),
-		glm::vec3(1, 1, 1),
-		glm::vec3(0, 0, 0)
-	},
-	{
-		"brickwall",
-		"models/wall/quad.obj",
-		glm::vec3(3, 3, -2),
-		glm::vec3(5, 5, 5),
-		glm::vec3(0, 180, 0)
-	},
-	{
-		"brickwall2",
-		"models/wall/quad.obj",
-		glm::vec3(3, 3, -1.75),
-		glm::vec3(5, 5, 5),
-		glm::vec3(0, 0, 0)
-	},
-	{
-		"portal_gun",
-		"models/portal_gun_pbr/portal_gun.obj",
-		glm::vec3(0, 2.2, 0),
-		glm::vec3(5, 5, 5),
-		glm::vec3(0, 0, 0)
-	},
-	//{
-	//	"sphere",
-	//	"models/sphere/sphere.obj",
-	//	glm::vec3(0, 0, 0),
-	//	glm::vec3(0.2, 0.2, 0.2),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"sphere",
-	//	"models/sphere/sphere.obj",
-	//	glm::vec3(2, 0, 0),
-	//	glm::vec3(0.2, 0.2, 0.2),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"sphere",
-	//	"models/sphere/sphere.obj",
-	//	glm::vec3(0, 2, 0),
-	//	glm::vec3(0.2, 0.2, 0.2),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"sphere",
-	//	"models/sphere/sphere.obj",
-	//	glm::vec3(0, 0, 2),
-	//	glm::vec3(0.2, 0.2, 0.2),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"ancient-temple-stylized",
-	//	"models/ancient-temple-stylized/ancient-temple-stylized.obj",
-	//	glm::vec3(5, 0, 0),
-	//	glm::vec3(0.25f, 0.25f, 0.25f),
-	//	glm::vec3(-36, 90, 0)
-	//},
-	//{
-	//	"sponza",
-	//	"models/Sponza/sponza.obj",
-	//	glm::vec3(0, 0, 0),
-	//	glm::vec3(0.01, 0.01, 0.01),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"San miguel",
-	//	"models/San_Miguel/san-miguel-low-poly.obj",
-	//	glm::vec3(0, 0, 0),
-	//	glm::vec3(1, 1, 1),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"moai",
-	//	"models/Moai/moai.obj",
-	//	glm::vec3(0, 0.1, 0),
-	//	glm::vec3(0.2, 0.2, 0.2),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"portal_gun_glass",
-	//	"models/portal_gun/portal_gun_glass.obj",
-	//	glm::vec3(0, 0, 0),
-	//	glm::vec3(5, 5, 5),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"viling_room",
-	//	"models/viking_room/viking_room.obj",
-	//	glm::vec3(0, -2, 0),
-	//	glm::vec3(5, 5, 5),
-	//	glm::vec3(-90, -90, 0)
-	//},
-	//{
-	//	"triangle",
-	//	"models/triangle/triangle.obj",
-	//	"models/triangle/triangle.png",
-	//	glm::vec3(1, 1, 1),
-	//	glm::vec3(2, 2, 2),
-	//	glm::vec3(3, 3, 3)
-	//},
-	// TODO: prevent double cleanup of error texture
-	//{
-	//	"sphere",
-	//	"models/sphere/sphere.obj",
-	//	glm::vec3(0, 0, 2.5),
-	//	glm::vec3(1, 1, 1),
-	//	glm::vec3(0, 0, 0)
-	//},
-	//{
-	//	"triangle",
-	//	"models/triangle/triangle.obj",
-	//	"models/portal_gun/portal_gun_glass.png",
-	//	glm::vec3(0, 0, 15),
-	//	glm::vec3(5, 5, 5),
-	//	glm::vec3(6, 6, 6)
-	//}
-};
+SceneDescription Scene::description = {};
+ModelUniformBuffers Scene::modelUniforms = {};
 std::vector<VulkanModel> Scene::models = {};
-std::vector<ModelInfo> Scene::modelInfos = {};
+std::vector<std::shared_ptr<VulkanModelAsset>> Scene::assets = {};
+std::vector<ModelInfo> Scene::assetInfos = {};
+std::vector<ModelLoadInfo> Scene::instances = {};
+std::vector<uint32_t> Scene::instanceAssetIndices = {};
+std::vector<StaticInstance> Scene::staticInstances = {};
+AssetLoadQueue Scene::loadQueue;
+std::vector<uint32_t> Scene::receivedAssets = {};
+std::vector<bool> Scene::bakedAssets = {};
+size_t Scene::missingBakedAssets = 0;
+std::vector<VkDescriptorPool> Scene::assetDescriptorPools = {};
+std::chrono::high_resolution_clock::time_point Scene::loadStartTime = {};
+bool Scene::loading = false;
+std::unordered_map<uint32_t, DecodedTextures> Scene::decodedTextures = {};
+
+void Scene::loadDescription(const std::string& path)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	description = SceneFile::load(path);
+	auto endTime = std::chrono::high_resolution_clock::now();
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
+	std::cout << "Loaded scene " << path << " (" << description.models.size() << " models) in " << elapsed << " ms" << std::endl;
+}
+
+const CameraDescription& Scene::getCamera()
+{
+	return description.camera;
+}
 
 uint32_t Scene::getModelCount()
 {
-	return sizeof(Scene::modelLoadInfos) / sizeof(ModelLoadInfo);
+	return static_cast<uint32_t>(instances.size());
+}
+
+uint32_t Scene::getAssetCount()
+{
+	return static_cast<uint32_t>(assetInfos.size());
 }
 
 uint32_t Scene::getMaterialCount()
 {
 	uint32_t count = 0;
-	for (const ModelInfo& model : modelInfos)
+	for (const ModelInfo& model : assetInfos)
 	{
 		count += model.materials.size();
 	}
@@ -158,7 +67,7 @@ uint32_t Scene::getMaterialCount()
 uint32_t Scene::getMeshCount()
 {
 	uint32_t count = 0;
-	for (const ModelInfo& model : modelInfos)
+	for (const ModelInfo& model : assetInfos)
 	{
 		count += model.meshes.size();
 	}
@@ -171,33 +80,386 @@ const std::vector<VulkanModel>& Scene::getModels()
 	return models;
 }
 
+std::vector<std::string> Scene::groupAssets()
+{
+	// Entries sharing a source path share one asset, so each file is imported once
+	std::vector<std::string> assetPaths;
+	std::unordered_map<std::string, uint32_t> assetIndices;
+	instances = description.models;
+	instanceAssetIndices.clear();
+	instanceAssetIndices.reserve(instances.size());
+	staticInstances.clear();
+	for (const ModelLoadInfo& loadInfo : instances)
+	{
+		std::string key = std::filesystem::path(loadInfo.objPath).lexically_normal().generic_string();
+		auto [it, inserted] = assetIndices.try_emplace(key, static_cast<uint32_t>(assetPaths.size()));
+		if (inserted)
+		{
+			assetPaths.push_back(loadInfo.objPath);
+		}
+		instanceAssetIndices.push_back(it->second);
+	}
+	return assetPaths;
+}
+
 void Scene::fetchModels()
 {
-	for (const ModelLoadInfo& loadInfo : modelLoadInfos)
+	auto startTime = std::chrono::high_resolution_clock::now();
+	uint32_t modelCount = static_cast<uint32_t>(description.models.size());
+	std::vector<std::string> assetPaths = groupAssets();
+
+	// Each asset is written to its own slot, so the order matches assetPaths
+	uint32_t assetCount = static_cast<uint32_t>(assetPaths.size());
+	assetInfos.clear();
+	assetInfos.resize(assetCount);
+
+	if (ImportSettings::parallelIngest)
 	{
-		ModelInfo info = ObjLoader::loadObj(loadInfo.objPath);
-		modelInfos.push_back(info);
+		ThreadPool::getShared().parallelFor(assetCount, [&](size_t i)
+		{
+			assetInfos[i] = ModelImporter::import(assetPaths[i]);
+		});
+	}
+	else
+	{
+		for (uint32_t i = 0; i < assetCount; i++)
+		{
+			assetInfos[i] = ModelImporter::import(assetPaths[i]);
+		}
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
+	std::cout << "Fetched " << modelCount << " models (" << assetCount << " unique assets) in " << elapsed << " ms" << std::endl;
+
+	if (ImportSettings::mergeStaticModels)
+	{
+		bakeStaticModels();
 	}
 }
 
+void Scene::splitStaticModels()
+{
+	// Static models leave the instance list, dynamic ones keep their order
+	std::vector<ModelLoadInfo> dynamicInstances;
+	std::vector<uint32_t> dynamicAssetIndices;
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		const ModelLoadInfo& loadInfo = instances[i];
+		if (!loadInfo.isStatic)
+		{
+			dynamicInstances.push_back(loadInfo);
+			dynamicAssetIndices.push_back(instanceAssetIndices[i]);
+			continue;
+		}
+
+		Transform transform;
+		transform.setPosition(loadInfo.position);
+		transform.setScale(loadInfo.scale);
+		transform.setRotation(loadInfo.rotation);
+		staticInstances.push_back({ instanceAssetIndices[i], transform.getTransformMatrix() });
+	}
+
+	instances.swap(dynamicInstances);
+	instanceAssetIndices.swap(dynamicAssetIndices);
+}
+
+size_t Scene::placeStaticChunks(std::vector<ModelInfo>& chunks)
+{
+	// Every chunk is placed once with an identity transform
+	size_t triangleCount = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		for (const MeshInfo& mesh : chunks[i].meshes)
+		{
+			triangleCount += mesh.indices.size() / 3;
+		}
+
+		ModelLoadInfo chunkInfo;
+		chunkInfo.name = "static_chunk_" + std::to_string(i);
+		chunkInfo.objPath = chunkInfo.name;
+		chunkInfo.position = glm::vec3(0);
+		chunkInfo.scale = glm::vec3(1);
+		chunkInfo.rotation = glm::vec3(0);
+		chunkInfo.isStatic = true;
+		instances.push_back(chunkInfo);
+		instanceAssetIndices.push_back(static_cast<uint32_t>(assetInfos.size()));
+		assetInfos.push_back(std::move(chunks[i]));
+	}
+	return triangleCount;
+}
+
+void Scene::bakeStaticModels()
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	splitStaticModels();
+	if (staticInstances.empty())
+	{
+		return;
+	}
+
+	size_t chunkTriangles = static_cast<size_t>(std::max(ImportSettings::staticChunkTriangles, 1));
+	std::vector<ModelInfo> chunks = StaticSceneBaker::bake(assetInfos, staticInstances, chunkTriangles);
+	size_t triangleCount = placeStaticChunks(chunks);
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(endTime - startTime).count();
+	std::cout << "Baked " << staticInstances.size() << " static models into " << chunks.size() << " world space chunks (" << triangleCount << " triangles), "
+		<< instances.size() - chunks.size() << " dynamic models stay instanced, in " << elapsed << " ms" << std::endl;
+}
+
 void Scene::loadModels(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool)
 {
-	for (int i = 0; i < modelInfos.size(); i++)
+	assets.resize(assetInfos.size());
+	modelUniforms.create(context, instanceAssetIndices.size());
+	for (int i = 0; i < instanceAssetIndices.size(); i++)
+	{
+		const ModelLoadInfo& loadInfo = instances[i];
+
+		// Upload the asset the first time it is placed, later placements only add an instance
+		std::shared_ptr<VulkanModelAsset>& asset = assets[instanceAssetIndices[i]];
+		if (!asset)
+		{
+			asset = std::make_shared<VulkanModelAsset>();
+			asset->sourcePath = loadInfo.objPath;
+			asset->load(assetInfos[instanceAssetIndices[i]], context, commandBufferManager, descriptorPool);
+		}
+
+		VulkanModel model;
+		model.name = loadInfo.name;
+		model.transform.setPosition(loadInfo.position);
+		model.transform.setScale(loadInfo.scale);
+		model.transform.setRotation(loadInfo.rotation);
+
+		model.load(asset, context, descriptorPool, modelUniforms, i);
+		models.push_back(model);
+	}
+	TextureManager::printStatistics();
+}
+
+void Scene::beginLoading(const VulkanContext& context)
+{
+	loadStartTime = std::chrono::high_resolution_clock::now();
+	std::vector<std::string> assetPaths = groupAssets();
+	uint32_t assetCount = static_cast<uint32_t>(assetPaths.size());
+
+	// Assets are moved in by the main thread only, jobs never resize this vector while the bake reads it
+	assetInfos.clear();
+	assetInfos.resize(assetCount);
+
+	// Static chunks never outnumber the static models they replace, so one slot per scene entry is enough
+	modelUniforms.create(context, description.models.size());
+
+	if (ImportSettings::mergeStaticModels)
+	{
+		splitStaticModels();
+	}
+	bakedAssets.assign(assetCount, false);
+	for (const StaticInstance& instance : staticInstances)
+	{
+		bakedAssets[instance.assetIndex] = true;
+	}
+	missingBakedAssets = static_cast<size_t>(std::count(bakedAssets.begin(), bakedAssets.end(), true));
+
+	// Jobs start in scene order, the gizmo and the first models arrive first
+	for (uint32_t i = 0; i < assetCount; i++)
+	{
+		std::string path = assetPaths[i];
+		loadQueue.run([i, path]()
+		{
+			std::vector<LoadedAsset> loaded(1);
+			loaded[0].assetIndex = i;
+			loaded[0].info = ModelImporter::import(path);
+			loaded[0].textures = AssetLoader::decodeMaterialTextures(loaded[0].info);
+			return loaded;
+		});
+	}
+
+	loading = true;
+	std::cout << "Loading " << description.models.size() << " models (" << assetCount << " unique assets) in the background" << std::endl;
+}
+
+bool Scene::isLoading()
+{
+	return loading;
+}
+
+void Scene::uploadAsset(uint32_t assetIndex, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+{
+	std::vector<uint32_t> placements;
+	for (uint32_t i = 0; i < instances.size(); i++)
 	{
-		ModelInfo info = modelInfos[i];
-		ModelLoadInfo loadInfo = modelLoadInfos[i];
+		if (instanceAssetIndices[i] == assetIndex)
+		{
+			placements.push_back(i);
+		}
+	}
 
+	// Assets only placed by static models live on in the baked chunks
+	if (placements.empty())
+	{
+		decodedTextures.erase(assetIndex);
+		return;
+	}
+
+	// A pool per asset, the mesh and model counts are only known once it is imported
+	VkDescriptorPool descriptorPool = VulkanGraphicsPipelineManager::createPool(context, placements.size(), assetInfos[assetIndex].meshes.size(), 0);
+	assetDescriptorPools.push_back(descriptorPool);
+
+	std::shared_ptr<VulkanModelAsset>& asset = assets[assetIndex];
+	asset = std::make_shared<VulkanModelAsset>();
+	asset->sourcePath = instances[placements[0]].objPath;
+	asset->load(assetInfos[assetIndex], context, commandBufferManager, descriptorPool, &decodedTextures[assetIndex]);
+	decodedTextures.erase(assetIndex);
+
+	for (uint32_t i : placements)
+	{
+		const ModelLoadInfo& loadInfo = instances[i];
 		VulkanModel model;
 		model.name = loadInfo.name;
 		model.transform.setPosition(loadInfo.position);
 		model.transform.setScale(loadInfo.scale);
 		model.transform.setRotation(loadInfo.rotation);
 
-		model.load(info, context, commandBufferManager, descriptorPool);
+		model.load(asset, context, descriptorPool, modelUniforms, models.size());
 		models.push_back(model);
 	}
 }
 
+bool Scene::uploadLoadedModels(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+{
+	// Checked before taking the results, a job finishing in between is picked up next frame
+	bool jobsDone = loadQueue.isIdle();
+
+	std::vector<ModelInfo> chunks;
+	std::vector<DecodedTextures> chunkTextures;
+	for (LoadedAsset& loaded : loadQueue.take())
+	{
+		if (loaded.assetIndex >= bakedAssets.size())
+		{
+			chunks.push_back(std::move(loaded.info));
+			chunkTextures.push_back(std::move(loaded.textures));
+			continue;
+		}
+
+		assetInfos[loaded.assetIndex] = std::move(loaded.info);
+		decodedTextures[loaded.assetIndex] = std::move(loaded.textures);
+		receivedAssets.push_back(loaded.assetIndex);
+		if (bakedAssets[loaded.assetIndex] && --missingBakedAssets == 0)
+		{
+			// Reads the static assets while the main thread keeps uploading, chunks come back with indices past the imports
+			uint32_t firstChunk = static_cast<uint32_t>(assetInfos.size());
+			loadQueue.run([firstChunk]()
+			{
+				size_t chunkTriangles = static_cast<size_t>(std::max(ImportSettings::staticChunkTriangles, 1));
+				std::vector<ModelInfo> baked = StaticSceneBaker::bake(assetInfos, staticInstances, chunkTriangles);
+				std::vector<LoadedAsset> loaded(baked.size());
+				for (size_t i = 0; i < baked.size(); i++)
+				{
+					loaded[i].assetIndex = firstChunk + static_cast<uint32_t>(i);
+					loaded[i].info = std::move(baked[i]);
+					loaded[i].textures = AssetLoader::decodeMaterialTextures(loaded[i].info);
+				}
+				return loaded;
+			});
+		}
+	}
+
+	// The bake is over once its chunks arrive, nothing reads assetInfos in the background anymore
+	if (!chunks.empty())
+	{
+		uint32_t firstChunk = static_cast<uint32_t>(assetInfos.size());
+		size_t triangleCount = placeStaticChunks(chunks);
+		for (uint32_t i = 0; i < chunks.size(); i++)
+		{
+			receivedAssets.push_back(firstChunk + i);
+			decodedTextures[firstChunk + i] = std::move(chunkTextures[i]);
+		}
+		std::cout << "Baked " << staticInstances.size() << " static models into " << chunks.size() << " world space chunks (" << triangleCount << " triangles)" << std::endl;
+	}
+	assets.resize(assetInfos.size());
+
+	// The geometry pass draws the first model apart as a gizmo, it has to be placed before anything else
+	if (models.empty() && !instances.empty())
+	{
+		auto first = std::find(receivedAssets.begin(), receivedAssets.end(), instanceAssetIndices[0]);
+		if (first == receivedAssets.end())
+		{
+			return false;
+		}
+		std::rotate(receivedAssets.begin(), first, first + 1);
+	}
+
+	// Uploads wait on the queue, keep them within a frame budget but always make progress
+	constexpr float UPLOAD_BUDGET_MS = 8.0f;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	size_t modelCount = models.size();
+	size_t uploadCount = 0;
+	while (uploadCount < receivedAssets.size())
+	{
+		uploadAsset(receivedAssets[uploadCount++], context, commandBufferManager);
+		float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+		if (elapsed > UPLOAD_BUDGET_MS)
+		{
+			break;
+		}
+	}
+	receivedAssets.erase(receivedAssets.begin(), receivedAssets.begin() + uploadCount);
+
+	if (jobsDone && receivedAssets.empty() && loadQueue.isIdle())
+	{
+		loading = false;
+		float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - loadStartTime).count();
+		std::cout << "Loaded " << models.size() << " models (" << assetInfos.size() << " assets) in the background in " << elapsed << " ms" << std::endl;
+		TextureManager::printStatistics();
+	}
+
+	return models.size() > modelCount;
+}
+
+bool Scene::hasStreamedTextures()
+{
+	for (const std::shared_ptr<VulkanModelAsset>& asset : assets)
+	{
+		if (!asset) continue;
+		for (const ShadedMesh& shadedMesh : asset->shadedMeshes)
+		{
+			if (shadedMesh.material.hasStreamedTextures())
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void Scene::applyStreamedTextures(const VulkanContext& context)
+{
+	bool streaming = false;
+	for (const std::shared_ptr<VulkanModelAsset>& asset : assets)
+	{
+		if (!asset) continue;
+		for (ShadedMesh& shadedMesh : asset->shadedMeshes)
+		{
+			if (shadedMesh.material.hasStreamedTextures())
+			{
+				shadedMesh.material.applyStreamedTextures(context);
+			}
+			streaming |= shadedMesh.material.albedoStream.isValid() || shadedMesh.material.bumpStream.isValid();
+		}
+	}
+
+	// The materials hold the textures now, the cache releases them with their last material
+	TextureManager::releaseFinishedStreams();
+
+	if (!streaming)
+	{
+		std::cout << "Material textures resident" << std::endl;
+		TextureManager::printStatistics();
+	}
+}
+
 void Scene::update()
 {
 	// Pass
@@ -205,9 +467,28 @@ void Scene::update()
 
 void Scene::cleanup(VkDevice device)
 {
+	// Background jobs reference the scene, let them finish before releasing it
+	loadQueue.wait();
+	loading = false;
+	decodedTextures.clear();
+
 	for (VulkanModel& model : models)
 	{
 		model.cleanup(device);
 	}
 	models.clear();
+	modelUniforms.cleanup(device);
+
+	// Assets only placed by baked static models were never uploaded
+	for (const std::shared_ptr<VulkanModelAsset>& asset : assets)
+	{
+		if (asset) asset->cleanup(device);
+	}
+	assets.clear();
+
+	for (VkDescriptorPool descriptorPool : assetDescriptorPools)
+	{
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+	}
+	assetDescriptorPools.clear();
 }
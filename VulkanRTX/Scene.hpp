@@ -1,33 +1,76 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <chrono>
+#include <unordered_map>
 #include "VulkanModel.hpp"
 #include "VulkanContext.hpp"
 #include "VulkanCommandBufferManager.hpp"
 #include "Vulkan_GLFW.hpp"
-
-struct ModelLoadInfo
-{
-	std::string name;
-	std::string objPath;
-	glm::vec3 position;
-	glm::vec3 scale;
-	glm::vec3 rotation;
-};
+#include "SceneFile.hpp"
+#include "StaticSceneBaker.hpp"
+#include "AssetLoadQueue.hpp"
 
 class Scene
 {
 private:
 	static std::vector<VulkanModel> models; // The loaded models
-	static std::vector<ModelInfo> modelInfos; // Information on models, fetched at runtime
-	static const ModelLoadInfo modelLoadInfos[]; // Configuration to load model files
+	static std::vector<std::shared_ptr<VulkanModelAsset>> assets; // GPU data, one per unique source file
+	static std::vector<ModelInfo> assetInfos; // Information on assets, fetched at runtime, baked static chunks come last
+	static std::vector<ModelLoadInfo> instances; // Models loaded as TLAS instances: dynamic models, then one per static chunk
+	static std::vector<uint32_t> instanceAssetIndices; // Asset placed by each instance
+	static SceneDescription description; // Models and camera read from the scene file
+	static ModelUniformBuffers modelUniforms; // Uniforms of every model, one slot each
+	static std::vector<StaticInstance> staticInstances; // Static models taken out of the instances, baked into chunks
+
+	// Progressive loading
+	static AssetLoadQueue loadQueue; // Imports and the static bake running in the background
+	static std::vector<uint32_t> receivedAssets; // Imported but not uploaded yet, in arrival order
+	static std::unordered_map<uint32_t, DecodedTextures> decodedTextures; // Material textures of the received assets
+	static std::vector<bool> bakedAssets; // Imported assets read by the static bake
+	static size_t missingBakedAssets; // Imports the static bake still waits for
+	static std::vector<VkDescriptorPool> assetDescriptorPools; // One per uploaded asset, sized for it and its models
+	static std::chrono::high_resolution_clock::time_point loadStartTime;
+	static bool loading;
+
+	static std::vector<std::string> groupAssets();
+	static void splitStaticModels();
+	static size_t placeStaticChunks(std::vector<ModelInfo>& chunks);
+	static void uploadAsset(uint32_t assetIndex, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
 
 public:	
+	static void loadDescription(const std::string& path);
+	static const CameraDescription& getCamera();
 	static uint32_t getModelCount();
+	static uint32_t getAssetCount();
 	static uint32_t getMaterialCount();
 	static uint32_t getMeshCount();
 	static const std::vector<VulkanModel>& getModels();
 	static void fetchModels();
+	static void bakeStaticModels();
 	static void loadModels(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool);
+
+	/// <summary>
+	/// Starts importing every asset in the background, models are added by uploadLoadedModels as their asset arrives.
+	/// Static models are baked once all the assets they place are imported.
+	/// </summary>
+	static void beginLoading(const VulkanContext& context);
+	static bool isLoading();
+
+	/// <summary>
+	/// Uploads the assets imported since the last call within a frame time budget and adds their models.
+	/// Returns true when models were added, the TLAS and ray tracing descriptors must then be rebuilt.
+	/// </summary>
+	static bool uploadLoadedModels(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
+
+	// Main thread. Whether streamed material textures finished loading since the last applyStreamedTextures
+	static bool hasStreamedTextures();
+
+	/// <summary>
+	/// Binds the finished material textures in place of their placeholders. The material descriptor sets are rewritten and
+	/// must not be in use, the ray tracing material textures must be updated afterwards.
+	/// </summary>
+	static void applyStreamedTextures(const VulkanContext& context);
 	static void update();
 	static void cleanup(VkDevice device);
 };
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "SceneFile.hpp"
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include "MappedFile.hpp"
+#include "RunTimeSettings.hpp"
+#include "ImportSettings.hpp"
+
+namespace
+{
+	bool isBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// Splits a line into whitespace separated tokens, stops at a comment
+	void tokenize(std::string_view line, std::vector<std::string_view>& tokens)
+	{
+		tokens.clear();
+		size_t i = 0;
+		while (i < line.size())
+		{
+			while (i < line.size() && isBlank(line[i])) i++;
+			if (i == line.size() || line[i] == '#') break;
+
+			size_t start = i;
+			while (i < line.size() && !isBlank(line[i]) && line[i] != '#') i++;
+			tokens.push_back(line.substr(start, i - start));
+		}
+	}
+
+	class StatementParser
+	{
+	private:
+		const std::string& path;
+		size_t lineNumber;
+		const std::vector<std::string_view>& tokens;
+
+	public:
+		StatementParser(const std::string& path, size_t lineNumber, const std::vector<std::string_view>& tokens)
+			: path(path), lineNumber(lineNumber), tokens(tokens)
+		{
+		}
+
+		[[noreturn]] void fail(const std::string& message) const
+		{
+			throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + message);
+		}
+
+		// Arguments exclude the keyword
+		size_t argumentCount() const
+		{
+			return tokens.size() - 1;
+		}
+
+		std::string_view argument(size_t i) const
+		{
+			return tokens[i + 1];
+		}
+
+		float getFloat(size_t i) const
+		{
+			std::string_view text = argument(i);
+			if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+
+			float value;
+			std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+			if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+			{
+				fail("expected a number, got '" + std::string(argument(i)) + "'");
+			}
+			return value;
+		}
+
+		int getInt(size_t i) const
+		{
+			std::string_view text = argument(i);
+			int value;
+			std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+			if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+			{
+				fail("expected an integer, got '" + std::string(text) + "'");
+			}
+			return value;
+		}
+
+		bool getBool(size_t i) const
+		{
+			std::string_view text = argument(i);
+			if (text == "1" || text == "true" || text == "on") return true;
+			if (text == "0" || text == "false" || text == "off") return false;
+			fail("expected a boolean, got '" + std::string(text) + "'");
+		}
+
+		glm::vec3 getVec3(size_t i) const
+		{
+			return glm::vec3(getFloat(i), getFloat(i + 1), getFloat(i + 2));
+		}
+
+		void expectArguments(std::initializer_list<size_t> allowedCounts) const
+		{
+			for (size_t count : allowedCounts)
+			{
+				if (argumentCount() == count) return;
+			}
+			fail("unexpected number of arguments for '" + std::string(tokens[0]) + "'");
+		}
+	};
+
+	using SettingSetter = std::function<void(const StatementParser&)>;
+
+	const std::unordered_map<std::string_view, SettingSetter>& getSettingSetters()
+	{
+		static const std::unordered_map<std::string_view, SettingSetter> setters =
+		{
+			// Rendering
+			{ "renderScale", [](const StatementParser& p) { RunTimeSettings::renderScale = p.getFloat(1); } },
+			{ "spp", [](const StatementParser& p) { RunTimeSettings::spp = p.getInt(1); } },
+			{ "rtRecursionDepth", [](const StatementParser& p) { RunTimeSettings::rt_recursion_depth = p.getInt(1); } },
+			{ "displayRayTracing", [](const StatementParser& p) { RunTimeSettings::displayRayTracing = p.getBool(1); } },
+			{ "rasterLod", [](const StatementParser& p) { RunTimeSettings::rasterLod = p.getInt(1); } },
+
+			// Import
+			{ "parallelIngest", [](const StatementParser& p) { ImportSettings::parallelIngest = p.getBool(1); } },
+			{ "progressiveLoading", [](const StatementParser& p) { ImportSettings::progressiveLoading = p.getBool(1); } },
+			{ "useMeshCache", [](const StatementParser& p) { ImportSettings::useMeshCache = p.getBool(1); } },
+			{ "compressTextures", [](const StatementParser& p) { ImportSettings::compressTextures = p.getBool(1); } },
+			{ "streamTextures", [](const StatementParser& p) { ImportSettings::streamTextures = p.getBool(1); } },
+			{ "useFastObjParser", [](const StatementParser& p) { ImportSettings::useFastObjParser = p.getBool(1); } },
+			{ "workerCount", [](const StatementParser& p) { ImportSettings::workerCount = p.getInt(1); } },
+			{ "weldPositionEpsilon", [](const StatementParser& p) { ImportSettings::weldPositionEpsilon = p.getFloat(1); } },
+			{ "weldNormalEpsilon", [](const StatementParser& p) { ImportSettings::weldNormalEpsilon = p.getFloat(1); } },
+			{ "weldTexCoordEpsilon", [](const StatementParser& p) { ImportSettings::weldTexCoordEpsilon = p.getFloat(1); } },
+			{ "cleanMeshes", [](const StatementParser& p) { ImportSettings::cleanMeshes = p.getBool(1); } },
+			{ "mergeByMaterial", [](const StatementParser& p) { ImportSettings::mergeByMaterial = p.getBool(1); } },
+			{ "optimizeMeshes", [](const StatementParser& p) { ImportSettings::optimizeMeshes = p.getBool(1); } },
+			{ "lodCount", [](const StatementParser& p) { ImportSettings::lodCount = p.getInt(1); } },
+			{ "lodReduction", [](const StatementParser& p) { ImportSettings::lodReduction = p.getFloat(1); } },
+			{ "lodMaxError", [](const StatementParser& p) { ImportSettings::lodMaxError = p.getFloat(1); } },
+			{ "clusterTriangleBudget", [](const StatementParser& p) { ImportSettings::clusterTriangleBudget = p.getInt(1); } },
+			{ "mergeStaticModels", [](const StatementParser& p) { ImportSettings::mergeStaticModels = p.getBool(1); } },
+			{ "staticChunkTriangles", [](const StatementParser& p) { ImportSettings::staticChunkTriangles = p.getInt(1); } },
+			{ "vertexFormat", [](const StatementParser& p)
+				{
+					std::string_view format = p.argument(1);
+					if (format == "full") ImportSettings::vertexFormat = VertexFormat::Full;
+					else if (format == "compact") ImportSettings::vertexFormat = VertexFormat::Compact;
+					else if (format == "quantized") ImportSettings::vertexFormat = VertexFormat::CompactQuantized;
+					else p.fail("unknown vertex format '" + std::string(format) + "', expected full, compact or quantized");
+				}
+			},
+		};
+		return setters;
+	}
+}
+
+SceneDescription SceneFile::load(const std::string& path)
+{
+	MappedFile file;
+	if (!file.open(path))
+	{
+		throw std::runtime_error("Cannot open scene file " + path);
+	}
+
+	SceneDescription scene;
+	std::unordered_map<std::string, std::string> assetPaths;
+	auto resolveAsset = [&](std::string_view asset)
+	{
+		auto it = assetPaths.find(std::string(asset));
+		return it != assetPaths.end() ? it->second : std::string(asset);
+	};
+
+	std::vector<std::string_view> tokens;
+	const char* cursor = file.data();
+	const char* end = file.data() + file.size();
+	for (size_t lineNumber = 1; cursor < end; lineNumber++)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+		if (lineEnd == nullptr) lineEnd = end;
+		tokenize(std::string_view(cursor, lineEnd - cursor), tokens);
+		cursor = lineEnd < end ? lineEnd + 1 : end;
+
+		if (tokens.empty()) continue;
+		std::string_view keyword = tokens[0];
+
+		// Placements may end with the static flag
+		bool isStatic = (keyword == "model" || keyword == "grid") && tokens.size() > 1 && tokens.back() == "static";
+		if (isStatic) tokens.pop_back();
+		StatementParser parser(path, lineNumber, tokens);
+
+		if (keyword == "asset")
+		{
+			parser.expectArguments({ 2 });
+			assetPaths[std::string(parser.argument(0))] = std::string(parser.argument(1));
+		}
+		else if (keyword == "model")
+		{
+			parser.expectArguments({ 2, 5, 8, 11 });
+			ModelLoadInfo model;
+			model.name = parser.argument(0);
+			model.objPath = resolveAsset(parser.argument(1));
+			model.position = parser.argumentCount() >= 5 ? parser.getVec3(2) : glm::vec3(0);
+			model.scale = parser.argumentCount() >= 8 ? parser.getVec3(5) : glm::vec3(1);
+			model.rotation = parser.argumentCount() >= 11 ? parser.getVec3(8) : glm::vec3(0);
+			model.isStatic = isStatic;
+			scene.models.push_back(model);
+		}
+		else if (keyword == "grid")
+		{
+			parser.expectArguments({ 8, 11, 14 });
+			std::string name(parser.argument(0));
+			std::string objPath = resolveAsset(parser.argument(1));
+			int countX = parser.getInt(2);
+			int countY = parser.getInt(3);
+			int countZ = parser.getInt(4);
+			if (countX <= 0 || countY <= 0 || countZ <= 0) parser.fail("grid counts must be positive");
+			glm::vec3 spacing = parser.getVec3(5);
+			glm::vec3 origin = parser.argumentCount() >= 11 ? parser.getVec3(8) : glm::vec3(0);
+			glm::vec3 scale = parser.argumentCount() >= 14 ? parser.getVec3(11) : glm::vec3(1);
+
+			scene.models.reserve(scene.models.size() + static_cast<size_t>(countX) * countY * countZ);
+			for (int z = 0; z < countZ; z++)
+			{
+				for (int y = 0; y < countY; y++)
+				{
+					for (int x = 0; x < countX; x++)
+					{
+						ModelLoadInfo model;
+						model.name = name + "_" + std::to_string(scene.models.size());
+						model.objPath = objPath;
+						model.position = origin + spacing * glm::vec3(x, y, z);
+						model.scale = scale;
+						model.rotation = glm::vec3(0);
+						model.isStatic = isStatic;
+						scene.models.push_back(model);
+					}
+				}
+			}
+		}
+		else if (keyword == "camera")
+		{
+			parser.expectArguments({ 6, 7, 9 });
+			scene.camera.position = parser.getVec3(0);
+			scene.camera.target = parser.getVec3(3);
+			if (parser.argumentCount() >= 7) scene.camera.fov = parser.getFloat(6);
+			if (parser.argumentCount() >= 9)
+			{
+				scene.camera.nearPlane = parser.getFloat(7);
+				scene.camera.farPlane = parser.getFloat(8);
+			}
+		}
+		else if (keyword == "sun")
+		{
+			parser.expectArguments({ 3, 6 });
+			glm::vec3 direction = parser.getVec3(0);
+			if (glm::length(direction) == 0.0f) parser.fail("sun direction cannot be zero");
+			RunTimeSettings::sunDirection = glm::normalize(direction);
+			if (parser.argumentCount() >= 6) RunTimeSettings::sunColor = parser.getVec3(3);
+		}
+		else if (keyword == "set")
+		{
+			parser.expectArguments({ 2 });
+			const auto& setters = getSettingSetters();
+			auto it = setters.find(parser.argument(0));
+			if (it == setters.end())
+			{
+				parser.fail("unknown setting '" + std::string(parser.argument(0)) + "'");
+			}
+			it->second(parser);
+		}
+		else
+		{
+			parser.fail("unknown statement '" + std::string(keyword) + "'");
+		}
+	}
+
+	if (scene.models.empty())
+	{
+		throw std::runtime_error("Scene file " + path + " does not place any model");
+	}
+	return scene;
+}
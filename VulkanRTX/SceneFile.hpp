@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "GLM_defines.hpp"
+
+struct ModelLoadInfo
+{
+	std::string name;
+	std::string objPath;
+	glm::vec3 position;
+	glm::vec3 scale;
+	glm::vec3 rotation;
+	bool isStatic = false; // Never moves, may be baked into merged world space geometry
+};
+
+struct CameraDescription
+{
+	glm::vec3 position = glm::vec3(0, 0, -5);
+	glm::vec3 target = glm::vec3(0, 0, 0);
+	float fov = 60.0f; // Vertical, in degrees
+	float nearPlane = 0.1f;
+	float farPlane = 100.0f;
+};
+
+struct SceneDescription
+{
+	std::vector<ModelLoadInfo> models;
+	CameraDescription camera;
+};
+
+/// <summary>
+/// Text scene description, one statement per line, '#' starts a comment:
+///   asset ID PATH                              names a model file so model lines can share it
+///   model NAME ASSET [px py pz [sx sy sz [rx ry rz]]] [static]
+///   grid NAME ASSET nx ny nz dx dy dz [ox oy oz [sx sy sz]] [static]   nx * ny * nz models spaced by d from o
+///   camera px py pz tx ty tz [fov [near far]]
+///   sun dx dy dz [r g b]                       direction the light travels and its radiance
+///   set SETTING VALUE                          RunTimeSettings and ImportSettings entries, see SceneFile.cpp
+/// ASSET is an asset ID or a model path. Static models are merged into world space BLASes when ImportSettings::mergeStaticModels is set. Rotations are Euler angles in degrees. Settings are applied as soon as they are read.
+/// </summary>
+class SceneFile
+{
+public:
+	/// <summary>
+	/// Parses a scene file, throws with the file and line of the first invalid statement.
+	/// </summary>
+	static SceneDescription load(const std::string& path);
+};
@@ -0,0 +1,225 @@
+#include "StaticSceneBaker.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <string>
+#include <unordered_map>
+#include "ImportSettings.hpp"
+#include "MeshClusterizer.hpp"
+#include "MeshOptimizer.hpp"
+#include "ModelImporter.hpp"
+#include "ThreadPool.hpp"
+
+namespace
+{
+    // Spreads the low 10 bits of v so two zero bits separate each of them
+    uint32_t expandBits(uint32_t v)
+    {
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    }
+
+    // Position given in [0, 1] on every axis
+    uint32_t getMortonCode(const glm::vec3& position)
+    {
+        glm::vec3 cell = glm::clamp(position * 1024.0f, 0.0f, 1023.0f);
+        return (expandBits(static_cast<uint32_t>(cell.x)) << 2) | (expandBits(static_cast<uint32_t>(cell.y)) << 1) | expandBits(static_cast<uint32_t>(cell.z));
+    }
+
+    size_t getTriangleCount(const ModelInfo& asset)
+    {
+        size_t count = 0;
+        for (const MeshInfo& mesh : asset.meshes)
+        {
+            count += mesh.indices.size() / 3;
+        }
+        return count;
+    }
+
+    uint64_t getKey(uint32_t assetIndex, int index)
+    {
+        return (static_cast<uint64_t>(assetIndex) << 32) | static_cast<uint32_t>(index + 1);
+    }
+
+    void appendIndices(const std::vector<uint32_t>& source, uint32_t baseVertex, bool mirrored, std::vector<uint32_t>& target)
+    {
+        size_t first = target.size();
+        target.resize(first + source.size());
+        for (size_t i = 0; i < source.size(); i++)
+        {
+            target[first + i] = source[i] + baseVertex;
+        }
+
+        // A mirroring transform flips the winding, swap two corners to keep front faces
+        if (mirrored)
+        {
+            for (size_t i = first; i + 2 < target.size(); i += 3)
+            {
+                std::swap(target[i + 1], target[i + 2]);
+            }
+        }
+    }
+
+    // Appends a mesh in world space, LOD levels the source does not have reuse its coarsest level
+    void appendMesh(const MeshInfo& source, const glm::mat4& transform, MeshInfo& target)
+    {
+        glm::mat3 linear(transform);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        bool mirrored = glm::determinant(linear) < 0.0f;
+
+        uint32_t baseVertex = static_cast<uint32_t>(target.vertices.size());
+        target.vertices.reserve(target.vertices.size() + source.vertices.size());
+        for (VulkanVertex vertex : source.vertices)
+        {
+            vertex.pos = glm::vec3(transform * glm::vec4(vertex.pos, 1.0f));
+            vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+
+            // Tangent and bitangent follow the surface derivatives, like positions
+            glm::vec3 tangent = linear * vertex.tangent;
+            glm::vec3 bitangent = linear * vertex.bitangent;
+            vertex.tangent = glm::length(tangent) > 0.0f ? glm::normalize(tangent) : tangent;
+            vertex.bitangent = glm::length(bitangent) > 0.0f ? glm::normalize(bitangent) : bitangent;
+            target.vertices.push_back(vertex);
+        }
+
+        appendIndices(source.indices, baseVertex, mirrored, target.indices);
+        for (size_t level = 0; level < target.lods.size(); level++)
+        {
+            if (source.lods.empty())
+            {
+                appendIndices(source.indices, baseVertex, mirrored, target.lods[level].indices);
+                continue;
+            }
+
+            const MeshLod& lod = source.lods[std::min(level, source.lods.size() - 1)];
+            appendIndices(lod.indices, baseVertex, mirrored, target.lods[level].indices);
+            target.lods[level].error = std::max(target.lods[level].error, lod.error);
+        }
+    }
+
+    ModelInfo bakeChunk(const std::vector<ModelInfo>& assetInfos, const std::vector<StaticInstance>& instances, const std::vector<uint32_t>& order, size_t begin, size_t end)
+    {
+        ModelInfo chunk;
+        std::unordered_map<uint64_t, size_t> meshIndices; // Asset material to chunk mesh
+        std::unordered_map<uint64_t, int> materialIndices; // Asset material to chunk material
+
+        // First pass: create the merged meshes and size their LOD chains
+        for (size_t i = begin; i < end; i++)
+        {
+            const StaticInstance& instance = instances[order[i]];
+            const ModelInfo& asset = assetInfos[instance.assetIndex];
+            for (size_t m = 0; m < asset.meshes.size(); m++)
+            {
+                int assetMaterial = asset.meshMaterialIndices[m];
+                uint64_t key = getKey(instance.assetIndex, assetMaterial);
+                auto [it, inserted] = meshIndices.try_emplace(key, chunk.meshes.size());
+                if (inserted)
+                {
+                    int chunkMaterial = -1;
+                    if (assetMaterial >= 0)
+                    {
+                        auto [material, added] = materialIndices.try_emplace(key, static_cast<int>(chunk.materials.size()));
+                        if (added) chunk.materials.push_back(asset.materials[assetMaterial]);
+                        chunkMaterial = material->second;
+                    }
+                    chunk.meshes.emplace_back();
+                    chunk.meshMaterialIndices.push_back(chunkMaterial);
+                }
+
+                MeshInfo& target = chunk.meshes[it->second];
+                if (target.lods.size() < asset.meshes[m].lods.size())
+                {
+                    target.lods.resize(asset.meshes[m].lods.size());
+                }
+            }
+        }
+
+        // Second pass: append the geometry in world space
+        for (size_t i = begin; i < end; i++)
+        {
+            const StaticInstance& instance = instances[order[i]];
+            const ModelInfo& asset = assetInfos[instance.assetIndex];
+            for (size_t m = 0; m < asset.meshes.size(); m++)
+            {
+                MeshInfo& target = chunk.meshes[meshIndices[getKey(instance.assetIndex, asset.meshMaterialIndices[m])]];
+                appendMesh(asset.meshes[m], instance.transform, target);
+            }
+        }
+
+        return chunk;
+    }
+}
+
+std::vector<ModelInfo> StaticSceneBaker::bake(const std::vector<ModelInfo>& assetInfos, const std::vector<StaticInstance>& instances, size_t chunkTriangles)
+{
+    if (instances.empty())
+    {
+        return {};
+    }
+
+    // Sort instances along a Morton curve of their position so chunks are spatially compact
+    glm::vec3 minPosition(FLT_MAX);
+    glm::vec3 maxPosition(-FLT_MAX);
+    for (const StaticInstance& instance : instances)
+    {
+        glm::vec3 position(instance.transform[3]);
+        minPosition = glm::min(minPosition, position);
+        maxPosition = glm::max(maxPosition, position);
+    }
+    glm::vec3 extent = glm::max(maxPosition - minPosition, glm::vec3(1e-6f));
+
+    std::vector<uint32_t> mortonCodes(instances.size());
+    std::vector<uint32_t> order(instances.size());
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        mortonCodes[i] = getMortonCode((glm::vec3(instances[i].transform[3]) - minPosition) / extent);
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return mortonCodes[a] < mortonCodes[b]; });
+
+    // Greedy chunks along the curve, an instance larger than the budget gets a chunk of its own
+    std::vector<std::pair<size_t, size_t>> chunkRanges;
+    size_t chunkBegin = 0;
+    size_t chunkTriangleCount = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        size_t triangleCount = getTriangleCount(assetInfos[instances[order[i]].assetIndex]);
+        if (i > chunkBegin && chunkTriangleCount + triangleCount > chunkTriangles)
+        {
+            chunkRanges.emplace_back(chunkBegin, i);
+            chunkBegin = i;
+            chunkTriangleCount = 0;
+        }
+        chunkTriangleCount += triangleCount;
+    }
+    chunkRanges.emplace_back(chunkBegin, order.size());
+
+    std::vector<ModelInfo> chunks(chunkRanges.size());
+    ThreadPool::getShared().parallelFor(chunks.size(), [&](size_t i)
+    {
+        chunks[i] = bakeChunk(assetInfos, instances, order, chunkRanges[i].first, chunkRanges[i].second);
+    });
+
+    // Merged meshes span whole regions, clustering gives the BLAS compact geometries again
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        ModelInfo& chunk = chunks[c];
+        if (ImportSettings::clusterTriangleBudget > 0)
+        {
+            MeshClusterizer::clusterize(chunk.meshes, "Static chunk " + std::to_string(c));
+        }
+        if (ImportSettings::optimizeMeshes)
+        {
+            // Vertex order is kept so the merged LOD indices stay valid
+            ThreadPool::getShared().parallelFor(chunk.meshes.size(), [&](size_t i)
+            {
+                MeshOptimizer::optimizeVertexCache(chunk.meshes[i]);
+            });
+        }
+        ModelImporter::computeBounds(chunk);
+    }
+
+    return chunks;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ObjLoader.hpp"
+
+// One placement of an imported asset that never moves
+struct StaticInstance
+{
+    uint32_t assetIndex;
+    glm::mat4 transform;
+};
+
+/// <summary>
+/// Bakes static placements into world space geometry so they are traced without a TLAS instance each.
+/// Instances are sorted along a Morton curve of their position and packed into chunks of about a triangle budget, so every
+/// chunk covers a compact region. Inside a chunk, the meshes of one asset material are merged into a single mesh, LODs are
+/// merged level by level and the result is clustered for the BLAS build like imported meshes.
+/// </summary>
+class StaticSceneBaker
+{
+public:
+    /// <summary>
+    /// Returns one ModelInfo per chunk, with vertices in world space.
+    /// </summary>
+    static std::vector<ModelInfo> bake(const std::vector<ModelInfo>& assetInfos, const std::vector<StaticInstance>& instances, size_t chunkTriangles);
+};
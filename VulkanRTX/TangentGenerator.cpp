@@ -0,0 +1,392 @@
+#include "TangentGenerator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include "ThreadPool.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TANGENTS_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t TRIANGLE_GRAIN = 16384;
+    constexpr size_t VERTEX_GRAIN = 16384;
+    constexpr size_t FACE_BLOCK_SIZE = 256;
+    constexpr float DEGENERATE_UV_DETERMINANT = 1e-20f;
+    constexpr float MIN_LENGTH_SQUARED = 1e-20f;
+
+    // Runs job(begin, end) over [0, count) split into chunks of at most grain elements
+    template <typename Job>
+    void forRanges(size_t count, size_t grain, const Job& job)
+    {
+        size_t chunkCount = (count + grain - 1) / grain;
+        ThreadPool::getShared().parallelFor(chunkCount, [&](size_t chunk)
+        {
+            size_t begin = chunk * grain;
+            job(begin, std::min(count, begin + grain));
+        });
+    }
+
+    struct FaceVectors
+    {
+        std::vector<float> tangentX, tangentY, tangentZ;
+        std::vector<float> bitangentX, bitangentY, bitangentZ;
+
+        void resize(size_t count)
+        {
+            tangentX.resize(count); tangentY.resize(count); tangentZ.resize(count);
+            bitangentX.resize(count); bitangentY.resize(count); bitangentZ.resize(count);
+        }
+    };
+
+    struct StagedVertices
+    {
+        std::vector<float> x, y, z, u, v;
+    };
+
+    void computeFaceScalar(const StagedVertices& in, const uint32_t* indices, size_t triangle, FaceVectors& out, size_t outOffset)
+    {
+        uint32_t i0 = indices[triangle * 3 + 0];
+        uint32_t i1 = indices[triangle * 3 + 1];
+        uint32_t i2 = indices[triangle * 3 + 2];
+
+        float e1x = in.x[i1] - in.x[i0], e1y = in.y[i1] - in.y[i0], e1z = in.z[i1] - in.z[i0];
+        float e2x = in.x[i2] - in.x[i0], e2y = in.y[i2] - in.y[i0], e2z = in.z[i2] - in.z[i0];
+        float du1 = in.u[i1] - in.u[i0], dv1 = in.v[i1] - in.v[i0];
+        float du2 = in.u[i2] - in.u[i0], dv2 = in.v[i2] - in.v[i0];
+
+        float determinant = du1 * dv2 - du2 * dv1;
+        float f = std::fabs(determinant) > DEGENERATE_UV_DETERMINANT ? 1.0f / determinant : 0.0f;
+
+        size_t o = triangle - outOffset;
+        out.tangentX[o] = f * (dv2 * e1x - dv1 * e2x);
+        out.tangentY[o] = f * (dv2 * e1y - dv1 * e2y);
+        out.tangentZ[o] = f * (dv2 * e1z - dv1 * e2z);
+        out.bitangentX[o] = f * (du1 * e2x - du2 * e1x);
+        out.bitangentY[o] = f * (du1 * e2y - du2 * e1y);
+        out.bitangentZ[o] = f * (du1 * e2z - du2 * e1z);
+    }
+
+    // Face vectors of triangles [begin, end), triangle t is written at t - outOffset
+    void computeFaces(const StagedVertices& in, const uint32_t* indices, size_t begin, size_t end, FaceVectors& out, size_t outOffset)
+    {
+        size_t triangle = begin;
+
+#ifdef TANGENTS_USE_SSE
+        // Four triangles per iteration, corners are gathered from the SoA arrays into SSE lanes
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 epsilon = _mm_set1_ps(DEGENERATE_UV_DETERMINANT);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        for (; triangle + 4 <= end; triangle += 4)
+        {
+            const uint32_t* t = indices + triangle * 3;
+            auto gather = [t](const std::vector<float>& values, int corner)
+            {
+                return _mm_setr_ps(values[t[corner]], values[t[3 + corner]], values[t[6 + corner]], values[t[9 + corner]]);
+            };
+
+            __m128 x0 = gather(in.x, 0), y0 = gather(in.y, 0), z0 = gather(in.z, 0), u0 = gather(in.u, 0), v0 = gather(in.v, 0);
+            __m128 e1x = _mm_sub_ps(gather(in.x, 1), x0), e1y = _mm_sub_ps(gather(in.y, 1), y0), e1z = _mm_sub_ps(gather(in.z, 1), z0);
+            __m128 e2x = _mm_sub_ps(gather(in.x, 2), x0), e2y = _mm_sub_ps(gather(in.y, 2), y0), e2z = _mm_sub_ps(gather(in.z, 2), z0);
+            __m128 du1 = _mm_sub_ps(gather(in.u, 1), u0), dv1 = _mm_sub_ps(gather(in.v, 1), v0);
+            __m128 du2 = _mm_sub_ps(gather(in.u, 2), u0), dv2 = _mm_sub_ps(gather(in.v, 2), v0);
+
+            __m128 determinant = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+            __m128 valid = _mm_cmpgt_ps(_mm_andnot_ps(signMask, determinant), epsilon);
+            __m128 f = _mm_and_ps(valid, _mm_div_ps(one, determinant));
+
+            _mm_storeu_ps(&out.tangentX[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1x), _mm_mul_ps(dv1, e2x))));
+            _mm_storeu_ps(&out.tangentY[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1y), _mm_mul_ps(dv1, e2y))));
+            _mm_storeu_ps(&out.tangentZ[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1z), _mm_mul_ps(dv1, e2z))));
+            _mm_storeu_ps(&out.bitangentX[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2x), _mm_mul_ps(du2, e1x))));
+            _mm_storeu_ps(&out.bitangentY[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2y), _mm_mul_ps(du2, e1y))));
+            _mm_storeu_ps(&out.bitangentZ[triangle - outOffset], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2z), _mm_mul_ps(du2, e1z))));
+        }
+#endif
+
+        for (; triangle < end; triangle++)
+        {
+            computeFaceScalar(in, indices, triangle, out, outOffset);
+        }
+    }
+
+    // Orthonormal basis from a unit normal, see Duff et al. "Building an Orthonormal Basis, Revisited"
+    void basisFromNormal(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent)
+    {
+        float sign = std::copysign(1.0f, n.z);
+        float a = -1.0f / (sign + n.z);
+        float b = n.x * n.y * a;
+        tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+    }
+
+    // Turns the accumulated tangent and bitangent of a vertex into an orthonormal frame
+    void finalizeVertex(VulkanVertex& vertex)
+    {
+        glm::vec3 tangent = vertex.tangent;
+        glm::vec3 bitangent = vertex.bitangent;
+        glm::vec3 normal = vertex.normal;
+        float normalLength2 = glm::dot(normal, normal);
+
+        if (!(normalLength2 > MIN_LENGTH_SQUARED))
+        {
+            // No usable normal, keep the raw directions
+            float tangentLength2 = glm::dot(tangent, tangent);
+            float bitangentLength2 = glm::dot(bitangent, bitangent);
+            vertex.tangent = tangentLength2 > MIN_LENGTH_SQUARED ? tangent / std::sqrt(tangentLength2) : glm::vec3(1, 0, 0);
+            vertex.bitangent = bitangentLength2 > MIN_LENGTH_SQUARED ? bitangent / std::sqrt(bitangentLength2) : glm::vec3(0, 1, 0);
+            return;
+        }
+        normal = normal / std::sqrt(normalLength2);
+
+        // Gram-Schmidt
+        glm::vec3 orthogonal = tangent - normal * glm::dot(normal, tangent);
+        float orthogonalLength2 = glm::dot(orthogonal, orthogonal);
+        if (!(orthogonalLength2 > MIN_LENGTH_SQUARED))
+        {
+            basisFromNormal(normal, vertex.tangent, vertex.bitangent);
+            return;
+        }
+        vertex.tangent = orthogonal / std::sqrt(orthogonalLength2);
+
+        // Keep the handedness of the UV mapping
+        glm::vec3 cross = glm::cross(normal, vertex.tangent);
+        vertex.bitangent = glm::dot(cross, bitangent) < 0.0f ? -cross : cross;
+    }
+}
+
+void TangentGenerator::generate(MeshInfo& mesh)
+{
+    size_t vertexCount = mesh.vertices.size();
+    size_t triangleCount = mesh.indices.size() / 3;
+    if (vertexCount == 0) return;
+
+    // SoA staging of the attributes read by the face pass
+    StagedVertices staged;
+    staged.x.resize(vertexCount); staged.y.resize(vertexCount); staged.z.resize(vertexCount);
+    staged.u.resize(vertexCount); staged.v.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const VulkanVertex& vertex = mesh.vertices[i];
+        staged.x[i] = vertex.pos.x;
+        staged.y[i] = vertex.pos.y;
+        staged.z[i] = vertex.pos.z;
+        staged.u[i] = vertex.texCoord.x;
+        staged.v[i] = vertex.texCoord.y;
+    }
+
+    // Sums are accumulated in the output attributes of the vertices
+    for (VulkanVertex& vertex : mesh.vertices)
+    {
+        vertex.tangent = glm::vec3(0.0f);
+        vertex.bitangent = glm::vec3(0.0f);
+    }
+
+    if (triangleCount > 2 * TRIANGLE_GRAIN && ThreadPool::getShared().getWorkerCount() > 1)
+    {
+        FaceVectors faces;
+        faces.resize(triangleCount);
+        forRanges(triangleCount, TRIANGLE_GRAIN, [&](size_t begin, size_t end)
+        {
+            computeFaces(staged, mesh.indices.data(), begin, end, faces, 0);
+        });
+
+        // Vertex to triangle adjacency (CSR), lets each vertex gather its faces instead of scattering into shared vertices
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacencyOffsets[mesh.indices[i] + 1]++;
+        }
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        }
+        std::vector<uint32_t> adjacentTriangles(triangleCount * 3);
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacentTriangles[cursor[mesh.indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        forRanges(vertexCount, VERTEX_GRAIN, [&](size_t begin, size_t end)
+        {
+            for (size_t v = begin; v < end; v++)
+            {
+                VulkanVertex& vertex = mesh.vertices[v];
+                for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++)
+                {
+                    uint32_t t = adjacentTriangles[a];
+                    vertex.tangent += glm::vec3(faces.tangentX[t], faces.tangentY[t], faces.tangentZ[t]);
+                    vertex.bitangent += glm::vec3(faces.bitangentX[t], faces.bitangentY[t], faces.bitangentZ[t]);
+                }
+            }
+        });
+    }
+    else
+    {
+        // Small meshes (or a single worker): building the adjacency costs more than a serial scatter,
+        // faces are computed in small blocks and scattered while they are still in cache
+        FaceVectors block;
+        block.resize(FACE_BLOCK_SIZE);
+        for (size_t begin = 0; begin < triangleCount; begin += FACE_BLOCK_SIZE)
+        {
+            size_t end = std::min(triangleCount, begin + FACE_BLOCK_SIZE);
+            computeFaces(staged, mesh.indices.data(), begin, end, block, begin);
+
+            for (size_t t = begin; t < end; t++)
+            {
+                size_t b = t - begin;
+                glm::vec3 tangent(block.tangentX[b], block.tangentY[b], block.tangentZ[b]);
+                glm::vec3 bitangent(block.bitangentX[b], block.bitangentY[b], block.bitangentZ[b]);
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    VulkanVertex& vertex = mesh.vertices[mesh.indices[t * 3 + corner]];
+                    vertex.tangent += tangent;
+                    vertex.bitangent += bitangent;
+                }
+            }
+        }
+    }
+
+    forRanges(vertexCount, VERTEX_GRAIN, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; v++)
+        {
+            finalizeVertex(mesh.vertices[v]);
+        }
+    });
+}
+
+void TangentGenerator::generate(std::vector<MeshInfo>& meshes)
+{
+    ThreadPool::getShared().parallelFor(meshes.size(), [&](size_t i)
+    {
+        generate(meshes[i]);
+    });
+}
+
+void TangentGenerator::generateReference(MeshInfo& mesh)
+{
+    // Iterate over each triangle
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        uint32_t i1 = mesh.indices[i];
+        uint32_t i2 = mesh.indices[i+1];
+        uint32_t i3 = mesh.indices[i+2];
+
+        VulkanVertex& v1 = mesh.vertices[i1];
+        VulkanVertex& v2 = mesh.vertices[i2];
+        VulkanVertex& v3 = mesh.vertices[i3];
+
+        glm::vec3 edge1 = v2.pos - v1.pos;
+        glm::vec3 edge2 = v3.pos - v1.pos;
+        glm::vec2 deltaUV1 = v2.texCoord - v1.texCoord;
+        glm::vec2 deltaUV2 = v3.texCoord - v1.texCoord;
+
+        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+        glm::vec3 tangent;
+        tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+        tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+        tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+
+        v1.tangent += tangent;
+        v2.tangent += tangent;
+        v3.tangent += tangent;
+        
+        glm::vec3 bitangent;
+        bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
+        bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
+        bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
+
+        v1.bitangent += bitangent;
+        v2.bitangent += bitangent;
+        v3.bitangent += bitangent;
+    }
+    for (VulkanVertex& vertex : mesh.vertices)
+    {
+        vertex.tangent = glm::normalize(vertex.tangent);
+        vertex.bitangent = glm::normalize(vertex.bitangent);
+    }
+}
+
+void TangentGenerator::runBenchmark(const std::string& modelsDirectory)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr int ITERATIONS = 5;
+
+    auto countInvalid = [](const std::vector<MeshInfo>& meshes)
+    {
+        size_t count = 0;
+        for (const MeshInfo& mesh : meshes)
+        {
+            for (const VulkanVertex& vertex : mesh.vertices)
+            {
+                if (!std::isfinite(vertex.tangent.x + vertex.tangent.y + vertex.tangent.z + vertex.bitangent.x + vertex.bitangent.y + vertex.bitangent.z))
+                {
+                    count++;
+                }
+            }
+        }
+        return count;
+    };
+
+    std::vector<std::string> objPaths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(modelsDirectory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".obj")
+        {
+            objPaths.push_back(entry.path().generic_string());
+        }
+    }
+    std::sort(objPaths.begin(), objPaths.end());
+
+    std::cout << "Tangent generation benchmark, " << ITERATIONS << " runs per model, "
+              << ThreadPool::getShared().getWorkerCount() << " workers\n";
+
+    for (const std::string& path : objPaths)
+    {
+        ModelInfo model = ObjLoader::loadObj(path);
+        size_t vertexCount = 0;
+        size_t triangleCount = 0;
+        for (MeshInfo& mesh : model.meshes)
+        {
+            vertexCount += mesh.vertices.size();
+            triangleCount += mesh.indices.size() / 3;
+            for (VulkanVertex& vertex : mesh.vertices)
+            {
+                vertex.tangent = glm::vec3(0.0f);
+                vertex.bitangent = glm::vec3(0.0f);
+            }
+        }
+
+        double referenceTime = 1e30;
+        double currentTime = 1e30;
+        std::vector<MeshInfo> referenceResult;
+        std::vector<MeshInfo> currentResult;
+        for (int i = 0; i < ITERATIONS; i++)
+        {
+            referenceResult = model.meshes;
+            auto start = Clock::now();
+            for (MeshInfo& mesh : referenceResult)
+            {
+                generateReference(mesh);
+            }
+            referenceTime = std::min(referenceTime, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+            currentResult = model.meshes;
+            start = Clock::now();
+            generate(currentResult);
+            currentTime = std::min(currentTime, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+
+        std::cout << path << ": " << model.meshes.size() << " meshes, " << vertexCount << " vertices, " << triangleCount << " triangles\n"
+                  << "    reference: " << referenceTime << " ms (" << countInvalid(referenceResult) << " invalid vertices)\n"
+                  << "    current:   " << currentTime << " ms (" << countInvalid(currentResult) << " invalid vertices), "
+                  << referenceTime / std::max(currentTime, 1e-6) << "x\n";
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ObjLoader.hpp"
+
+/// <summary>
+/// Computes per-vertex tangents and bitangents from positions, normals and UVs.
+/// Face vectors are computed with SSE over an SoA copy of the mesh. On large meshes they are then gathered per vertex through
+/// a vertex to triangle adjacency, so the work splits over triangle and vertex ranges without shared writes.
+/// Triangles with degenerate UVs are skipped, vertices left without a usable tangent get one built from their normal.
+/// </summary>
+class TangentGenerator
+{
+public:
+    static void generate(MeshInfo& mesh);
+
+    /// <summary>
+    /// Generates the tangents of every mesh, meshes are processed in parallel.
+    /// </summary>
+    static void generate(std::vector<MeshInfo>& meshes);
+
+    /// <summary>
+    /// Original scalar implementation, kept as a reference for the benchmark.
+    /// </summary>
+    static void generateReference(MeshInfo& mesh);
+
+    /// <summary>
+    /// Times the reference and the current generator on every OBJ found under the given directory and prints the results.
+    /// </summary>
+    static void runBenchmark(const std::string& modelsDirectory);
+};
@@ -0,0 +1,142 @@
+#include "TextureBatchLoader.hpp"
+#include <chrono>
+#include <iostream>
+#include "ThreadPool.hpp"
+#include "VulkanUtils.hpp"
+
+namespace
+{
+    // Copy offsets must be multiples of the texel block size, 16 bytes for BC5 and BC7
+    constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+    float getElapsedMs(std::chrono::high_resolution_clock::time_point startTime)
+    {
+        return std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+    }
+
+    float getMegabytesPerSecond(uint64_t bytes, float ms)
+    {
+        return ms > 0.0f ? static_cast<float>(bytes) / (1024.0f * 1024.0f) / (ms / 1000.0f) : 0.0f;
+    }
+
+    // Uploads uploads[first, last) through one staging buffer and one submission
+    void uploadRange(const std::vector<TextureBatchUpload>& uploads, const std::vector<TextureUpload>& layouts, size_t first, size_t last, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+    {
+        std::vector<VkDeviceSize> offsets;
+        VkDeviceSize stagingSize = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            offsets.push_back((stagingSize + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT);
+            stagingSize = offsets.back() + layouts[i].size;
+        }
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        VulkanUtils::Buffers::createBuffer(context, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+        void* data;
+        vkMapMemory(context.device, stagingBufferMemory, 0, stagingSize, 0, &data);
+        ThreadPool::getShared().parallelFor(last - first, [&](size_t i)
+        {
+            VulkanTexture::writeStaging(layouts[first + i], static_cast<uint8_t*>(data) + offsets[i]);
+        });
+        vkUnmapMemory(context.device, stagingBufferMemory);
+
+        for (size_t i = first; i < last; i++)
+        {
+            const TextureUpload& layout = layouts[i];
+            VulkanTexture& texture = *uploads[i].texture;
+            VulkanUtils::Image::createImage(context, layout.width, layout.height, layout.format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.imageMemory, texture.mipLevels);
+        }
+
+        VkCommandBuffer commandBuffer = commandBufferManager.beginSingleTimeCommands(context.device);
+        for (size_t i = first; i < last; i++)
+        {
+            uploads[i].texture->recordUpload(commandBuffer, layouts[i], stagingBuffer, offsets[i - first]);
+        }
+        commandBufferManager.endSingleTimeCommands(context.device, context.graphicsQueue, commandBuffer);
+
+        vkDestroyBuffer(context.device, stagingBuffer, nullptr);
+        vkFreeMemory(context.device, stagingBufferMemory, nullptr);
+
+        for (size_t i = first; i < last; i++)
+        {
+            uploads[i].texture->createImageView(context, layouts[i].format);
+            uploads[i].texture->createSampler(context);
+        }
+    }
+}
+
+uint64_t TextureBatchLoader::maxStagingBytes = 256ull * 1024 * 1024;
+
+std::vector<TextureData> TextureBatchLoader::decode(const std::vector<TextureBatchEntry>& entries, std::vector<std::string>& errors, TextureBatchStatistics& statistics)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<TextureData> data(entries.size());
+    errors.assign(entries.size(), std::string());
+    ThreadPool::getShared().parallelFor(entries.size(), [&](size_t i)
+    {
+        try
+        {
+            data[i] = VulkanTexture::load(entries[i].path, entries[i].format);
+        }
+        catch (const std::exception& e)
+        {
+            errors[i] = e.what();
+        }
+    });
+
+    statistics.decodeMs += getElapsedMs(startTime);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (errors[i].empty())
+        {
+            statistics.decodedTextures++;
+            statistics.decodedBytes += data[i].pixels.size();
+        }
+    }
+    return data;
+}
+
+void TextureBatchLoader::upload(const std::vector<TextureBatchUpload>& uploads, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, TextureBatchStatistics& statistics)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Layouts come with the CPU built levels of formats that cannot be blitted, prepared in parallel
+    std::vector<TextureUpload> layouts(uploads.size());
+    ThreadPool::getShared().parallelFor(uploads.size(), [&](size_t i)
+    {
+        const TextureBatchUpload& upload = uploads[i];
+        layouts[i] = upload.texture->prepareUpload(*upload.data, context, VulkanTexture::getImageFormat(*upload.data, upload.format));
+    });
+
+    size_t first = 0;
+    while (first < uploads.size())
+    {
+        size_t last = first + 1;
+        VkDeviceSize stagingSize = layouts[first].size;
+        while (last < uploads.size() && stagingSize + STAGING_ALIGNMENT + layouts[last].size <= maxStagingBytes)
+        {
+            stagingSize += STAGING_ALIGNMENT + layouts[last].size;
+            last++;
+        }
+
+        uploadRange(uploads, layouts, first, last, context, commandBufferManager);
+        first = last;
+    }
+
+    statistics.uploadMs += getElapsedMs(startTime);
+    statistics.uploadedTextures += uploads.size();
+    for (const TextureUpload& layout : layouts)
+    {
+        statistics.uploadedBytes += layout.size;
+    }
+}
+
+void TextureBatchLoader::printStatistics(const TextureBatchStatistics& statistics)
+{
+    std::cout << "Texture batches: " << statistics.decodedTextures << " decoded, " << statistics.decodedBytes / (1024 * 1024) << " MB in " << statistics.decodeMs << " ms ("
+        << getMegabytesPerSecond(statistics.decodedBytes, statistics.decodeMs) << " MB/s), " << statistics.uploadedTextures << " uploaded, " << statistics.uploadedBytes / (1024 * 1024)
+        << " MB in " << statistics.uploadMs << " ms (" << getMegabytesPerSecond(statistics.uploadedBytes, statistics.uploadMs) << " MB/s)" << std::endl;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "VulkanTexture.hpp"
+
+struct TextureBatchEntry
+{
+    std::string path;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+};
+
+// One texture of a batched upload
+struct TextureBatchUpload
+{
+    VulkanTexture* texture = nullptr;
+    const TextureData* data = nullptr;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB; // Used with, the image takes the block format of compressed data
+};
+
+struct TextureBatchStatistics
+{
+    size_t decodedTextures = 0;
+    uint64_t decodedBytes = 0; // Texture data produced, block compressed chains count their own size
+    float decodeMs = 0.0f;
+    size_t uploadedTextures = 0;
+    uint64_t uploadedBytes = 0; // Staging bytes, with the mip levels built on the CPU
+    float uploadMs = 0.0f;
+};
+
+/// <summary>
+/// Loads many textures at once: files are decoded in parallel on the shared thread pool, then every texture is staged in one
+/// buffer and uploaded by a single command buffer, with one submission and one wait instead of one per texture.
+/// </summary>
+class TextureBatchLoader
+{
+public:
+    static uint64_t maxStagingBytes; // Batches staging more are split into several submissions, a larger texture gets its own
+
+    /// <summary>
+    /// Any thread. Loads every entry with VulkanTexture::load, entries that fail are left empty with their error.
+    /// </summary>
+    static std::vector<TextureData> decode(const std::vector<TextureBatchEntry>& entries, std::vector<std::string>& errors, TextureBatchStatistics& statistics);
+
+    /// <summary>
+    /// Main thread. Creates the image, view and sampler of every texture from its data, like VulkanTexture::init.
+    /// </summary>
+    static void upload(const std::vector<TextureBatchUpload>& uploads, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, TextureBatchStatistics& statistics);
+
+    static void printStatistics(const TextureBatchStatistics& statistics);
+};
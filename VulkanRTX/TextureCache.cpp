@@ -0,0 +1,316 @@
+#include "TextureCache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "MappedFile.hpp"
+#include "TextureCompressor.hpp"
+#include "Utils.hpp"
+
+namespace
+{
+    constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    constexpr char SOURCE_KEY[] = "VulkanRTX.source";
+    constexpr uint32_t ENCODER_VERSION = 1; // Bump when the compressor output changes
+
+    // Khronos data format descriptor values
+    constexpr uint8_t KHR_DF_MODEL_BC5 = 131;
+    constexpr uint8_t KHR_DF_MODEL_BC7 = 134;
+    constexpr uint8_t KHR_DF_PRIMARIES_BT709 = 1;
+    constexpr uint8_t KHR_DF_TRANSFER_LINEAR = 1;
+    constexpr uint8_t KHR_DF_TRANSFER_SRGB = 2;
+    constexpr uint8_t KHR_DF_CHANNEL_RED = 0;
+    constexpr uint8_t KHR_DF_CHANNEL_GREEN = 1;
+
+    struct Ktx2Header
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must be packed");
+
+    struct Ktx2Level
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    // Source file identity recorded in the cache entry
+    struct SourceStamp
+    {
+        uint64_t size = 0;
+        int64_t modifiedTime = 0;
+        uint64_t hash = 0;
+        uint32_t encoderVersion = ENCODER_VERSION;
+    };
+
+    bool getSourceStamp(const std::string& path, SourceStamp& stamp, bool withHash)
+    {
+        std::error_code error;
+        stamp.size = std::filesystem::file_size(path, error);
+        if (error) return false;
+        auto modifiedTime = std::filesystem::last_write_time(path, error);
+        if (error) return false;
+        stamp.modifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+
+        if (withHash)
+        {
+            MappedFile file;
+            if (!file.open(path)) return false;
+            stamp.hash = hashBytes(file.data(), file.size());
+        }
+        return true;
+    }
+
+    bool isUpToDate(const std::string& sourcePath, const SourceStamp& cached)
+    {
+        SourceStamp stamp;
+        if (cached.encoderVersion != ENCODER_VERSION || !getSourceStamp(sourcePath, stamp, false) || stamp.size != cached.size)
+        {
+            return false;
+        }
+        if (stamp.modifiedTime == cached.modifiedTime)
+        {
+            return true;
+        }
+
+        // Touched but maybe not modified, compare the content
+        return getSourceStamp(sourcePath, stamp, true) && stamp.hash == cached.hash;
+    }
+
+    template <typename T>
+    void append(std::vector<char>& buffer, const T& value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void alignTo(std::vector<char>& buffer, size_t alignment)
+    {
+        buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    // Basic descriptor block: one 128 bit sample for BC7, a 64 bit red and green sample for BC5
+    std::vector<char> createDataFormatDescriptor(VkFormat format)
+    {
+        bool bc5 = format == VK_FORMAT_BC5_UNORM_BLOCK;
+        uint16_t sampleCount = bc5 ? 2 : 1;
+        uint16_t blockSize = static_cast<uint16_t>(24 + 16 * sampleCount);
+
+        std::vector<char> dfd;
+        append(dfd, static_cast<uint32_t>(4 + blockSize));
+        append(dfd, static_cast<uint32_t>(0)); // Khronos vendor, basic descriptor type
+        append(dfd, static_cast<uint16_t>(2)); // Version 1.3
+        append(dfd, blockSize);
+        append(dfd, bc5 ? KHR_DF_MODEL_BC5 : KHR_DF_MODEL_BC7);
+        append(dfd, KHR_DF_PRIMARIES_BT709);
+        append(dfd, format == VK_FORMAT_BC7_SRGB_BLOCK ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR);
+        append(dfd, static_cast<uint8_t>(0)); // Straight alpha
+        const uint8_t blockDimensions[4] = { 3, 3, 0, 0 }; // 4x4x1x1, stored minus one
+        dfd.insert(dfd.end(), blockDimensions, blockDimensions + 4);
+        const uint8_t bytesPlane[8] = { static_cast<uint8_t>(TextureCompressor::BLOCK_BYTES), 0, 0, 0, 0, 0, 0, 0 };
+        dfd.insert(dfd.end(), bytesPlane, bytesPlane + 8);
+
+        for (uint16_t sample = 0; sample < sampleCount; sample++)
+        {
+            append(dfd, static_cast<uint16_t>(bc5 ? sample * 64 : 0)); // Bit offset
+            append(dfd, static_cast<uint8_t>(bc5 ? 63 : 127)); // Bit length minus one
+            append(dfd, sample == 0 ? KHR_DF_CHANNEL_RED : KHR_DF_CHANNEL_GREEN);
+            append(dfd, static_cast<uint32_t>(0)); // Sample position
+            append(dfd, static_cast<uint32_t>(0)); // Lower
+            append(dfd, static_cast<uint32_t>(UINT32_MAX)); // Upper
+        }
+        return dfd;
+    }
+
+    bool findSourceStamp(const char* kvd, size_t size, SourceStamp& stamp)
+    {
+        size_t offset = 0;
+        while (offset + 4 <= size)
+        {
+            uint32_t length;
+            std::memcpy(&length, kvd + offset, 4);
+            const char* entry = kvd + offset + 4;
+            if (length > size - offset - 4) return false;
+
+            size_t keyLength = strnlen(entry, length);
+            if (keyLength == sizeof(SOURCE_KEY) - 1 && std::memcmp(entry, SOURCE_KEY, keyLength) == 0 && length - keyLength - 1 == sizeof(SourceStamp))
+            {
+                std::memcpy(&stamp, entry + keyLength + 1, sizeof(SourceStamp));
+                return true;
+            }
+            offset += 4 + (length + 3) / 4 * 4;
+        }
+        return false;
+    }
+}
+
+std::string TextureCache::getCachePath(const std::string& sourcePath, VkFormat compressedFormat)
+{
+    return sourcePath + (compressedFormat == VK_FORMAT_BC5_UNORM_BLOCK ? ".bc5.ktx2" : ".bc7.ktx2");
+}
+
+bool TextureCache::load(const std::string& sourcePath, VkFormat compressedFormat, TextureData& data)
+{
+    std::string cachePath = getCachePath(sourcePath, compressedFormat);
+    if (!std::filesystem::exists(cachePath)) return false;
+
+    MappedFile file;
+    if (!file.open(cachePath)) return false;
+
+    try
+    {
+        if (file.size() < sizeof(Ktx2Header))
+        {
+            throw std::runtime_error("truncated header");
+        }
+        Ktx2Header header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0 || header.vkFormat != static_cast<uint32_t>(compressedFormat) ||
+            header.supercompressionScheme != 0 || header.levelCount == 0 || header.pixelWidth == 0 || header.pixelHeight == 0)
+        {
+            return false;
+        }
+        if (header.kvdByteOffset + static_cast<uint64_t>(header.kvdByteLength) > file.size() || sizeof(Ktx2Header) + header.levelCount * sizeof(Ktx2Level) > file.size())
+        {
+            throw std::runtime_error("truncated index");
+        }
+
+        SourceStamp stamp;
+        if (!findSourceStamp(file.data() + header.kvdByteOffset, header.kvdByteLength, stamp) || !isUpToDate(sourcePath, stamp))
+        {
+            return false;
+        }
+
+        TextureData cached;
+        cached.width = header.pixelWidth;
+        cached.height = header.pixelHeight;
+        cached.compressedFormat = compressedFormat;
+        cached.mipLevels = header.levelCount;
+
+        // Levels are indexed from the largest, uploads expect them packed in that order
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+            Ktx2Level index;
+            std::memcpy(&index, file.data() + sizeof(Ktx2Header) + level * sizeof(Ktx2Level), sizeof(index));
+            size_t expected = TextureCompressor::getLevelSize(std::max(cached.width >> level, 1u), std::max(cached.height >> level, 1u));
+            if (index.byteLength != expected || index.byteOffset + index.byteLength > file.size())
+            {
+                throw std::runtime_error("invalid level " + std::to_string(level));
+            }
+            const uint8_t* levelData = reinterpret_cast<const uint8_t*>(file.data() + index.byteOffset);
+            cached.pixels.insert(cached.pixels.end(), levelData, levelData + index.byteLength);
+        }
+
+        data = std::move(cached);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Ignoring texture cache " + cachePath + ": " + e.what() + "\n";
+        return false;
+    }
+}
+
+void TextureCache::store(const std::string& sourcePath, const TextureData& data)
+{
+    SourceStamp stamp;
+    if (!getSourceStamp(sourcePath, stamp, true))
+    {
+        std::cerr << "Cannot cache " + sourcePath + ", the source is missing\n";
+        return;
+    }
+
+    std::vector<char> dfd = createDataFormatDescriptor(data.compressedFormat);
+
+    std::vector<char> kvd;
+    append(kvd, static_cast<uint32_t>(sizeof(SOURCE_KEY) + sizeof(SourceStamp)));
+    kvd.insert(kvd.end(), SOURCE_KEY, SOURCE_KEY + sizeof(SOURCE_KEY));
+    append(kvd, stamp);
+    alignTo(kvd, 4);
+
+    Ktx2Header header{};
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = static_cast<uint32_t>(data.compressedFormat);
+    header.typeSize = 1;
+    header.pixelWidth = data.width;
+    header.pixelHeight = data.height;
+    header.faceCount = 1;
+    header.levelCount = data.mipLevels;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + data.mipLevels * sizeof(Ktx2Level));
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size());
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = static_cast<uint32_t>(kvd.size());
+
+    std::vector<char> buffer;
+    append(buffer, header);
+    buffer.resize(header.dfdByteOffset);
+    buffer.insert(buffer.end(), dfd.begin(), dfd.end());
+    buffer.insert(buffer.end(), kvd.begin(), kvd.end());
+
+    // The format expects the smallest level first in the file, each aligned to the block size
+    std::vector<Ktx2Level> levels(data.mipLevels);
+    std::vector<size_t> sourceOffsets(data.mipLevels);
+    size_t sourceOffset = 0;
+    for (uint32_t level = 0; level < data.mipLevels; level++)
+    {
+        sourceOffsets[level] = sourceOffset;
+        levels[level].byteLength = TextureCompressor::getLevelSize(std::max(data.width >> level, 1u), std::max(data.height >> level, 1u));
+        levels[level].uncompressedByteLength = levels[level].byteLength;
+        sourceOffset += levels[level].byteLength;
+    }
+    if (sourceOffset != data.pixels.size())
+    {
+        std::cerr << "Cannot cache " + sourcePath + ", the mip chain is incomplete\n";
+        return;
+    }
+    for (uint32_t level = data.mipLevels; level-- > 0;)
+    {
+        alignTo(buffer, TextureCompressor::BLOCK_BYTES);
+        levels[level].byteOffset = buffer.size();
+        const char* levelData = reinterpret_cast<const char*>(data.pixels.data() + sourceOffsets[level]);
+        buffer.insert(buffer.end(), levelData, levelData + levels[level].byteLength);
+    }
+    std::memcpy(buffer.data() + sizeof(Ktx2Header), levels.data(), levels.size() * sizeof(Ktx2Level));
+
+    // Write to a temporary file first so a concurrent or interrupted write never leaves a broken cache behind
+    std::string cachePath = getCachePath(sourcePath, data.compressedFormat);
+    std::ostringstream tempPath;
+    tempPath << cachePath << "." << std::this_thread::get_id() << ".tmp";
+
+    {
+        std::ofstream file(tempPath.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to write texture cache " + cachePath + "\n";
+            return;
+        }
+        file.write(buffer.data(), buffer.size());
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath.str(), cachePath, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath.str(), error);
+        std::cerr << "Failed to write texture cache " + cachePath + "\n";
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include "VulkanTexture.hpp"
+
+/// <summary>
+/// Block compressed textures stored as KTX2 files next to their source image, one per compressed format.
+/// The files are standard KTX2 (no supercompression) with a key/value entry recording the size, mtime and content hash of
+/// the source, an entry is valid while the source keeps its size and mtime (or content hash).
+/// </summary>
+class TextureCache
+{
+public:
+    static std::string getCachePath(const std::string& sourcePath, VkFormat compressedFormat);
+
+    /// <summary>
+    /// Loads the cached mip chain of the source in the given format, returns false when there is no valid entry.
+    /// </summary>
+    static bool load(const std::string& sourcePath, VkFormat compressedFormat, TextureData& data);
+
+    /// <summary>
+    /// Writes a block compressed mip chain built from the source.
+    /// </summary>
+    static void store(const std::string& sourcePath, const TextureData& data);
+};
@@ -0,0 +1,391 @@
+#include "TextureCompressor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include "GltfLoader.hpp"
+#include "ModelImporter.hpp"
+#include "ThreadPool.hpp"
+#include "VulkanUtils.hpp"
+
+namespace
+{
+    // Interpolation weights of 4 bit BC7 indices, out of 64
+    constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    class BitWriter
+    {
+    private:
+        uint8_t* bytes;
+        uint32_t position = 0;
+
+    public:
+        explicit BitWriter(uint8_t* bytes) : bytes(bytes) {}
+
+        // Least significant bit first, the target must be zeroed
+        void write(uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++, position++)
+            {
+                if ((value >> i) & 1)
+                {
+                    bytes[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+                }
+            }
+        }
+    };
+
+    // The 4x4 texels of a block, edges are repeated in levels smaller than a block
+    void loadBlock(const TextureData& level, uint32_t blockX, uint32_t blockY, uint8_t texels[16][4])
+    {
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            uint32_t sourceY = std::min(blockY * 4 + y, level.height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                uint32_t sourceX = std::min(blockX * 4 + x, level.width - 1);
+                std::memcpy(texels[y * 4 + x], &level.pixels[(static_cast<size_t>(sourceY) * level.width + sourceX) * 4], 4);
+            }
+        }
+    }
+
+    // 7 bits per channel and a p-bit shared by the channels, the p-bit giving the least error is kept
+    void quantizeEndpoint(const float endpoint[4], uint8_t quantized[4], uint32_t& pbit)
+    {
+        float bestError = FLT_MAX;
+        for (uint32_t p = 0; p < 2; p++)
+        {
+            uint8_t candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                int value = std::clamp(static_cast<int>(std::lround((endpoint[c] - p) * 0.5f)), 0, 127);
+                float difference = static_cast<float>((value << 1) | p) - endpoint[c];
+                error += difference * difference;
+                candidate[c] = static_cast<uint8_t>(value);
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                std::memcpy(quantized, candidate, 4);
+                pbit = p;
+            }
+        }
+    }
+
+    // Gives every texel its closest palette entry, returns the squared error of the block
+    uint32_t assignIndices(const uint8_t texels[16][4], const uint8_t quantized[2][4], const uint32_t pbits[2], uint8_t indices[16])
+    {
+        int palette[16][4];
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                int e0 = (quantized[0][c] << 1) | pbits[0];
+                int e1 = (quantized[1][c] << 1) | pbits[1];
+                palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6;
+            }
+        }
+
+        uint32_t totalError = 0;
+        for (int t = 0; t < 16; t++)
+        {
+            uint32_t bestError = UINT32_MAX;
+            for (int i = 0; i < 16; i++)
+            {
+                uint32_t error = 0;
+                for (int c = 0; c < 4; c++)
+                {
+                    int difference = palette[i][c] - texels[t][c];
+                    error += static_cast<uint32_t>(difference * difference);
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[t] = static_cast<uint8_t>(i);
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    void encodeBC7Block(const uint8_t texels[16][4], uint8_t* block)
+    {
+        // Principal axis of the colors by power iteration on their covariance
+        float mean[4] = {};
+        for (int t = 0; t < 16; t++)
+        {
+            for (int c = 0; c < 4; c++) mean[c] += texels[t][c] / 16.0f;
+        }
+        float covariance[4][4] = {};
+        for (int t = 0; t < 16; t++)
+        {
+            for (int a = 0; a < 4; a++)
+            {
+                for (int b = 0; b < 4; b++)
+                {
+                    covariance[a][b] += (texels[t][a] - mean[a]) * (texels[t][b] - mean[b]);
+                }
+            }
+        }
+        float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            for (int a = 0; a < 4; a++)
+            {
+                for (int b = 0; b < 4; b++) next[a] += covariance[a][b] * axis[b];
+            }
+            float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+            if (length < 1e-6f) break;
+            for (int c = 0; c < 4; c++) axis[c] = next[c] / length;
+        }
+
+        // Endpoints at the extremes of the projections, a flat block collapses to its mean
+        float minT = 0.0f;
+        float maxT = 0.0f;
+        for (int t = 0; t < 16; t++)
+        {
+            float projection = 0.0f;
+            for (int c = 0; c < 4; c++) projection += (texels[t][c] - mean[c]) * axis[c];
+            minT = std::min(minT, projection);
+            maxT = std::max(maxT, projection);
+        }
+        float endpoints[2][4];
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[0][c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            endpoints[1][c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+
+        uint8_t quantized[2][4];
+        uint32_t pbits[2];
+        uint8_t indices[16];
+        quantizeEndpoint(endpoints[0], quantized[0], pbits[0]);
+        quantizeEndpoint(endpoints[1], quantized[1], pbits[1]);
+        uint32_t error = assignIndices(texels, quantized, pbits, indices);
+
+        // Least squares endpoints for the chosen indices, kept while they lower the error
+        for (int iteration = 0; iteration < 2 && error > 0; iteration++)
+        {
+            float a = 0.0f, b = 0.0f, d = 0.0f;
+            float r0[4] = {};
+            float r1[4] = {};
+            for (int t = 0; t < 16; t++)
+            {
+                float w = BC7_WEIGHTS[indices[t]] / 64.0f;
+                a += (1.0f - w) * (1.0f - w);
+                b += (1.0f - w) * w;
+                d += w * w;
+                for (int c = 0; c < 4; c++)
+                {
+                    r0[c] += (1.0f - w) * texels[t][c];
+                    r1[c] += w * texels[t][c];
+                }
+            }
+            float determinant = a * d - b * b;
+            if (std::abs(determinant) < 1e-6f) break;
+
+            for (int c = 0; c < 4; c++)
+            {
+                endpoints[0][c] = std::clamp((d * r0[c] - b * r1[c]) / determinant, 0.0f, 255.0f);
+                endpoints[1][c] = std::clamp((a * r1[c] - b * r0[c]) / determinant, 0.0f, 255.0f);
+            }
+
+            uint8_t refined[2][4];
+            uint32_t refinedPbits[2];
+            uint8_t refinedIndices[16];
+            quantizeEndpoint(endpoints[0], refined[0], refinedPbits[0]);
+            quantizeEndpoint(endpoints[1], refined[1], refinedPbits[1]);
+            uint32_t refinedError = assignIndices(texels, refined, refinedPbits, refinedIndices);
+            if (refinedError >= error) break;
+
+            error = refinedError;
+            std::memcpy(quantized, refined, sizeof(quantized));
+            std::memcpy(pbits, refinedPbits, sizeof(pbits));
+            std::memcpy(indices, refinedIndices, sizeof(indices));
+        }
+
+        // The most significant bit of the first index is implicit 0, swap the endpoints to keep it so
+        if (indices[0] & 8)
+        {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pbits[0], pbits[1]);
+            for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+        }
+
+        std::memset(block, 0, TextureCompressor::BLOCK_BYTES);
+        BitWriter writer(block);
+        writer.write(1 << 6, 7); // Mode 6
+        for (int c = 0; c < 4; c++)
+        {
+            writer.write(quantized[0][c], 7);
+            writer.write(quantized[1][c], 7);
+        }
+        writer.write(pbits[0], 1);
+        writer.write(pbits[1], 1);
+        writer.write(indices[0], 3);
+        for (int t = 1; t < 16; t++)
+        {
+            writer.write(indices[t], 4);
+        }
+    }
+
+    // 8 value mode: the maximum, the minimum and 6 values between them
+    void encodeBC4Block(const uint8_t values[16], uint8_t* block)
+    {
+        uint8_t minValue = *std::min_element(values, values + 16);
+        uint8_t maxValue = *std::max_element(values, values + 16);
+        std::memset(block, 0, 8);
+        block[0] = maxValue;
+        block[1] = minValue;
+        if (maxValue == minValue) return;
+
+        int palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int i = 2; i < 8; i++)
+        {
+            palette[i] = ((8 - i) * maxValue + (i - 1) * minValue + 3) / 7;
+        }
+
+        uint64_t bits = 0;
+        for (int t = 0; t < 16; t++)
+        {
+            int bestIndex = 0;
+            int bestError = INT32_MAX;
+            for (int i = 0; i < 8; i++)
+            {
+                int error = std::abs(palette[i] - values[t]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = i;
+                }
+            }
+            bits |= static_cast<uint64_t>(bestIndex) << (3 * t);
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            block[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+    }
+
+    template<typename EncodeBlock>
+    std::vector<uint8_t> compressBlocks(const TextureData& level, EncodeBlock encodeBlock)
+    {
+        uint32_t blocksX = (level.width + 3) / 4;
+        uint32_t blocksY = (level.height + 3) / 4;
+        std::vector<uint8_t> blocks(static_cast<size_t>(blocksX) * blocksY * TextureCompressor::BLOCK_BYTES);
+        ThreadPool::getShared().parallelFor(blocksY, [&](size_t blockY)
+        {
+            uint8_t texels[16][4];
+            for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+            {
+                loadBlock(level, blockX, static_cast<uint32_t>(blockY), texels);
+                encodeBlock(texels, &blocks[(blockY * blocksX + blockX) * TextureCompressor::BLOCK_BYTES]);
+            }
+        });
+        return blocks;
+    }
+}
+
+std::vector<uint8_t> TextureCompressor::compressBC7(const TextureData& level)
+{
+    return compressBlocks(level, encodeBC7Block);
+}
+
+std::vector<uint8_t> TextureCompressor::compressBC5(const TextureData& level)
+{
+    return compressBlocks(level, [](const uint8_t texels[16][4], uint8_t* block)
+    {
+        uint8_t red[16];
+        uint8_t green[16];
+        for (int t = 0; t < 16; t++)
+        {
+            red[t] = texels[t][0];
+            green[t] = texels[t][1];
+        }
+        encodeBC4Block(red, block);
+        encodeBC4Block(green, block + 8);
+    });
+}
+
+size_t TextureCompressor::getLevelSize(uint32_t width, uint32_t height)
+{
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * BLOCK_BYTES;
+}
+
+TextureData TextureCompressor::compress(const TextureData& data, VkFormat compressedFormat)
+{
+    if (compressedFormat != VK_FORMAT_BC7_SRGB_BLOCK && compressedFormat != VK_FORMAT_BC7_UNORM_BLOCK && compressedFormat != VK_FORMAT_BC5_UNORM_BLOCK)
+    {
+        throw std::runtime_error("unsupported block compressed format!");
+    }
+
+    TextureData result;
+    result.width = data.width;
+    result.height = data.height;
+    result.compressedFormat = compressedFormat;
+    result.mipLevels = VulkanUtils::Image::getMipLevelCount(data.width, data.height);
+
+    TextureData level;
+    for (uint32_t i = 0; i < result.mipLevels; i++)
+    {
+        if (i > 0)
+        {
+            level = VulkanTexture::downsample(i == 1 ? data : level, compressedFormat == VK_FORMAT_BC7_SRGB_BLOCK);
+        }
+        const TextureData& source = i == 0 ? data : level;
+        std::vector<uint8_t> blocks = compressedFormat == VK_FORMAT_BC5_UNORM_BLOCK ? compressBC5(source) : compressBC7(source);
+        result.pixels.insert(result.pixels.end(), blocks.begin(), blocks.end());
+    }
+    return result;
+}
+
+void TextureCompressor::compressModels(const std::string& modelsDirectory)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Albedo maps are color data, bump maps hold normals
+    std::set<std::pair<std::string, VkFormat>> textures;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(modelsDirectory))
+    {
+        std::string path = entry.path().generic_string();
+        if (!entry.is_regular_file() || (entry.path().extension() != ".obj" && !GltfLoader::isGltfPath(path)))
+        {
+            continue;
+        }
+
+        ModelInfo model = ModelImporter::import(path);
+        for (const PBRMaterialInfo& material : model.materials)
+        {
+            if (!material.albedoTexture.empty()) textures.emplace(material.albedoTexture, VK_FORMAT_R8G8B8A8_SRGB);
+            if (!material.bumpTexture.empty()) textures.emplace(material.bumpTexture, VK_FORMAT_R8G8B8A8_UNORM);
+        }
+    }
+
+    std::vector<std::pair<std::string, VkFormat>> work(textures.begin(), textures.end());
+    std::atomic<size_t> failed = 0;
+    ThreadPool::getShared().parallelFor(work.size(), [&](size_t i)
+    {
+        try
+        {
+            VulkanTexture::load(work[i].first, work[i].second);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Could not compress " + work[i].first + ": " + e.what() + "\n";
+            failed++;
+        }
+    });
+
+    float elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+    std::cout << "Compressed " << work.size() - failed << " textures in " << elapsed << " s" << std::endl;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "VulkanTexture.hpp"
+
+/// <summary>
+/// CPU transcoder from decoded RGBA8 images to GPU block compressed mip chains: BC7 for color, BC5 for normal maps.
+/// BC7 blocks use mode 6, a single RGBA subset with 4 bit indices, fitted along the principal axis of the block colors and
+/// refined by least squares. BC5 stores the red and green channels as two BC4 blocks, the shaders rebuild z.
+/// Levels are built with VulkanTexture::downsample then compressed, rows of blocks in parallel.
+/// </summary>
+class TextureCompressor
+{
+public:
+    static constexpr size_t BLOCK_BYTES = 16; // BC5 and BC7 blocks both cover 4x4 texels
+
+    static std::vector<uint8_t> compressBC7(const TextureData& level);
+    static std::vector<uint8_t> compressBC5(const TextureData& level);
+
+    /// <summary>
+    /// Full mip chain of the image in the given block format, BC7 or BC5, levels packed from largest to smallest.
+    /// </summary>
+    static TextureData compress(const TextureData& data, VkFormat compressedFormat);
+
+    // Bytes of one level of a block compressed image
+    static size_t getLevelSize(uint32_t width, uint32_t height);
+
+    /// <summary>
+    /// Offline pass: imports every model under the directory and transcodes its material textures into the texture cache,
+    /// so the next runs load them without decoding.
+    /// </summary>
+    static void compressModels(const std::string& modelsDirectory);
+};
@@ -1,8 +1,15 @@
 #include "TextureManager.hpp"
+#include <iostream>
+#include "AssetLoader.hpp"
 
 VulkanTexture TextureManager::errorAlbedoTexture = {};
 VulkanTexture TextureManager::errorBumpTexture = {};
 
+std::mutex TextureManager::mutex;
+std::unordered_map<std::string, TextureManager::CacheEntry> TextureManager::cache;
+TextureCacheStatistics TextureManager::statistics;
+std::unordered_map<std::string, AssetHandle<VulkanTexture>> TextureManager::streams;
+
 void TextureManager::loadTextures(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
 {
 	errorAlbedoTexture.init("textures/error/albedo.png", context, commandBufferManager);
@@ -13,4 +20,252 @@ void TextureManager::cleanup(VkDevice device)
 {
 	errorAlbedoTexture.cleanup(device);
 	errorBumpTexture.cleanup(device);
+	streams.clear();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!cache.empty())
+	{
+		std::cerr << "WARNING: " << cache.size() << " cached textures are still referenced at cleanup" << std::endl;
+	}
+}
+
+std::string TextureManager::getKey(const std::string& path, VkFormat format)
+{
+	return std::to_string(static_cast<int>(format)) + "|" + path;
+}
+
+std::shared_ptr<VulkanTexture> TextureManager::find(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = cache.find(key);
+	if (it != cache.end())
+	{
+		if (std::shared_ptr<VulkanTexture> texture = it->second.texture.lock())
+		{
+			statistics.hits++;
+			statistics.bytesSaved += it->second.bytes;
+			return texture;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<VulkanTexture> TextureManager::acquire(const std::string& key, const VulkanContext& context, const std::function<uint64_t(VulkanTexture&)>& create)
+{
+	if (std::shared_ptr<VulkanTexture> texture = find(key))
+	{
+		return texture;
+	}
+
+	// Uploads go through the graphics queue, the lock is not held meanwhile
+	VulkanTexture* created = new VulkanTexture();
+	uint64_t bytes;
+	try
+	{
+		bytes = create(*created);
+	}
+	catch (...)
+	{
+		delete created;
+		throw;
+	}
+	return insert(key, created, bytes, context.device);
+}
+
+std::shared_ptr<VulkanTexture> TextureManager::insert(const std::string& key, VulkanTexture* created, uint64_t bytes, VkDevice device)
+{
+	// The last handle destroys the GPU texture and drops the entry, unless it was replaced in between
+	std::shared_ptr<VulkanTexture> texture(created, [key, device](VulkanTexture* released)
+	{
+		released->cleanup(device);
+		delete released;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = cache.find(key);
+		if (it != cache.end() && it->second.texture.expired())
+		{
+			statistics.residentTextures--;
+			statistics.residentBytes -= it->second.bytes;
+			cache.erase(it);
+		}
+	});
+
+	std::lock_guard<std::mutex> lock(mutex);
+	statistics.misses++;
+	statistics.residentTextures++;
+	statistics.residentBytes += bytes;
+	cache[key] = { texture, bytes };
+	return texture;
+}
+
+std::shared_ptr<VulkanTexture> TextureManager::acquire(const std::string& path, VkFormat format, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const TextureData* decoded)
+{
+	return acquire(getKey(path, format), context, [&](VulkanTexture& texture)
+	{
+		if (!isUsable(decoded, format))
+		{
+			decoded = nullptr;
+		}
+
+		TextureData data;
+		if (!decoded)
+		{
+			data = VulkanTexture::load(path, format);
+			decoded = &data;
+		}
+		texture.init(*decoded, context, commandBufferManager, format);
+		return getResidentBytes(*decoded);
+	});
+}
+
+AcquiredTextures TextureManager::acquireBatch(const std::vector<TextureBatchEntry>& entries, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const DecodedTextures* decodedTextures)
+{
+	// Cache hits, then one load per missing file and format
+	AcquiredTextures textures;
+	std::vector<TextureBatchEntry> undecoded;
+	std::vector<std::pair<TextureBatchEntry, const TextureData*>> missing;
+	for (const TextureBatchEntry& entry : entries)
+	{
+		auto [it, inserted] = textures.try_emplace({ entry.path, entry.format });
+		if (!inserted) continue;
+		it->second = find(getKey(entry.path, entry.format));
+		if (it->second) continue;
+
+		const TextureData* decoded = nullptr;
+		if (decodedTextures)
+		{
+			auto decodedIt = decodedTextures->find(entry.path);
+			if (decodedIt != decodedTextures->end() && isUsable(&decodedIt->second, entry.format))
+			{
+				decoded = &decodedIt->second;
+			}
+		}
+		if (decoded)
+		{
+			missing.emplace_back(entry, decoded);
+		}
+		else
+		{
+			undecoded.push_back(entry);
+		}
+	}
+
+	// Files that fail to load are left to acquire, which reports them
+	TextureBatchStatistics batchStatistics;
+	std::vector<std::string> errors;
+	std::vector<TextureData> data = TextureBatchLoader::decode(undecoded, errors, batchStatistics);
+	for (size_t i = 0; i < undecoded.size(); i++)
+	{
+		if (errors[i].empty())
+		{
+			missing.emplace_back(undecoded[i], &data[i]);
+		}
+	}
+
+	if (!missing.empty())
+	{
+		std::vector<TextureBatchUpload> uploads;
+		for (const auto& [entry, decoded] : missing)
+		{
+			uploads.push_back({ new VulkanTexture(), decoded, entry.format });
+		}
+		try
+		{
+			TextureBatchLoader::upload(uploads, context, commandBufferManager, batchStatistics);
+		}
+		catch (...)
+		{
+			for (const TextureBatchUpload& upload : uploads)
+			{
+				delete upload.texture;
+			}
+			throw;
+		}
+
+		for (size_t i = 0; i < missing.size(); i++)
+		{
+			const TextureBatchEntry& entry = missing[i].first;
+			textures[{ entry.path, entry.format }] = insert(getKey(entry.path, entry.format), uploads[i].texture, getResidentBytes(*missing[i].second), context.device);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics.batches.decodedTextures += batchStatistics.decodedTextures;
+		statistics.batches.decodedBytes += batchStatistics.decodedBytes;
+		statistics.batches.decodeMs += batchStatistics.decodeMs;
+		statistics.batches.uploadedTextures += batchStatistics.uploadedTextures;
+		statistics.batches.uploadedBytes += batchStatistics.uploadedBytes;
+		statistics.batches.uploadMs += batchStatistics.uploadMs;
+	}
+
+	std::erase_if(textures, [](const auto& entry) { return entry.second == nullptr; });
+	return textures;
+}
+
+bool TextureManager::isUsable(const TextureData* decoded, VkFormat format)
+{
+	// A file decoded for another use, like a color map also used as a normal map, has another block format
+	return decoded && (decoded->compressedFormat == VK_FORMAT_UNDEFINED || decoded->compressedFormat == VulkanTexture::getCompressedFormat(format));
+}
+
+uint64_t TextureManager::getResidentBytes(const TextureData& data)
+{
+	// A decoded image gets its mip chain on the GPU, about a third more
+	bool compressed = data.compressedFormat != VK_FORMAT_UNDEFINED;
+	return compressed ? static_cast<uint64_t>(data.pixels.size()) : static_cast<uint64_t>(data.pixels.size()) * 4 / 3;
+}
+
+std::shared_ptr<VulkanTexture> TextureManager::acquireSolidColor(uint8_t r, uint8_t g, uint8_t b, VkFormat format, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
+{
+	std::string color = "#" + std::to_string(r) + "," + std::to_string(g) + "," + std::to_string(b);
+	return acquire(getKey(color, format), context, [&](VulkanTexture& texture)
+	{
+		texture = VulkanTexture::create1x1TextureRGBA(r, g, b, context, commandBufferManager, format);
+		return static_cast<uint64_t>(4);
+	});
+}
+
+AssetHandle<VulkanTexture> TextureManager::stream(const std::string& path, VkFormat format, int priority)
+{
+	// Finished loads are replaced, a released texture is loaded again
+	AssetHandle<VulkanTexture>& handle = streams[getKey(path, format)];
+	if (handle.isDone())
+	{
+		handle = AssetLoader::loadTexture(path, format, priority);
+	}
+	else if (priority > handle.getPriority())
+	{
+		handle.setPriority(priority);
+	}
+	return handle;
+}
+
+void TextureManager::releaseFinishedStreams()
+{
+	std::erase_if(streams, [](const auto& entry) { return entry.second.isDone(); });
+}
+
+bool TextureManager::isResident(const std::string& path, VkFormat format)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = cache.find(getKey(path, format));
+	return it != cache.end() && !it->second.texture.expired();
+}
+
+TextureCacheStatistics TextureManager::getStatistics()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistics;
+}
+
+void TextureManager::printStatistics()
+{
+	TextureCacheStatistics current = getStatistics();
+	std::cout << "Texture cache: " << current.hits << " hits, " << current.misses << " misses, " << current.bytesSaved / (1024 * 1024) << " MB of uploads saved, "
+		<< current.residentTextures << " textures resident (" << current.residentBytes / (1024 * 1024) << " MB)" << std::endl;
+	if (current.batches.uploadedTextures > 0)
+	{
+		TextureBatchLoader::printStatistics(current.batches);
+	}
 }
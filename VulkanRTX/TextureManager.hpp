@@ -1,11 +1,81 @@
 #pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "AssetHandle.hpp"
+#include "TextureBatchLoader.hpp"
 #include "VulkanTexture.hpp"
 
+struct TextureCacheStatistics
+{
+	size_t hits = 0;
+	size_t misses = 0;
+	uint64_t bytesSaved = 0; // Uploads avoided by hits
+	size_t residentTextures = 0;
+	uint64_t residentBytes = 0;
+	TextureBatchStatistics batches; // Decodes and uploads of acquireBatch
+};
+
+/// <summary>
+/// Error textures, and the cache of material textures. Textures are keyed by path and format and handed out as shared
+/// handles; the GPU texture is destroyed when the last handle is released. Handles must be released before the device is.
+/// </summary>
 class TextureManager
 {
+private:
+	struct CacheEntry
+	{
+		std::weak_ptr<VulkanTexture> texture;
+		uint64_t bytes = 0;
+	};
+
+	static std::mutex mutex;
+	static std::unordered_map<std::string, CacheEntry> cache;
+	static TextureCacheStatistics statistics;
+	static std::unordered_map<std::string, AssetHandle<VulkanTexture>> streams; // Background loads started by stream, main thread only
+
+	static std::shared_ptr<VulkanTexture> acquire(const std::string& key, const VulkanContext& context, const std::function<uint64_t(VulkanTexture&)>& create);
+	static std::shared_ptr<VulkanTexture> find(const std::string& key); // Null when not resident, counts a hit otherwise
+	static std::shared_ptr<VulkanTexture> insert(const std::string& key, VulkanTexture* created, uint64_t bytes, VkDevice device); // Takes ownership of created
+	static std::string getKey(const std::string& path, VkFormat format);
+	static bool isUsable(const TextureData* decoded, VkFormat format);
+	static uint64_t getResidentBytes(const TextureData& data);
+
 public:
 	static VulkanTexture errorAlbedoTexture;
 	static VulkanTexture errorBumpTexture;
 	static void loadTextures(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
 	static void cleanup(VkDevice device);
-};
\ No newline at end of file
+
+	/// <summary>
+	/// Main thread. Returns the cached texture of the file, or uploads it. decoded, when given, is used instead of decoding the file.
+	/// </summary>
+	static std::shared_ptr<VulkanTexture> acquire(const std::string& path, VkFormat format, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const TextureData* decoded = nullptr);
+
+	/// <summary>
+	/// Main thread. acquire for many files at once: the missing ones are taken from decodedTextures or decoded in parallel,
+	/// then uploaded together by the TextureBatchLoader. Files that fail to load are left out, acquire reports them.
+	/// </summary>
+	static AcquiredTextures acquireBatch(const std::vector<TextureBatchEntry>& entries, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const DecodedTextures* decodedTextures = nullptr);
+
+	// Cached 1x1 texture of a constant color, used by materials without a texture
+	static std::shared_ptr<VulkanTexture> acquireSolidColor(uint8_t r, uint8_t g, uint8_t b, VkFormat format, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
+
+	/// <summary>
+	/// Main thread. Loads the texture in the background through the AssetLoader, the handle is ready once it is resident.
+	/// Requests for a file that is already loading share its handle.
+	/// </summary>
+	static AssetHandle<VulkanTexture> stream(const std::string& path, VkFormat format, int priority = 0);
+
+	// Main thread. Forgets finished streams once their materials took the texture, the request then goes with the last handle
+	static void releaseFinishedStreams();
+
+	// Any thread, lets loaders skip decoding files that are already resident
+	static bool isResident(const std::string& path, VkFormat format);
+
+	static TextureCacheStatistics getStatistics();
+	static void printStatistics();
+};
@@ -0,0 +1,126 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include "ImportSettings.hpp"
+
+ThreadPool::ThreadPool(size_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+size_t ThreadPool::getWorkerCount() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if (count == 0) return;
+
+    struct Batch
+    {
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+
+    // Indices are claimed one at a time, helpers that start late simply find nothing left to do.
+    // The job is only touched after a successful claim, so it never outlives this call.
+    auto run = [batch, count, &job]()
+    {
+        size_t i;
+        while ((i = batch->next.fetch_add(1)) < count)
+        {
+            try
+            {
+                job(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                if (!batch->error) batch->error = std::current_exception();
+            }
+
+            if (batch->done.fetch_add(1) + 1 == count)
+            {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&] { return batch->done.load() == count; });
+
+    if (batch->error)
+    {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+    static ThreadPool pool(static_cast<size_t>(std::max(0, ImportSettings::workerCount)));
+    return pool;
+}
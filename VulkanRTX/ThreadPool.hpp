@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    /// <summary>
+    /// Creates a pool with the given number of workers, 0 uses one worker per hardware thread.
+    /// </summary>
+    explicit ThreadPool(size_t workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getWorkerCount() const;
+    void submit(std::function<void()> task);
+
+    /// <summary>
+    /// Runs job(i) for every i in [0, count) and returns once all of them are done.
+    /// The calling thread takes part in the work, so this can be nested inside a job.
+    /// The first exception thrown by a job is rethrown on the calling thread.
+    /// </summary>
+    void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    /// <summary>
+    /// Shared pool used by the asset pipeline, sized from ImportSettings::workerCount on first use.
+    /// </summary>
+    static ThreadPool& getShared();
+};
@@ -1,7 +1,7 @@
 #include "Transform.hpp"
 #include <iostream>
 
-Transform::Transform() : m_position(0.0f), m_rotation(glm::quat_identity<float, glm::defaultp>()), m_scale(1.0f) 
+Transform::Transform() : m_position(0.0f), m_rotation(glm::quat_identity<float, glm::defaultp>()), m_scale(1.0f), m_version(0) 
 {
 
 }
@@ -9,11 +9,13 @@ Transform::Transform() : m_position(0.0f), m_rotation(glm::quat_identity<float,
 void Transform::setPosition(const glm::vec3& position) 
 {
     m_position = position;
+    m_version++;
 }
 
 void Transform::translate(const glm::vec3& delta) 
 {
     m_position += m_rotation * delta;
+    m_version++;
 }
 
 glm::vec3 Transform::getPosition() const 
@@ -25,12 +27,14 @@ void Transform::setRotation(const glm::vec3& eulerDegrees)
 {
     glm::vec3 radians = glm::radians(eulerDegrees);
     m_rotation = glm::quat(radians);
+    m_version++;
 }
 
 void Transform::rotate(const glm::vec3& deltaDegrees) 
 {
     glm::vec3 radians = glm::radians(deltaDegrees);
     m_rotation = glm::normalize(glm::quat(radians) * m_rotation);
+    m_version++;
 }
 
 glm::vec3 Transform::getRotationEuler() const 
@@ -46,11 +50,13 @@ glm::quat Transform::getRotationQuat() const
 void Transform::setScale(const glm::vec3& scale) 
 {
     m_scale = scale;
+    m_version++;
 }
 
 void Transform::scale(const glm::vec3& factor) 
 {
     m_scale *= factor;
+    m_version++;
 }
 
 glm::vec3 Transform::getScale() const 
@@ -72,6 +78,7 @@ void Transform::setTransformMatrix(const glm::mat4& matrix)
     glm::vec4 perspective;
     glm::decompose(matrix, m_scale, m_rotation, m_position, skew, perspective);
     m_rotation = glm::normalize(m_rotation);
+    m_version++;
 }
 
 void Transform::printPosition() const 
@@ -103,4 +110,9 @@ glm::vec3 Transform::getForward() const
 {
     glm::vec3 forward = glm::vec3(0.0f, 0.0f, -1.0f);
     return m_rotation * forward;
+}
+
+uint64_t Transform::getVersion() const
+{
+    return m_version;
 }
\ No newline at end of file
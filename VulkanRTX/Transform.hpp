@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include "GLM_defines.hpp"
 
 class Transform 
@@ -29,8 +30,12 @@ public:
 
     glm::vec3 getForward() const;
 
+    // Incremented by every change, lets dependent data know when to refresh
+    uint64_t getVersion() const;
+
 private:
     glm::vec3 m_position;
     glm::quat m_rotation;
     glm::vec3 m_scale;
+    uint64_t m_version;
 };
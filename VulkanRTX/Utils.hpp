@@ -2,5 +2,9 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 std::vector<char> readFile(const std::string& filename);
+
+// FNV-1a hash of a block of memory
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
@@ -0,0 +1,189 @@
+#include "VertexCompression.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    glm::vec2 octahedralEncode(glm::vec3 v)
+    {
+        float l1 = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+        if (!(l1 > 0.0f))
+        {
+            return glm::vec2(0.0f, 0.0f);
+        }
+        v = v / l1;
+
+        glm::vec2 encoded(v.x, v.y);
+        if (v.z < 0.0f)
+        {
+            encoded.x = (1.0f - std::fabs(v.y)) * (v.x >= 0.0f ? 1.0f : -1.0f);
+            encoded.y = (1.0f - std::fabs(v.x)) * (v.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return encoded;
+    }
+
+    int16_t toSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint32_t toUnorm15(float value)
+    {
+        return static_cast<uint32_t>(std::lround((std::clamp(value, -1.0f, 1.0f) * 0.5f + 0.5f) * 32767.0f));
+    }
+
+    template <typename Vertex>
+    void encodeAttributes(const VulkanVertex& source, Vertex& destination)
+    {
+        destination.normal = VertexCompression::packOctahedralSnorm16(source.normal);
+        destination.tangent = VertexCompression::packTangentFrame(source.normal, source.tangent, source.bitangent);
+        destination.texCoord = VertexCompression::packHalf2(source.texCoord);
+    }
+}
+
+uint32_t VertexCompression::getStride(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Full: return sizeof(VulkanVertex);
+    case VertexFormat::Compact: return sizeof(CompactVertex);
+    case VertexFormat::CompactQuantized: return sizeof(QuantizedVertex);
+    }
+    throw std::invalid_argument("unknown vertex format");
+}
+
+uint32_t VertexCompression::packOctahedralSnorm16(const glm::vec3& direction)
+{
+    glm::vec2 encoded = octahedralEncode(direction);
+    uint16_t x = static_cast<uint16_t>(toSnorm16(encoded.x));
+    uint16_t y = static_cast<uint16_t>(toSnorm16(encoded.y));
+    return uint32_t(x) | (uint32_t(y) << 16);
+}
+
+uint32_t VertexCompression::packTangentFrame(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+{
+    glm::vec2 encoded = octahedralEncode(tangent);
+    bool negativeBitangent = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f;
+    return toUnorm15(encoded.x) | (toUnorm15(encoded.y) << 15) | (negativeBitangent ? 0x80000000u : 0u);
+}
+
+uint16_t VertexCompression::floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (((bits >> 23) & 0xFFu) == 0xFFu)
+    {
+        // Inf / NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+    if (exponent >= 31)
+    {
+        // Overflow, clamp to the largest half
+        return static_cast<uint16_t>(sign | 0x7BFFu);
+    }
+    if (exponent <= 0)
+    {
+        // Denormal or zero
+        if (exponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u)))
+        {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Round to nearest even, a mantissa carry correctly bumps the exponent
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+    {
+        half++;
+    }
+    return static_cast<uint16_t>(std::min(half, sign | 0x7BFFu));
+}
+
+uint32_t VertexCompression::packHalf2(const glm::vec2& value)
+{
+    return uint32_t(floatToHalf(value.x)) | (uint32_t(floatToHalf(value.y)) << 16);
+}
+
+std::vector<uint8_t> VertexCompression::encode(const std::vector<VulkanVertex>& vertices, VertexFormat format, PositionDequantization& dequantization)
+{
+    dequantization = {};
+    std::vector<uint8_t> data(vertices.size() * getStride(format));
+
+    switch (format)
+    {
+    case VertexFormat::Full:
+    {
+        if (!vertices.empty())
+        {
+            std::memcpy(data.data(), vertices.data(), data.size());
+        }
+        break;
+    }
+    case VertexFormat::Compact:
+    {
+        CompactVertex* out = reinterpret_cast<CompactVertex*>(data.data());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            out[i].pos = vertices[i].pos;
+            encodeAttributes(vertices[i], out[i]);
+        }
+        break;
+    }
+    case VertexFormat::CompactQuantized:
+    {
+        glm::vec3 minPos(0.0f);
+        glm::vec3 maxPos(0.0f);
+        if (!vertices.empty())
+        {
+            minPos = maxPos = vertices[0].pos;
+        }
+        for (const VulkanVertex& vertex : vertices)
+        {
+            minPos = glm::min(minPos, vertex.pos);
+            maxPos = glm::max(maxPos, vertex.pos);
+        }
+
+        glm::vec3 center = (minPos + maxPos) * 0.5f;
+        glm::vec3 halfExtent = (maxPos - minPos) * 0.5f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            // Flat axes still need a non zero scale
+            if (!(halfExtent[axis] > 0.0f)) halfExtent[axis] = 1.0f;
+        }
+        dequantization.scale = glm::vec4(halfExtent, 0.0f);
+        dequantization.offset = glm::vec4(center, 0.0f);
+
+        QuantizedVertex* out = reinterpret_cast<QuantizedVertex*>(data.data());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            glm::vec3 local = (vertices[i].pos - center) / halfExtent;
+            out[i].pos[0] = toSnorm16(local.x);
+            out[i].pos[1] = toSnorm16(local.y);
+            out[i].pos[2] = toSnorm16(local.z);
+            out[i].pos[3] = 0;
+            encodeAttributes(vertices[i], out[i]);
+        }
+        break;
+    }
+    }
+
+    return data;
+}
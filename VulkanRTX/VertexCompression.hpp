@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "VertexFormat.hpp"
+#include "VulkanGeometry.hpp"
+
+struct CompactVertex
+{
+    glm::vec3 pos;
+    uint32_t normal;   // Octahedral, 2 x SNORM16
+    uint32_t tangent;  // Octahedral, 2 x 15 bits, bit 31 is set when the bitangent is -cross(normal, tangent)
+    uint32_t texCoord; // 2 x half
+};
+static_assert(sizeof(CompactVertex) == 24);
+
+struct QuantizedVertex
+{
+    int16_t pos[4];    // SNORM16 relative to the mesh bounds, w unused
+    uint32_t normal;
+    uint32_t tangent;
+    uint32_t texCoord;
+};
+static_assert(sizeof(QuantizedVertex) == 20);
+
+// Maps decoded positions back to object space: pos = stored * scale + offset
+struct PositionDequantization
+{
+    glm::vec4 scale = glm::vec4(1.0f);
+    glm::vec4 offset = glm::vec4(0.0f);
+};
+
+namespace VertexCompression
+{
+    uint32_t getStride(VertexFormat format);
+
+    uint32_t packOctahedralSnorm16(const glm::vec3& direction);
+    uint32_t packTangentFrame(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent);
+    uint16_t floatToHalf(float value);
+    uint32_t packHalf2(const glm::vec2& value);
+
+    /// <summary>
+    /// Encodes vertices in the given GPU format. dequantization receives the transform restoring object space positions.
+    /// </summary>
+    std::vector<uint8_t> encode(const std::vector<VulkanVertex>& vertices, VertexFormat format, PositionDequantization& dequantization);
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// Layout of the vertices uploaded to the GPU, the CPU side always keeps full VulkanVertex data
+enum class VertexFormat : uint32_t
+{
+    Full = 0,             // VulkanVertex, 56 bytes
+    Compact = 1,          // fp32 position, octahedral normal, octahedral tangent + sign, half UVs, 24 bytes
+    CompactQuantized = 2  // Same as Compact with SNORM16 positions relative to the mesh bounds, 20 bytes
+};
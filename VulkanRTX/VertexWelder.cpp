@@ -0,0 +1,154 @@
+#include "VertexWelder.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    uint32_t floatBits(float value)
+    {
+        // Adding 0 turns -0 into +0, so values equal by == share the same bits
+        value += 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    uint64_t mix(uint64_t hash, uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    uint64_t finalize(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    int64_t snap(float value, float step)
+    {
+        if (step <= 0.0f)
+        {
+            return floatBits(value);
+        }
+        return static_cast<int64_t>(std::floor(static_cast<double>(value) / step + 0.5));
+    }
+}
+
+VertexWelder::VertexWelder(std::vector<VulkanVertex>& vertices, size_t expectedCount, const WeldTolerance& tolerance)
+    : vertices(vertices), tolerance(tolerance)
+{
+    useEpsilon = tolerance.position > 0.0f || tolerance.normal > 0.0f || tolerance.texCoord > 0.0f;
+
+    // Keep the load factor under 1/2
+    size_t capacity = std::bit_ceil(std::max<size_t>(16, std::max(expectedCount, vertices.size()) * 2));
+    rehash(capacity);
+}
+
+VertexWelder::QuantizedKey VertexWelder::quantize(const VulkanVertex& vertex) const
+{
+    return
+    {
+        snap(vertex.pos.x, tolerance.position),
+        snap(vertex.pos.y, tolerance.position),
+        snap(vertex.pos.z, tolerance.position),
+        snap(vertex.normal.x, tolerance.normal),
+        snap(vertex.normal.y, tolerance.normal),
+        snap(vertex.normal.z, tolerance.normal),
+        snap(vertex.texCoord.x, tolerance.texCoord),
+        snap(vertex.texCoord.y, tolerance.texCoord)
+    };
+}
+
+size_t VertexWelder::hashVertex(const VulkanVertex& vertex) const
+{
+    uint64_t hash = 0;
+    hash = mix(hash, (uint64_t(floatBits(vertex.pos.x)) << 32) | floatBits(vertex.pos.y));
+    hash = mix(hash, (uint64_t(floatBits(vertex.pos.z)) << 32) | floatBits(vertex.texCoord.x));
+    hash = mix(hash, (uint64_t(floatBits(vertex.texCoord.y)) << 32) | floatBits(vertex.normal.x));
+    hash = mix(hash, (uint64_t(floatBits(vertex.normal.y)) << 32) | floatBits(vertex.normal.z));
+    return static_cast<size_t>(finalize(hash));
+}
+
+size_t VertexWelder::hashKey(const QuantizedKey& key) const
+{
+    uint64_t hash = 0;
+    for (int64_t value : key)
+    {
+        hash = mix(hash, static_cast<uint64_t>(value));
+    }
+    return static_cast<size_t>(finalize(hash));
+}
+
+void VertexWelder::rehash(size_t capacity)
+{
+    slots.assign(capacity, EMPTY_SLOT);
+    mask = capacity - 1;
+
+    if (useEpsilon && keys.size() < vertices.size())
+    {
+        keys.reserve(vertices.size());
+        for (size_t i = keys.size(); i < vertices.size(); i++)
+        {
+            keys.push_back(quantize(vertices[i]));
+        }
+    }
+
+    // Vertices already in the list are unique, no need to compare them
+    for (uint32_t index = 0; index < vertices.size(); index++)
+    {
+        size_t slot = (useEpsilon ? hashKey(keys[index]) : hashVertex(vertices[index])) & mask;
+        while (slots[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = index;
+    }
+}
+
+uint32_t VertexWelder::weld(const VulkanVertex& vertex)
+{
+    if ((vertices.size() + 1) * 2 > slots.size())
+    {
+        rehash(slots.size() * 2);
+    }
+
+    QuantizedKey key;
+    size_t slot;
+    if (useEpsilon)
+    {
+        key = quantize(vertex);
+        slot = hashKey(key) & mask;
+    }
+    else
+    {
+        slot = hashVertex(vertex) & mask;
+    }
+
+    // Single linear probe: stops on the matching vertex or on the free slot where it gets inserted
+    while (true)
+    {
+        uint32_t index = slots[slot];
+        if (index == EMPTY_SLOT)
+        {
+            index = static_cast<uint32_t>(vertices.size());
+            slots[slot] = index;
+            vertices.push_back(vertex);
+            if (useEpsilon)
+            {
+                keys.push_back(key);
+            }
+            return index;
+        }
+
+        if (useEpsilon ? keys[index] == key : vertices[index] == vertex)
+        {
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "VulkanGeometry.hpp"
+
+struct WeldTolerance
+{
+    float position = 0.0f;
+    float normal = 0.0f;
+    float texCoord = 0.0f;
+};
+
+/// <summary>
+/// Deduplicates vertices while a mesh is being built, using an open-addressing table sized up front.
+/// Exact mode merges vertices equal by operator== (position, texCoord, normal).
+/// Epsilon mode snaps the same attributes to a grid of the given tolerance and merges vertices falling in the same cell.
+/// </summary>
+class VertexWelder
+{
+private:
+    using QuantizedKey = std::array<int64_t, 8>;
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    std::vector<VulkanVertex>& vertices;
+    std::vector<uint32_t> slots; // Index into vertices, EMPTY_SLOT when free
+    std::vector<QuantizedKey> keys; // Epsilon mode only, one key per welded vertex
+    size_t mask = 0;
+
+    bool useEpsilon = false;
+    WeldTolerance tolerance;
+
+    QuantizedKey quantize(const VulkanVertex& vertex) const;
+    size_t hashVertex(const VulkanVertex& vertex) const;
+    size_t hashKey(const QuantizedKey& key) const;
+    void rehash(size_t capacity);
+
+public:
+    /// <summary>
+    /// vertices receives the unique vertices, expectedCount is the number of corners that will be welded.
+    /// </summary>
+    VertexWelder(std::vector<VulkanVertex>& vertices, size_t expectedCount, const WeldTolerance& tolerance = {});
+
+    /// <summary>
+    /// Returns the index of the vertex, adding it to the vertex list if no matching vertex was welded yet.
+    /// </summary>
+    uint32_t weld(const VulkanVertex& vertex);
+};
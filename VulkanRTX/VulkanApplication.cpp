@@ -6,8 +6,11 @@
 #include "VulkanTLAS.hpp"
 #include "Scene.hpp"
 #include "RunTimeSettings.hpp"
+#include "ImportSettings.hpp"
 #include "DescriptorSetLayoutManager.hpp"
 #include "TextureManager.hpp"
+#include "AssetLoader.hpp"
+#include <unordered_set>
 
 void VulkanApplication::handleWindowResize(const WindowResizeEvent& e)
 {
@@ -31,14 +34,16 @@ void VulkanApplication::handleWindowResize(const WindowResizeEvent& e)
 
 void VulkanApplication::run()
 {
+    startTime = std::chrono::high_resolution_clock::now();
     inputManager.init();
     windowManager.init();
 
-    camera.setPerspective(60, GLFW_WINDOW_WIDTH / (float) GLFW_WINDOW_HEIGHT, 0.1, 100.0f);
+    const CameraDescription& sceneCamera = Scene::getCamera();
+    camera.setPerspective(sceneCamera.fov, GLFW_WINDOW_WIDTH / (float) GLFW_WINDOW_HEIGHT, sceneCamera.nearPlane, sceneCamera.farPlane);
     controls = new CreativeControls(camera, 10.0, 100);
     //camera.transform.setRotation(glm::vec3(0, 0, 180));
     //camera.transform.setPosition(glm::vec3(0.312806, 6.96612, -0.113628));
-    camera.transform.setTransformMatrix(glm::inverse(glm::lookAt(glm::vec3(0, 0, -5), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0))));
+    camera.transform.setTransformMatrix(glm::inverse(glm::lookAt(sceneCamera.position, sceneCamera.target, glm::vec3(0, 1, 0))));
     camera.transform.setScale(glm::vec3(1));
 
     EventManager::get().sink<WindowResizeEvent>().connect <&VulkanApplication::handleWindowResize>(this);
@@ -75,17 +80,23 @@ void VulkanApplication::initVulkan()
     // Swapchain ressources
     swapChainManager.createFramebuffers(context, graphicsPipelineManager.lightingPipeline.getRenderPass());
     
-    Scene::fetchModels();
-    
-    graphicsPipelineManager.createDescriptorPool(context, Scene::getModelCount(), Scene::getMeshCount(), FULLSCREEN_QUAD_COUNT);
+    if (ImportSettings::progressiveLoading)
+    {
+        // Models are uploaded between frames as they are imported, with their own descriptor pools
+        graphicsPipelineManager.createDescriptorPool(context, 0, 0, FULLSCREEN_QUAD_COUNT);
+        Scene::beginLoading(context);
+    }
+    else
+    {
+        Scene::fetchModels();
 
-    Scene::loadModels(context, commandBufferManager, graphicsPipelineManager.descriptorPool);
+        graphicsPipelineManager.createDescriptorPool(context, Scene::getModelCount(), Scene::getMeshCount(), FULLSCREEN_QUAD_COUNT);
 
-    // Create TLAS
-    sceneTLAS.createTLAS(context, Scene::getModels(), commandBufferManager);
+        Scene::loadModels(context, commandBufferManager, graphicsPipelineManager.descriptorPool);
 
-    // Setup RT pipeline with scene info
-    graphicsPipelineManager.rtPipeline.writeDescriptors(context, commandBufferManager, Scene::getModels(), sceneTLAS.getTLAS(), graphicsPipelineManager.gBufferManager.depthImageView, graphicsPipelineManager.gBufferManager.normalImageView, graphicsPipelineManager.gBufferManager.albedoImageView);
+        updateRayTracingScene();
+        graphicsPipelineManager.rtPipeline.printSceneStatistics();
+    }
 
     // Init fullscreen quad
     fullScreenQuad.init(context, commandBufferManager, 
@@ -152,6 +163,11 @@ void VulkanApplication::handleInputs()
         RunTimeSettings::rt_recursion_depth = std::clamp(RunTimeSettings::rt_recursion_depth, 0, RT_MAX_RECURSION_DEPTH);
         std::cout << "RT recursion depth: " << RunTimeSettings::rt_recursion_depth << std::endl;
     }
+    if (inputManager.isKeyJustPressed(KeyboardKey::M))
+    {
+        RunTimeSettings::rasterLod = (RunTimeSettings::rasterLod + 1) % (ImportSettings::lodCount + 1);
+        std::cout << "Raster LOD: " << RunTimeSettings::rasterLod << std::endl;
+    }
     if (inputManager.isKeyPressed(KeyboardKey::N))
     {
         Time::resetFrameCount();
@@ -193,11 +209,31 @@ void VulkanApplication::mainLoop()
             inputManager.retrieveInputs(windowManager.getWindow());
             handleInputs();
 
+            AssetLoader::update(context, commandBufferManager);
+            if (Scene::isLoading())
+            {
+                updateSceneLoading();
+            }
+            if (Scene::hasStreamedTextures())
+            {
+                updateStreamedTextures();
+            }
+
             Scene::update();
             renderer.drawFrame(nativeWidth, nativeHeight, scaledWidth, scaledHeight, windowManager.getWindow(), context, swapChainManager, graphicsPipelineManager, commandBufferManager, camera, Scene::getModels(), fullScreenQuad);
+            if (!firstFramePresented)
+            {
+                firstFramePresented = true;
+                float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+                std::cout << "First frame after " << elapsed << " ms, " << Scene::getModels().size() << " models resident" << std::endl;
+            }
            
             Time::update();
             updateFPS();
+            if (benchmarkFrames > 0)
+            {
+                updateRayBenchmark();
+            }
         }
         catch (std::exception e)
         {
@@ -209,6 +245,44 @@ void VulkanApplication::mainLoop()
     vkDeviceWaitIdle(context.device);
 }
 
+void VulkanApplication::updateSceneLoading()
+{
+    if (Scene::uploadLoadedModels(context, commandBufferManager))
+    {
+        // Frames in flight may still read the previous TLAS and ray tracing buffers
+        vkDeviceWaitIdle(context.device);
+        updateRayTracingScene();
+        Time::resetFrameCount();
+    }
+
+    // Printed once, by the call that finished loading
+    if (!Scene::isLoading() && graphicsPipelineManager.rtPipeline.hasScene())
+    {
+        graphicsPipelineManager.rtPipeline.printSceneStatistics();
+    }
+}
+
+void VulkanApplication::updateStreamedTextures()
+{
+    // Frames in flight may still read the material descriptors
+    vkDeviceWaitIdle(context.device);
+    Scene::applyStreamedTextures(context);
+    if (graphicsPipelineManager.rtPipeline.hasScene())
+    {
+        graphicsPipelineManager.rtPipeline.updateMaterialTextures(context);
+    }
+    Time::resetFrameCount();
+}
+
+void VulkanApplication::updateRayTracingScene()
+{
+    sceneTLAS.cleanup(context);
+    sceneTLAS.createTLAS(context, Scene::getModels(), commandBufferManager);
+
+    // Setup RT pipeline with scene info
+    graphicsPipelineManager.rtPipeline.writeDescriptors(context, commandBufferManager, Scene::getModels(), sceneTLAS.getTLAS(), graphicsPipelineManager.gBufferManager.depthImageView, graphicsPipelineManager.gBufferManager.normalImageView, graphicsPipelineManager.gBufferManager.albedoImageView);
+}
+
 void VulkanApplication::updateFPS()
 {
     static int frameCount = 0;
@@ -230,6 +304,45 @@ void VulkanApplication::updateFPS()
     }
 }
 
+void VulkanApplication::setRayBenchmark(int frames)
+{
+    benchmarkFrames = frames;
+}
+
+void VulkanApplication::updateRayBenchmark()
+{
+    // Skip the first frames, they include pipeline and cache warm up
+    constexpr int WARMUP_FRAMES = 16;
+    RunTimeSettings::displayRayTracing = true;
+    benchmarkFrameIndex++;
+    if (benchmarkFrameIndex <= WARMUP_FRAMES)
+    {
+        return;
+    }
+
+    benchmarkTraceTime += renderer.lastTraceTime;
+    int measuredFrames = benchmarkFrameIndex - WARMUP_FRAMES;
+    if (measuredFrames < benchmarkFrames)
+    {
+        return;
+    }
+
+    std::unordered_set<const VulkanModelAsset*> blases;
+    for (const VulkanModel& model : Scene::getModels())
+    {
+        blases.insert(model.asset.get());
+    }
+
+    uint32_t width = graphicsPipelineManager.rtPipeline.getStorageImageWidth();
+    uint32_t height = graphicsPipelineManager.rtPipeline.getStorageImageHeight();
+    double primaryRays = static_cast<double>(width) * height * RunTimeSettings::spp * measuredFrames;
+    std::cout << "Ray benchmark, " << (ImportSettings::mergeStaticModels ? "merged" : "instanced") << " static layout: "
+        << Scene::getModels().size() << " TLAS instances, " << blases.size() << " BLAS, "
+        << width << "x" << height << " at " << RunTimeSettings::spp << " spp, depth " << RunTimeSettings::rt_recursion_depth << ": "
+        << primaryRays / benchmarkTraceTime / 1e6 << " Mrays/s primary, " << benchmarkTraceTime / measuredFrames * 1000.0 << " ms per frame" << std::endl;
+    benchmarkFinished = true;
+}
+
 void VulkanApplication::handleResize()
 {
     swapChainManager.framebufferResized = true;
@@ -237,6 +350,10 @@ void VulkanApplication::handleResize()
 
 bool VulkanApplication::shouldTerminate() const
 {
+    if (benchmarkFinished)
+    {
+        return true;
+    }
     if (inputManager.isKeyPressed(KeyboardKey::Escape))
     {
         return true;
@@ -256,6 +373,7 @@ void VulkanApplication::cleanup()
     EventManager::get().sink<WindowResizeEvent>().disconnect<&VulkanApplication::handleWindowResize>(this);
     inputManager.cleanup();
     swapChainManager.cleanup(context.device);
+    AssetLoader::cleanup();
     Scene::cleanup(context.device);
     fullScreenQuad.cleanup(context.device);
     graphicsPipelineManager.cleanup(context.device);
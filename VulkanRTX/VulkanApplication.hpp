@@ -34,13 +34,26 @@ private:
     VulkanRenderer renderer;
 
     std::chrono::time_point<std::chrono::high_resolution_clock> lastTime;
+    std::chrono::time_point<std::chrono::high_resolution_clock> startTime; // Time to first frame is measured from here
+    bool firstFramePresented = false;
 
     int nativeWidth, nativeHeight;
     int scaledWidth, scaledHeight;
 
+    // Ray tracing benchmark, 0 frames = interactive
+    int benchmarkFrames = 0;
+    int benchmarkFrameIndex = 0;
+    double benchmarkTraceTime = 0.0;
+    bool benchmarkFinished = false;
+
 public:
     void run();
 
+    /// <summary>
+    /// Traces the given number of frames after a warm up, prints the primary rays per second of the scene layout and exits.
+    /// </summary>
+    void setRayBenchmark(int frames);
+
     void handleResize();
 
     bool shouldTerminate() const;
@@ -56,5 +69,15 @@ private:
 
     void updateFPS();
 
+    void updateRayBenchmark();
+
+    // Uploads the models loaded in the background and rebuilds the TLAS and ray tracing descriptors when some were added
+    void updateSceneLoading();
+
+    // Binds the material textures streamed in since the last frame, in the raster material sets and the ray tracing textures
+    void updateStreamedTextures();
+
+    void updateRayTracingScene();
+
     void cleanup();
 };
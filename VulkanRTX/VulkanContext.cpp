@@ -5,6 +5,7 @@
 #include "VulkanSwapChainManager.hpp"
 #include <regex>
 #include "VulkanExtensionFunctions.hpp"
+#include "ImportSettings.hpp"
 
 bool QueueFamilyIndices::isComplete()
 {
@@ -249,9 +250,13 @@ void VulkanContext::createLogicalDevice()
     validationFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_VALIDATION_FEATURES_NV;
     validationFeatures.pNext = nullptr;
 
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    descriptorIndexingFeatures.pNext = &validationFeatures;
+
     VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
     bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-    bufferDeviceAddressFeatures.pNext = &validationFeatures;
+    bufferDeviceAddressFeatures.pNext = &descriptorIndexingFeatures;
 
     VkPhysicalDeviceRayTracingPipelineFeaturesKHR rayTracingPipelineFeatures{};
     rayTracingPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
@@ -282,16 +287,32 @@ void VulkanContext::createLogicalDevice()
     {
         throw std::runtime_error("Buffer device address feature not supported!");
     }
+    if (!descriptorIndexingFeatures.runtimeDescriptorArray || !descriptorIndexingFeatures.descriptorBindingPartiallyBound ||
+        !descriptorIndexingFeatures.descriptorBindingVariableDescriptorCount || !descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing)
+    {
+        throw std::runtime_error("Descriptor indexing features not supported!");
+    }
     if (!validationFeatures.rayTracingValidation)
     {
         std::cerr << "RT validation features are not available." << std::endl;
     }
+    if (!deviceFeatures2.features.textureCompressionBC && ImportSettings::compressTextures)
+    {
+        std::cerr << "BC texture compression is not supported, textures are uploaded uncompressed." << std::endl;
+        ImportSettings::compressTextures = false;
+    }
 
     // Enable required features after validation
     accelerationStructureFeatures.accelerationStructure = VK_TRUE;
     rayTracingPipelineFeatures.rayTracingPipeline = VK_TRUE;
     bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
 
+    // The material texture array of the ray tracing set is sized from the scene
+    descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+    descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
     // Only enable RT validation if supported and environment variable is set
     if (validationFeatures.rayTracingValidation && rtValidationEnabled)
     {
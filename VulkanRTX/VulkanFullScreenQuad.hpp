@@ -6,6 +6,7 @@
 struct VulkanFullScreenQuadUBO
 {
 	float time;
+	alignas(16) glm::vec4 sunDirection;
 };
 
 class VulkanFullScreenQuad
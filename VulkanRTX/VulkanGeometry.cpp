@@ -1,24 +1,54 @@
 #include "VulkanGeometry.hpp"
 #include "Vulkan_GLFW.hpp"
 #include "GLM_defines.hpp"
+#include "VertexCompression.hpp"
 
 bool VulkanVertex::operator==(const VulkanVertex& other) const
 {
     return pos == other.pos && texCoord == other.texCoord && normal == other.normal;
 }
 
-VkVertexInputBindingDescription VulkanVertex::getBindingDescription()
+VkVertexInputBindingDescription VulkanVertex::getBindingDescription(VertexFormat format)
 {
     VkVertexInputBindingDescription bindingDescription{};
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(VulkanVertex);
+    bindingDescription.stride = VertexCompression::getStride(format);
     bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
     return bindingDescription;
 }
 
-std::array<VkVertexInputAttributeDescription, 5> VulkanVertex::getAttributeDescriptions()
+std::vector<VkVertexInputAttributeDescription> VulkanVertex::getAttributeDescriptions(VertexFormat format)
 {
-    std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{};
+    if (format != VertexFormat::Full)
+    {
+        // Locations match the COMPACT_VERTEX input of geometry_vert.slang
+        bool quantized = format == VertexFormat::CompactQuantized;
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = quantized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[0].offset = quantized ? offsetof(QuantizedVertex, pos) : offsetof(CompactVertex, pos);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+        attributeDescriptions[1].offset = quantized ? offsetof(QuantizedVertex, texCoord) : offsetof(CompactVertex, texCoord);
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+        attributeDescriptions[2].offset = quantized ? offsetof(QuantizedVertex, normal) : offsetof(CompactVertex, normal);
+
+        attributeDescriptions[3].binding = 0;
+        attributeDescriptions[3].location = 3;
+        attributeDescriptions[3].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[3].offset = quantized ? offsetof(QuantizedVertex, tangent) : offsetof(CompactVertex, tangent);
+
+        return attributeDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(5);
 
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
@@ -55,11 +85,10 @@ namespace std
         size_t h1 = hash<glm::vec3>()(vertex.pos);
         size_t h2 = hash<glm::vec2>()(vertex.texCoord);
         size_t h3 = hash<glm::vec3>()(vertex.normal);
-        size_t h4 = hash<glm::vec3>()(vertex.tangent);
 
+        // Only hash the attributes compared by operator==
         size_t combined = h1 ^ (h2 << 1);
         combined = (combined >> 1) ^ (h3 << 1);
-        combined = (combined >> 1) ^ (h4 << 1);
 
         return combined;
     }
@@ -3,6 +3,8 @@
 #include "GLM_defines.hpp"
 #include "Vulkan_GLFW.hpp"
 #include <array>
+#include <vector>
+#include "VertexFormat.hpp"
 
 struct VulkanVertex
 {
@@ -14,9 +16,9 @@ struct VulkanVertex
 
     bool operator==(const VulkanVertex& other) const;
 
-    static VkVertexInputBindingDescription getBindingDescription();
+    static VkVertexInputBindingDescription getBindingDescription(VertexFormat format = VertexFormat::Full);
 
-    static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions();
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(VertexFormat format = VertexFormat::Full);
 };
 
 namespace std
@@ -1,8 +1,10 @@
 #include "VulkanGeometryPipeline.hpp"
 #include <stdexcept>
+#include <algorithm>
 #include "Utils.hpp"
 #include "DescriptorSetLayoutManager.hpp"
 #include "RunTimeSettings.hpp"
+#include "ImportSettings.hpp"
 #include <iostream>
 
 void VulkanGeometryPipeline::init(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, int width, int height, const VulkanGBufferManager& gBufferManager)
@@ -116,7 +118,14 @@ void VulkanGeometryPipeline::createPipelineLayouts(const VulkanContext& context)
     geometryPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     geometryPipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(geometryDescriptorSetLayouts.size());
     geometryPipelineLayoutInfo.pSetLayouts = geometryDescriptorSetLayouts.data();
-    geometryPipelineLayoutInfo.pushConstantRangeCount = 0;
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GeometryPushConstants);
+
+    geometryPipelineLayoutInfo.pushConstantRangeCount = 1;
+    geometryPipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     if (vkCreatePipelineLayout(context.device, &geometryPipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
     {
@@ -126,7 +135,9 @@ void VulkanGeometryPipeline::createPipelineLayouts(const VulkanContext& context)
 
 void VulkanGeometryPipeline::createPipeline(const VulkanContext& context)
 {
-    std::vector<char> vertShaderCode = readFile("shaders/geometry_vert.spv");
+    // Meshes encode their vertices with the import setting, the pipeline has to match it
+    vertexFormat = ImportSettings::vertexFormat;
+    std::vector<char> vertShaderCode = readFile(vertexFormat == VertexFormat::Full ? "shaders/geometry_vert.spv" : "shaders/geometry_vert_compact.spv");
     std::vector<char> fragShaderCode = readFile("shaders/geometry_frag.spv");
 
     VkShaderModule vertShaderModule = VulkanUtils::Shaders::createShaderModule(context, vertShaderCode);
@@ -147,8 +158,8 @@ void VulkanGeometryPipeline::createPipeline(const VulkanContext& context)
     VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
     // Define vertex input state
-    VkVertexInputBindingDescription bindingDescription = VulkanVertex::getBindingDescription();
-    std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions = VulkanVertex::getAttributeDescriptions();
+    VkVertexInputBindingDescription bindingDescription = VulkanVertex::getBindingDescription(vertexFormat);
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = VulkanVertex::getAttributeDescriptions(vertexFormat);
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -269,7 +280,17 @@ void VulkanGeometryPipeline::drawMesh(const ShadedMesh& shadedMesh, VkCommandBuf
     VkBuffer vertexBuffers[] = { mesh.vertexBuffer };
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(cmdBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(cmdBuffer, mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(cmdBuffer, mesh.indexBuffer, 0, mesh.indexType);
+
+    if (mesh.vertexFormat != vertexFormat)
+    {
+        throw std::runtime_error("mesh vertex format does not match the geometry pipeline!");
+    }
+
+    GeometryPushConstants pushConstants{};
+    pushConstants.positionScale = mesh.dequantization.scale;
+    pushConstants.positionOffset = mesh.dequantization.offset;
+    vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GeometryPushConstants), &pushConstants);
 
     // Bind material descriptor set for this mesh
     vkCmdBindDescriptorSets(cmdBuffer,
@@ -280,10 +301,12 @@ void VulkanGeometryPipeline::drawMesh(const ShadedMesh& shadedMesh, VkCommandBuf
         &material.descriptorSets[currentFrame],
         0, nullptr);
 
-    // Draw this mesh
+    // Draw the selected LOD, clamped to the coarsest one available
+    size_t lod = std::min(static_cast<size_t>(std::max(RunTimeSettings::rasterLod, 0)), mesh.lodRanges.size() - 1);
+    const MeshLodRange& range = mesh.lodRanges[lod];
     vkCmdDrawIndexed(cmdBuffer,
-        static_cast<uint32_t>(mesh.indices.size()),
-        1, 0, 0, 0);
+        range.indexCount,
+        1, range.firstIndex, 0, 0);
 }
 
 void VulkanGeometryPipeline::recordDrawCommands(int width, int height, const std::vector<VulkanModel>& models, VkCommandBuffer commandBuffer, uint32_t currentFrame)
@@ -343,7 +366,7 @@ void VulkanGeometryPipeline::recordDrawCommands(int width, int height, const std
             0, nullptr);
 
         // Render each submesh
-        for (const ShadedMesh& shadedMesh : model.shadedMeshes)
+        for (const ShadedMesh& shadedMesh : model.asset->shadedMeshes)
         {
             drawMesh(shadedMesh, commandBuffer, currentFrame);
         }
@@ -356,10 +379,16 @@ void VulkanGeometryPipeline::recordDrawCommands(int width, int height, const std
 
 void VulkanGeometryPipeline::drawTBNGizmo(const std::vector<VulkanModel>& models, uint32_t currentFrame, VkCommandBuffer commandBuffer)
 {
+    // Models are still loading
+    if (models.size() < 2)
+    {
+        return;
+    }
+
     const VulkanModel* arrowGizmo = &models.at(0);
 
     const VulkanModel& model = models.at(1);
-    const ShadedMesh& shadedMesh = model.shadedMeshes.at(0);
+    const ShadedMesh& shadedMesh = model.asset->shadedMeshes.at(0);
     int currentVertex = RunTimeSettings::debugIndex1 % shadedMesh.mesh.vertices.size();
     const VulkanVertex& v = shadedMesh.mesh.vertices[currentVertex];
 
@@ -395,7 +424,7 @@ void VulkanGeometryPipeline::drawTBNGizmo(const std::vector<VulkanModel>& models
         &arrowGizmo->modelDescriptorSets[currentFrame],
         0, nullptr);
 
-    for (const ShadedMesh& gizmoShadedMesh : arrowGizmo->shadedMeshes)
+    for (const ShadedMesh& gizmoShadedMesh : arrowGizmo->asset->shadedMeshes)
     {
         drawMesh(gizmoShadedMesh, commandBuffer, currentFrame);
     }
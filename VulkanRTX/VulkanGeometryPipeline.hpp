@@ -5,6 +5,14 @@
 #include "VulkanSwapChainManager.hpp"
 #include "VulkanGBufferManager.hpp"
 #include "VulkanModel.hpp"
+#include "VertexFormat.hpp"
+
+// Restores object space positions of quantized vertices, see PositionDequantization
+struct GeometryPushConstants
+{
+    glm::vec4 positionScale;
+    glm::vec4 positionOffset;
+};
 
 class VulkanGeometryPipeline
 {
@@ -13,6 +21,7 @@ private:
     VkFramebuffer framebuffer;
     VkPipelineLayout pipelineLayout;
     VkPipeline pipeline;
+    VertexFormat vertexFormat;
 
     int width, height;
 
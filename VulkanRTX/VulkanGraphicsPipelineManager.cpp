@@ -14,6 +14,12 @@ void VulkanGraphicsPipelineManager::initPipelines(int nativeWidth, int nativeHei
 
 // TODO: Either use separate pools for models, full screen quad, etc or use this one for ray tracing as well
 void VulkanGraphicsPipelineManager::createDescriptorPool(const VulkanContext& context, size_t modelCount, size_t meshCount, size_t fullScreenQuadCount)
+{
+    std::cout << "Creating descriptor pool with " << (modelCount + meshCount + fullScreenQuadCount) * MAX_FRAMES_IN_FLIGHT << " max sets" << std::endl;
+    descriptorPool = createPool(context, modelCount, meshCount, fullScreenQuadCount);
+}
+
+VkDescriptorPool VulkanGraphicsPipelineManager::createPool(const VulkanContext& context, size_t modelCount, size_t meshCount, size_t fullScreenQuadCount)
 {
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
 
@@ -40,12 +46,13 @@ void VulkanGraphicsPipelineManager::createDescriptorPool(const VulkanContext& co
     // - 1 per material (textures) 
     // - 1 per fullscreen quad (lighting)
     poolInfo.maxSets = static_cast<uint32_t>((modelCount + meshCount + fullScreenQuadCount) * MAX_FRAMES_IN_FLIGHT);
-    
-    std::cout << "Creating descriptor pool with " << poolInfo.maxSets << " max sets" << std::endl;
-    if (vkCreateDescriptorPool(context.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(context.device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create descriptor pool!");
     }
+    return pool;
 }
 
 void VulkanGraphicsPipelineManager::handleResize(int nativeWidth, int nativeHeight, int scaledWidth, int scaledHeight, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
@@ -23,6 +23,11 @@ public:
 public:
     void initPipelines(int nativeWidth, int nativeHeight, int scaledWidth, int scaledHeight, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat swapChainImageFormat);
     void createDescriptorPool(const VulkanContext& context, size_t modelCount, size_t materialCount, size_t fullScreenQuadCount);
+
+    /// <summary>
+    /// Pool for the descriptor sets of the given number of models, meshes and fullscreen quads, for every frame in flight.
+    /// </summary>
+    static VkDescriptorPool createPool(const VulkanContext& context, size_t modelCount, size_t meshCount, size_t fullScreenQuadCount);
     void handleResize(int nativeWidth, int nativeHeight, int scaledWidth, int scaledHeight, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
     void cleanup(VkDevice device);
 };
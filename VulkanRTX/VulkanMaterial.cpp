@@ -2,31 +2,59 @@
 #include "DescriptorSetLayoutManager.hpp"
 #include <stdexcept>
 #include "TextureManager.hpp"
+#include "ImportSettings.hpp"
 #include <iostream>
 
-void VulkanMaterial::init(const PBRMaterialInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, bool hasError)
+void VulkanMaterial::init(const PBRMaterialInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, bool hasError, const AcquiredTextures* acquiredTextures)
 {
+    // Streamed textures get the placeholder until they are resident, cached ones are shared right away
+    auto acquireTexture = [&](const std::string& path, VkFormat format, int priority, AssetHandle<VulkanTexture>& stream, const std::function<std::shared_ptr<VulkanTexture>()>& placeholder)
+    {
+        if (acquiredTextures)
+        {
+            auto it = acquiredTextures->find({ path, format });
+            if (it != acquiredTextures->end())
+            {
+                return it->second;
+            }
+        }
+        if (ImportSettings::streamTextures && !TextureManager::isResident(path, format))
+        {
+            stream = TextureManager::stream(path, format, priority);
+            return placeholder();
+        }
+        return TextureManager::acquire(path, format, context, commandBufferManager);
+    };
+    auto acquireAlbedoColor = [&]()
+    {
+        return TextureManager::acquireSolidColor(static_cast<uint8_t>(info.albedoFactor[0] * 255), static_cast<uint8_t>(info.albedoFactor[1] * 255), static_cast<uint8_t>(info.albedoFactor[2] * 255), VK_FORMAT_R8G8B8A8_SRGB, context, commandBufferManager);
+    };
+    auto acquireFlatBump = [&]()
+    {
+        return TextureManager::acquireSolidColor(128, 128, 255, VK_FORMAT_R8G8B8A8_UNORM, context, commandBufferManager);
+    };
+
     this->hasError = hasError;
     if (!hasError)
     {
-        // Use albedo map only if available
+        // Use albedo map only if available, streamed ahead of the bump map
         if (!info.albedoTexture.empty())
         {
-            albedoMap.init(info.albedoTexture, context, commandBufferManager);
+            albedoMap = acquireTexture(info.albedoTexture, VK_FORMAT_R8G8B8A8_SRGB, 1, albedoStream, acquireAlbedoColor);
         }
         // Otherwise create 1x1 texture with appropriate color
         else
         {
-            albedoMap = VulkanTexture::create1x1TextureRGBA(static_cast<uint8_t>(info.albedoFactor[0] * 255), static_cast<uint8_t>(info.albedoFactor[1] * 255), static_cast<uint8_t>(info.albedoFactor[2] * 255), context, commandBufferManager);
+            albedoMap = acquireAlbedoColor();
         }
         if (!info.bumpTexture.empty())
         {
             // TODO: Use last channel for specular or something ?
-            bumpMap.init(info.bumpTexture, context, commandBufferManager, VK_FORMAT_R8G8B8A8_UNORM); // Use UNORM for vectors
+            bumpMap = acquireTexture(info.bumpTexture, VK_FORMAT_R8G8B8A8_UNORM, 0, bumpStream, acquireFlatBump); // Use UNORM for vectors
         }
         else
         {
-            bumpMap = VulkanTexture::create1x1TextureRGBA(128, 128, 255, context, commandBufferManager, VK_FORMAT_R8G8B8A8_UNORM);
+            bumpMap = acquireFlatBump();
         }
     }
 	createDescriptorSets(context, DescriptorSetLayoutManager::getMaterialLayout(), descriptorPool);
@@ -83,7 +111,11 @@ void VulkanMaterial::createDescriptorSets(const VulkanContext& context, VkDescri
     {
         throw std::runtime_error("failed to allocate material descriptor sets! (material)");
     }
+    writeDescriptorSets(context);
+}
 
+void VulkanMaterial::writeDescriptorSets(const VulkanContext& context)
+{
     // Update descriptor sets with texture data
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
@@ -95,11 +127,11 @@ void VulkanMaterial::createDescriptorSets(const VulkanContext& context, VkDescri
 
         if (!hasError)
         {
-            albedoInfo.imageView = albedoMap.imageView;
-            albedoInfo.sampler = albedoMap.sampler;
+            albedoInfo.imageView = albedoMap->imageView;
+            albedoInfo.sampler = albedoMap->sampler;
 
-            bumpInfo.imageView = bumpMap.imageView;
-            bumpInfo.sampler = bumpMap.sampler;
+            bumpInfo.imageView = bumpMap->imageView;
+            bumpInfo.sampler = bumpMap->sampler;
         }
         else
         {
@@ -136,10 +168,34 @@ void VulkanMaterial::createDescriptorSets(const VulkanContext& context, VkDescri
     }
 }
 
+bool VulkanMaterial::hasStreamedTextures() const
+{
+    return (albedoStream.isValid() && albedoStream.isDone()) || (bumpStream.isValid() && bumpStream.isDone());
+}
+
+void VulkanMaterial::applyStreamedTextures(const VulkanContext& context)
+{
+    // Failed loads were reported by the AssetLoader, the error textures are not owned by the cache
+    auto apply = [](AssetHandle<VulkanTexture>& stream, std::shared_ptr<VulkanTexture>& texture, VulkanTexture& errorTexture)
+    {
+        if (!stream.isValid() || !stream.isDone())
+        {
+            return;
+        }
+        texture = stream.isReady() ? stream.get() : std::shared_ptr<VulkanTexture>(std::shared_ptr<VulkanTexture>(), &errorTexture);
+        stream = AssetHandle<VulkanTexture>();
+    };
+    apply(albedoStream, albedoMap, TextureManager::errorAlbedoTexture);
+    apply(bumpStream, bumpMap, TextureManager::errorBumpTexture);
+    writeDescriptorSets(context);
+}
+
 void VulkanMaterial::cleanup(VkDevice device)
 {
-    // Cleanup albedo texture
-    albedoMap.cleanup(device);
-    bumpMap.cleanup(device);
+    // The cache destroys the textures once no material uses them anymore
+    albedoMap = nullptr;
+    bumpMap = nullptr;
+    albedoStream = AssetHandle<VulkanTexture>();
+    bumpStream = AssetHandle<VulkanTexture>();
     descriptorSets.clear();
 }
\ No newline at end of file
@@ -1,17 +1,38 @@
 #pragma once
+#include <memory>
+#include "AssetHandle.hpp"
 #include "VulkanTexture.hpp"
 #include "ObjLoader.hpp"
 
 class VulkanMaterial
 { 
 public:
-	VulkanTexture albedoMap;
-	VulkanTexture bumpMap;
+	// Shared through the TextureManager cache, null when the material has an error
+	std::shared_ptr<VulkanTexture> albedoMap;
+	std::shared_ptr<VulkanTexture> bumpMap;
 	std::vector<VkDescriptorSet> descriptorSets;
 	bool hasError = false;
 
-	void init(const PBRMaterialInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, bool hasError);
+	// Loads of the textures bound as placeholders until they finish, with ImportSettings::streamTextures
+	AssetHandle<VulkanTexture> albedoStream;
+	AssetHandle<VulkanTexture> bumpStream;
+
+	/// <summary>
+	/// Textures found in acquiredTextures are used as is, the others are acquired here. With ImportSettings::streamTextures,
+	/// textures that are not resident are streamed in.
+	/// </summary>
+	void init(const PBRMaterialInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, bool hasError, const AcquiredTextures* acquiredTextures = nullptr);
 	static VkDescriptorSetLayout createDescriptorSetLayout(const VulkanContext& context);
 	void createDescriptorSets(const VulkanContext& context, VkDescriptorSetLayout geometryDescriptorSetLayout, VkDescriptorPool descriptorPool);
+	void writeDescriptorSets(const VulkanContext& context);
+
+	// Main thread. Whether a streamed texture finished loading, applyStreamedTextures then binds it
+	bool hasStreamedTextures() const;
+
+	/// <summary>
+	/// Replaces the placeholders of the finished streams by their texture, or the error texture when the load failed, and
+	/// rewrites the descriptor sets. They must not be in use.
+	/// </summary>
+	void applyStreamedTextures(const VulkanContext& context);
 	void cleanup(VkDevice device);
 };
\ No newline at end of file
@@ -1,18 +1,36 @@
 #include "VulkanMesh.hpp"
 #include <tiny_obj_loader.h>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 
 #include "VulkanUtils.hpp"
+#include "ImportSettings.hpp"
 
 void VulkanMesh::init(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager)
 {
     VkBufferUsageFlags vertexUsageFlags = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     VkMemoryPropertyFlags vertexMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<VulkanVertex>(context, commandBufferManager, vertices, vertexBuffer, vertexBufferMemory, vertexUsageFlags, vertexMemoryFlags, true);
+    vertexFormat = ImportSettings::vertexFormat;
+    std::vector<uint8_t> encodedVertices = VertexCompression::encode(vertices, vertexFormat, dequantization);
+    VulkanUtils::Buffers::createAndFillBuffer<uint8_t>(context, commandBufferManager, encodedVertices, vertexBuffer, vertexBufferMemory, vertexUsageFlags, vertexMemoryFlags, true);
 
     VkBufferUsageFlags indexUsageFlags = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     VkMemoryPropertyFlags indexMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<uint32_t>(context, commandBufferManager, indices, indexBuffer, indexBufferMemory, indexUsageFlags, indexMemoryFlags, true);
+
+    // The base indices stay first so acceleration structures can keep addressing the start of the buffer
+    std::vector<uint32_t> allIndices = indices;
+    lodRanges.clear();
+    lodRanges.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+    for (const MeshLod& lod : lods)
+    {
+        lodRanges.push_back({ static_cast<uint32_t>(allIndices.size()), static_cast<uint32_t>(lod.indices.size()), lod.error });
+        allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+    }
+
+    indexType = getIndexType(vertices.size());
+    std::vector<uint8_t> encodedIndices = encodeIndices(allIndices, indexType);
+    VulkanUtils::Buffers::createAndFillBuffer<uint8_t>(context, commandBufferManager, encodedIndices, indexBuffer, indexBufferMemory, indexUsageFlags, indexMemoryFlags, true);
 }
 
 void VulkanMesh::cleanup(VkDevice device)
@@ -23,4 +41,44 @@ void VulkanMesh::cleanup(VkDevice device)
     vkFreeMemory(device, vertexBufferMemory, nullptr);
     vertices.clear();
     indices.clear();
+    lods.clear();
+    clusters.clear();
+    lodRanges.clear();
+}
+
+std::vector<MeshCluster> VulkanMesh::getGeometryClusters() const
+{
+    if (clusters.empty())
+    {
+        return { { 0, static_cast<uint32_t>(indices.size()) } };
+    }
+    return clusters;
+}
+
+VkIndexType VulkanMesh::getIndexType(size_t vertexCount)
+{
+    return vertexCount <= std::numeric_limits<uint16_t>::max() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+uint32_t VulkanMesh::getIndexSize(VkIndexType indexType)
+{
+    return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+std::vector<uint8_t> VulkanMesh::encodeIndices(const std::vector<uint32_t>& indices, VkIndexType indexType)
+{
+    std::vector<uint8_t> bytes(indices.size() * getIndexSize(indexType));
+    if (indexType == VK_INDEX_TYPE_UINT16)
+    {
+        uint16_t* out = reinterpret_cast<uint16_t*>(bytes.data());
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            out[i] = static_cast<uint16_t>(indices[i]);
+        }
+    }
+    else
+    {
+        std::memcpy(bytes.data(), indices.data(), bytes.size());
+    }
+    return bytes;
 }
\ No newline at end of file
@@ -1,23 +1,59 @@
 #pragma once
 #include <vector>
 #include "VulkanGeometry.hpp"
+#include "VertexCompression.hpp"
 #include <string>
 #include "VulkanContext.hpp"
 #include "VulkanCommandBufferManager.hpp"
 #include "VulkanMaterial.hpp"
+#include "ObjLoader.hpp"
+
+// Range of the index buffer drawn for one LOD
+struct MeshLodRange
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+};
 
 class VulkanMesh
 {
 public:
     std::vector<VulkanVertex> vertices;
     std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods; // Simplified index lists, appended after the base indices in the index buffer
+    std::vector<MeshCluster> clusters; // Ranges of the base indices built as separate BLAS geometries
+    BoundingVolume bounds; // Object space, kept after cleanup releases the CPU data
+
+    // Set by init, range 0 is the full resolution mesh
+    std::vector<MeshLodRange> lodRanges;
+
+    // GPU vertex layout, set by init from ImportSettings::vertexFormat
+    VertexFormat vertexFormat = VertexFormat::Full;
+    PositionDequantization dequantization;
 
     VkBuffer vertexBuffer;
     VkDeviceMemory vertexBufferMemory;
     VkBuffer indexBuffer;
     VkDeviceMemory indexBufferMemory;
 
+    // Set by init, meshes with fewer than 65536 vertices use 16 bit indices
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
 public:
     void init(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager);
     void cleanup(VkDevice device);
+
+    /// <summary>
+    /// Index ranges built as BLAS geometries, the whole base index range when the mesh is not clustered.
+    /// </summary>
+    std::vector<MeshCluster> getGeometryClusters() const;
+
+    static VkIndexType getIndexType(size_t vertexCount);
+    static uint32_t getIndexSize(VkIndexType indexType);
+
+    /// <summary>
+    /// Encodes indices with the given index type, as bytes ready for upload.
+    /// </summary>
+    static std::vector<uint8_t> encodeIndices(const std::vector<uint32_t>& indices, VkIndexType indexType);
 };
\ No newline at end of file
@@ -9,7 +9,9 @@
 #include "Vulkan_GLFW.hpp"
 #include <vector>
 #include "Transform.hpp"
-#include "VulkanMesh.hpp"
+#include "VulkanModelAsset.hpp"
+#include <memory>
+#include <cstdint>
 
 struct VulkanModelUBO
 {
@@ -20,11 +22,19 @@ struct VulkanModelUBO
     bool debug;
 };
 
-struct ShadedMesh
+// Model uniforms of the whole scene, one buffer per frame in flight with one aligned slot per model.
+// A single allocation keeps large instance counts below the device allocation limit.
+class ModelUniformBuffers
 {
-    // 1 to 1 relationship
-    VulkanMesh mesh;
-    VulkanMaterial material;
+public:
+    std::vector<VkBuffer> buffers;
+    std::vector<VkDeviceMemory> buffersMemory;
+    std::vector<void*> buffersMapped;
+    VkDeviceSize slotSize = 0;
+
+public:
+    void create(const VulkanContext& context, size_t modelCount);
+    void cleanup(VkDevice device);
 };
 
 class VulkanModel
@@ -33,44 +43,43 @@ public:
     std::string name;
     Transform transform;
 
-    std::vector<ShadedMesh> shadedMeshes;
+    // Geometry, materials and BLAS, shared by every model placing the same source
+    std::shared_ptr<const VulkanModelAsset> asset;
 
-    // Model uniforms
+    // Model uniforms, a slot of the scene ModelUniformBuffers
     std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
     std::vector<void*> uniformBuffersMapped;
+    VkDeviceSize uniformBufferOffset = 0;
 
     // These descriptor sets are used for model-unique data only (no textures)
     std::vector<VkDescriptorSet> modelDescriptorSets;
 
-    // Ray tracing
-    VkAccelerationStructureKHR blasHandle;
-    VkBuffer blasBuffer;
-    VkDeviceMemory blasBufferMemory;
-    VkDeviceAddress blasBufferAddress;
-
 public:
     
-    void load(ModelInfo info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool);
+    void load(std::shared_ptr<const VulkanModelAsset> modelAsset, const VulkanContext& context, VkDescriptorPool descriptorPool, const ModelUniformBuffers& sceneUniforms, size_t uniformSlot);
     void cleanup(VkDevice device);
 
     void createDescriptorSets(const VulkanContext& context, VkDescriptorPool descriptorPool);
-    void createUniformBuffers(const VulkanContext& context);
 
-    void createBLAS(
-        const VulkanContext& context,
-        VulkanCommandBufferManager& commandBufferManager);
+    /// <summary>
+    /// World space bounds of the asset, transformed again only when the transform changed since the last call.
+    /// </summary>
+    const BoundingVolume& getWorldBounds() const;
 
+private:
+    mutable BoundingVolume worldBounds;
+    mutable uint64_t worldBoundsVersion = UINT64_MAX;
 };
 
-// One model has multiple meshes
+// One model places one asset, models loaded from the same file share it
+// One asset has multiple meshes
 // One mesh has one material
 // One material has a few textures (albedo, etc)
 
 // Eeach model has descriptor sets for their geometry (Transform data)
 // Each mesh has specific descriptor sets for it's textures etc
 
-// Each Model builds one BLAS with geometry indexing :
+// Each asset builds one BLAS with geometry indexing, every model using it is a TLAS instance :
 //    - buildInfo.geometryCount = submeshes.size();
 //    - buildInfo.pGeometries = geometries.data();
 
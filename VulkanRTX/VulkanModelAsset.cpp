@@ -0,0 +1,236 @@
+#include "VulkanModelAsset.hpp"
+#include "VulkanUtils.hpp"
+#include "VertexCompression.hpp"
+#include "ImportSettings.hpp"
+#include "TextureManager.hpp"
+#include <stdexcept>
+
+void VulkanModelAsset::load(const ModelInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, const DecodedTextures* decodedTextures)
+{
+    // Material textures are uploaded together and handed to the materials. Streamed ones load in the background
+    std::vector<TextureBatchEntry> textureEntries;
+    for (const PBRMaterialInfo& material : info.materials)
+    {
+        for (const TextureBatchEntry& entry : { TextureBatchEntry{ material.albedoTexture, VK_FORMAT_R8G8B8A8_SRGB }, TextureBatchEntry{ material.bumpTexture, VK_FORMAT_R8G8B8A8_UNORM } })
+        {
+            bool decoded = decodedTextures && decodedTextures->count(entry.path) > 0;
+            if (entry.path.empty() || (ImportSettings::streamTextures && !decoded)) continue;
+            textureEntries.push_back(entry);
+        }
+    }
+    AcquiredTextures textures = TextureManager::acquireBatch(textureEntries, context, commandBufferManager, decodedTextures);
+
+    for (int i = 0; i < info.meshes.size(); ++i)
+    {
+        ShadedMesh shadedMesh;
+        shadedMesh.mesh.vertices = info.meshes[i].vertices;
+        shadedMesh.mesh.indices = info.meshes[i].indices;
+        shadedMesh.mesh.lods = info.meshes[i].lods;
+        shadedMesh.mesh.clusters = info.meshes[i].clusters;
+        shadedMesh.mesh.bounds = info.meshes[i].bounds;
+        shadedMesh.mesh.init(context, commandBufferManager);
+
+        int matIndex = info.meshMaterialIndices[i];
+        
+        bool hasError = matIndex == -1;
+        if (hasError)
+        {
+            shadedMesh.material.init({}, context, commandBufferManager, descriptorPool, true);
+        }
+        else
+        {
+            shadedMesh.material.init(info.materials[matIndex], context, commandBufferManager, descriptorPool, false, &textures);
+        }
+        shadedMeshes.push_back(shadedMesh);
+    }
+    bounds = info.bounds;
+
+    createBLAS(context, commandBufferManager);
+}
+
+void VulkanModelAsset::cleanup(VkDevice device)
+{
+    for (ShadedMesh shadedMesh : shadedMeshes)
+    {
+        shadedMesh.mesh.cleanup(device);
+        shadedMesh.material.cleanup(device);
+    }
+    shadedMeshes.clear();
+
+    rt_vkDestroyAccelerationStructureKHR(device, blasHandle, nullptr);
+    blasHandle = VK_NULL_HANDLE;
+
+    vkDestroyBuffer(device, blasBuffer, nullptr);
+    vkFreeMemory(device, blasBufferMemory, nullptr);
+}
+
+void VulkanModelAsset::createBLAS(
+    const VulkanContext& context,
+    VulkanCommandBufferManager& commandBufferManager)
+{
+    std::vector<VkAccelerationStructureGeometryKHR> geometries;
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildRanges;
+    std::vector<uint32_t> primitiveCounts;
+
+    // Quantized positions are mapped back to object space by a per geometry transform
+    std::vector<VkTransformMatrixKHR> transforms;
+    bool useTransforms = false;
+    for (const auto& shadedMesh : shadedMeshes)
+    {
+        const PositionDequantization& dequantization = shadedMesh.mesh.dequantization;
+        VkTransformMatrixKHR transform{};
+        transform.matrix[0][0] = dequantization.scale.x;
+        transform.matrix[1][1] = dequantization.scale.y;
+        transform.matrix[2][2] = dequantization.scale.z;
+        transform.matrix[0][3] = dequantization.offset.x;
+        transform.matrix[1][3] = dequantization.offset.y;
+        transform.matrix[2][3] = dequantization.offset.z;
+        transforms.push_back(transform);
+        useTransforms |= shadedMesh.mesh.vertexFormat == VertexFormat::CompactQuantized;
+    }
+
+    VkBuffer transformBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory transformBufferMemory = VK_NULL_HANDLE;
+    VkDeviceAddress transformBufferAddress = 0;
+    if (useTransforms)
+    {
+        VkBufferUsageFlags transformUsageFlags = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        VulkanUtils::Buffers::createAndFillBuffer<VkTransformMatrixKHR>(context, commandBufferManager, transforms, transformBuffer, transformBufferMemory, transformUsageFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+        transformBufferAddress = VulkanUtils::Buffers::getBufferDeviceAdress(context, transformBuffer);
+    }
+
+    // Create one geometry per mesh cluster, GeometryIndex() in the hit shaders counts them in this order
+    for (size_t i = 0; i < shadedMeshes.size(); i++)
+    {
+        const VulkanMesh& mesh = shadedMeshes[i].mesh;
+        bool quantized = mesh.vertexFormat == VertexFormat::CompactQuantized;
+
+        VkDeviceAddress vertexBufferAddress = VulkanUtils::Buffers::getBufferDeviceAdress(context, mesh.vertexBuffer);
+        VkDeviceAddress indexBufferAddress = VulkanUtils::Buffers::getBufferDeviceAdress(context, mesh.indexBuffer);
+
+        VkAccelerationStructureGeometryKHR accelGeometry{};
+        accelGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+        accelGeometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        accelGeometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+        // Triangle data
+        accelGeometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        accelGeometry.geometry.triangles.vertexFormat = quantized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+        accelGeometry.geometry.triangles.vertexData.deviceAddress = vertexBufferAddress;
+        accelGeometry.geometry.triangles.vertexStride = VertexCompression::getStride(mesh.vertexFormat);
+        accelGeometry.geometry.triangles.maxVertex = static_cast<uint32_t>(mesh.vertices.size()) - 1;
+        accelGeometry.geometry.triangles.indexType = mesh.indexType;
+        accelGeometry.geometry.triangles.indexData.deviceAddress = indexBufferAddress;
+        accelGeometry.geometry.triangles.transformData.deviceAddress = transformBufferAddress;
+
+        uint32_t indexSize = VulkanMesh::getIndexSize(mesh.indexType);
+        for (const MeshCluster& cluster : mesh.getGeometryClusters())
+        {
+            geometries.push_back(accelGeometry);
+
+            // Build range info for this cluster, clusters share the mesh buffers and start at their first index
+            uint32_t primitiveCount = cluster.indexCount / 3;
+            primitiveCounts.push_back(primitiveCount);
+
+            VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
+            buildRangeInfo.primitiveCount = primitiveCount;
+            buildRangeInfo.primitiveOffset = cluster.firstIndex * indexSize;
+            buildRangeInfo.firstVertex = 0;
+            buildRangeInfo.transformOffset = useTransforms ? static_cast<uint32_t>(i * sizeof(VkTransformMatrixKHR)) : 0;
+
+            buildRanges.push_back(buildRangeInfo);
+        }
+    }
+
+    // Build params
+    VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+    buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    buildInfo.geometryCount = static_cast<uint32_t>(geometries.size());
+    buildInfo.pGeometries = geometries.data();
+    buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+
+    // Get required sizes
+    VkAccelerationStructureBuildSizesInfoKHR sizeInfo{};
+    sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+    rt_vkGetAccelerationStructureBuildSizesKHR(
+        context.device,
+        VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+        &buildInfo,
+        primitiveCounts.data(),
+        &sizeInfo);
+
+    // Create scratch buffer
+    VkBuffer scratchBuffer;
+    VkDeviceMemory scratchBufferMemory;
+
+    VulkanUtils::Buffers::createScratchBuffer(
+        context,
+        sizeInfo.buildScratchSize,
+        scratchBuffer,
+        scratchBufferMemory);
+
+    VkDeviceAddress scratchBufferAddress = VulkanUtils::Buffers::getBufferDeviceAdress(context, scratchBuffer);
+
+    // Create BLAS buffer
+    VkBufferUsageFlags blasBufferUsage =
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VulkanUtils::Buffers::createBuffer(
+        context,
+        sizeInfo.accelerationStructureSize,
+        blasBufferUsage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        blasBuffer,
+        blasBufferMemory,
+        true);
+
+    // Create BLAS
+    VkAccelerationStructureCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+    createInfo.buffer = blasBuffer;
+    createInfo.offset = 0;
+    createInfo.size = sizeInfo.accelerationStructureSize;
+    createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+
+    if (rt_vkCreateAccelerationStructureKHR(context.device, &createInfo, nullptr, &blasHandle) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create BLAS!");
+    }
+
+    buildInfo.dstAccelerationStructure = blasHandle;
+    buildInfo.scratchData.deviceAddress = scratchBufferAddress;
+
+    // Prepare build range pointers
+    std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> pBuildRangeInfos;
+    for (const auto& buildRange : buildRanges)
+    {
+        pBuildRangeInfos.push_back(&buildRange);
+    }
+
+    VkCommandBuffer commandBuffer = commandBufferManager.beginSingleTimeCommands(context.device);
+    rt_vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildInfo, pBuildRangeInfos.data());
+    commandBufferManager.endSingleTimeCommands(context.device, context.graphicsQueue, commandBuffer);
+
+    // Cleanup scratch buffer
+    vkDestroyBuffer(context.device, scratchBuffer, nullptr);
+    vkFreeMemory(context.device, scratchBufferMemory, nullptr);
+
+    if (useTransforms)
+    {
+        vkDestroyBuffer(context.device, transformBuffer, nullptr);
+        vkFreeMemory(context.device, transformBufferMemory, nullptr);
+    }
+
+    if (debug_vkSetDebugUtilsObjectNameEXT)
+    {
+        VkDebugUtilsObjectNameInfoEXT nameInfo{};
+        nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+        nameInfo.objectType = VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR;
+        nameInfo.objectHandle = (uint64_t)blasHandle;
+        nameInfo.pObjectName = sourcePath.c_str();
+        debug_vkSetDebugUtilsObjectNameEXT(context.device, &nameInfo);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "VulkanContext.hpp"
+#include "VulkanCommandBufferManager.hpp"
+#include "VulkanExtensionFunctions.hpp"
+#include "VulkanMesh.hpp"
+#include "VulkanMaterial.hpp"
+#include "ObjLoader.hpp"
+#include <string>
+#include <vector>
+
+struct ShadedMesh
+{
+    // 1 to 1 relationship
+    VulkanMesh mesh;
+    VulkanMaterial material;
+};
+
+/// <summary>
+/// GPU data of one imported model: mesh buffers, materials and the BLAS.
+/// An asset is created once per source file and shared by every VulkanModel placing it in the scene.
+/// </summary>
+class VulkanModelAsset
+{
+public:
+    std::string sourcePath;
+
+    std::vector<ShadedMesh> shadedMeshes;
+    BoundingVolume bounds; // Object space, union of the mesh bounds
+
+    // Ray tracing
+    VkAccelerationStructureKHR blasHandle;
+    VkBuffer blasBuffer;
+    VkDeviceMemory blasBufferMemory;
+    VkDeviceAddress blasBufferAddress;
+
+public:
+    void load(const ModelInfo& info, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkDescriptorPool descriptorPool, const DecodedTextures* decodedTextures = nullptr);
+    void cleanup(VkDevice device);
+
+    void createBLAS(
+        const VulkanContext& context,
+        VulkanCommandBufferManager& commandBufferManager);
+};
@@ -9,6 +9,10 @@
 #include "RunTimeSettings.hpp"
 #include <random>
 #include "DescriptorSetLayoutManager.hpp"
+#include "VertexCompression.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <string>
 
 void VulkanRayTracingPipeline::init(const VulkanContext& context, uint32_t width, uint32_t height)
 {
@@ -20,14 +24,132 @@ void VulkanRayTracingPipeline::init(const VulkanContext& context, uint32_t width
     createDescriptorSet(context);
     createUniformBuffer(context);
     createStorageImage(context, width, height);
+
+    // Samplers are needed by the G-Buffer descriptors, which resizes write before the scene is ready
+    VulkanUtils::Textures::createSampler(context, &globalTextureSampler, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR);
+    VulkanUtils::Textures::createSampler(context, &pointTextureSampler, VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST);
+}
+
+void SceneBuffer::append(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const void* data, VkDeviceSize dataSize)
+{
+    if (dataSize == 0)
+    {
+        return;
+    }
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    VulkanUtils::Buffers::createBuffer(context, dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* mappedData;
+    vkMapMemory(context.device, stagingBufferMemory, 0, dataSize, 0, &mappedData);
+    memcpy(mappedData, data, static_cast<size_t>(dataSize));
+    vkUnmapMemory(context.device, stagingBufferMemory);
+
+    // Grown geometrically so a progressively loading scene reallocates a few times only, the GPU copies the previous content
+    VkBuffer previousBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory previousMemory = VK_NULL_HANDLE;
+    if (size + dataSize > capacity)
+    {
+        previousBuffer = buffer;
+        previousMemory = memory;
+        capacity = std::max(size + dataSize, capacity * 2);
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VulkanUtils::Buffers::createBuffer(context, capacity, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+    }
+
+    VkCommandBuffer commandBuffer = commandBufferManager.beginSingleTimeCommands(context.device);
+    if (previousBuffer != VK_NULL_HANDLE && size > 0)
+    {
+        VkBufferCopy previousRegion{};
+        previousRegion.size = size;
+        vkCmdCopyBuffer(commandBuffer, previousBuffer, buffer, 1, &previousRegion);
+    }
+    VkBufferCopy appendedRegion{};
+    appendedRegion.dstOffset = size;
+    appendedRegion.size = dataSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, buffer, 1, &appendedRegion);
+    commandBufferManager.endSingleTimeCommands(context.device, context.graphicsQueue, commandBuffer);
+
+    vkDestroyBuffer(context.device, stagingBuffer, nullptr);
+    vkFreeMemory(context.device, stagingBufferMemory, nullptr);
+    if (previousBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(context.device, previousBuffer, nullptr);
+        vkFreeMemory(context.device, previousMemory, nullptr);
+    }
+    size += dataSize;
+}
+
+void SceneBuffer::cleanup(VkDevice device)
+{
+    if (buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    if (memory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
+    }
+    size = 0;
+    capacity = 0;
 }
 
 void VulkanRayTracingPipeline::writeDescriptors(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const std::vector<VulkanModel>& models, VkAccelerationStructureKHR tlas, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView)
+{
+    size_t firstNewAsset = sceneAssets.size();
+    uint32_t firstNewMesh = sceneMeshCount;
+    createRayTracingResources(context, commandBufferManager, models);
+
+    // Only the textures of the new meshes are written, unless the set had to grow and lost the previous ones
+    if (reserveMaterialTextures(context, sceneMeshCount * 2))
+    {
+        firstNewAsset = 0;
+        firstNewMesh = 0;
+    }
+    std::vector<VkImageView> albedoTextureViews;
+    std::vector<VkImageView> normalTextureViews;
+    collectMaterialTextures(firstNewAsset, albedoTextureViews, normalTextureViews);
+    writeDescriptorSet(context, depthImageView, normalsImageView, albedoImageView, tlas, firstNewMesh, albedoTextureViews, normalTextureViews);
+    sceneWritten = true;
+}
+
+bool VulkanRayTracingPipeline::hasScene() const
+{
+    return sceneWritten;
+}
+
+void VulkanRayTracingPipeline::printSceneStatistics() const
+{
+    std::cout << "Ray tracing vertex buffer: " << globalVertexBuffer.size / 1024 << " KiB" << std::endl;
+    std::cout << "Ray tracing index buffer: " << globalIndexBuffer.size / 1024 << " KiB" << std::endl;
+}
+
+void VulkanRayTracingPipeline::updateMaterialTextures(const VulkanContext& context)
 {
     std::vector<VkImageView> allAlbedoTextureViews;
     std::vector<VkImageView> allNormalTextureViews;
-    createRayTracingResources(context, commandBufferManager, tlas, models, allAlbedoTextureViews, allNormalTextureViews);
-    writeDescriptorSet(context, depthImageView, normalsImageView, albedoImageView, tlas, allAlbedoTextureViews, allNormalTextureViews);
+    collectMaterialTextures(0, allAlbedoTextureViews, allNormalTextureViews);
+
+    // Same meshes as the last writeDescriptors, the set already has room for them
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
+    std::vector<VkDescriptorImageInfo> materialTextureInfos;
+    writeMaterialTextures(0, allAlbedoTextureViews, allNormalTextureViews, materialTextureInfos, descriptorWrites);
+    vkUpdateDescriptorSets(context.device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void VulkanRayTracingPipeline::releaseSceneResources(VkDevice device)
+{
+    globalVertexBuffer.cleanup(device);
+    globalIndexBuffer.cleanup(device);
+    meshDataBuffer.cleanup(device);
+    instanceDataBuffer.cleanup(device);
+    sceneAssets.clear();
+    assetMeshOffsets.clear();
+    sceneMeshCount = 0;
+    sceneWritten = false;
 }
 
 void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32_t width, uint32_t height, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView)
@@ -77,7 +199,7 @@ void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32
     storageWrite.pImageInfo = &storageInfo;
     descriptorWrites.push_back(storageWrite);
 
-    // Binding 9: Depth
+    // Binding 7: Depth
     VkDescriptorImageInfo depthInfos;
     depthInfos.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
     depthInfos.imageView = depthImageView;
@@ -86,14 +208,14 @@ void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32
     VkWriteDescriptorSet depthWrite{};
     depthWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     depthWrite.dstSet = descriptorSet;
-    depthWrite.dstBinding = 9;
+    depthWrite.dstBinding = 7;
     depthWrite.dstArrayElement = 0;
     depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     depthWrite.descriptorCount = 1;
     depthWrite.pImageInfo = &depthInfos;
     descriptorWrites.push_back(depthWrite);
 
-    // Binding 10: Normals
+    // Binding 8: Normals
     VkDescriptorImageInfo normalsInfos;
     normalsInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     normalsInfos.imageView = normalsImageView;
@@ -102,14 +224,14 @@ void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32
     VkWriteDescriptorSet normalsWrite{};
     normalsWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     normalsWrite.dstSet = descriptorSet;
-    normalsWrite.dstBinding = 10;
+    normalsWrite.dstBinding = 8;
     normalsWrite.dstArrayElement = 0;
     normalsWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     normalsWrite.descriptorCount = 1;
     normalsWrite.pImageInfo = &normalsInfos;
     descriptorWrites.push_back(normalsWrite);
 
-    // Binding 11: Albedo
+    // Binding 9: Albedo
     VkDescriptorImageInfo albedoInfos;
     albedoInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     albedoInfos.imageView = albedoImageView;
@@ -118,14 +240,14 @@ void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32
     VkWriteDescriptorSet albedoWrite{};
     albedoWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     albedoWrite.dstSet = descriptorSet;
-    albedoWrite.dstBinding = 11;
+    albedoWrite.dstBinding = 9;
     albedoWrite.dstArrayElement = 0;
     albedoWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     albedoWrite.descriptorCount = 1;
     albedoWrite.pImageInfo = &albedoInfos;
     descriptorWrites.push_back(albedoWrite);
 
-    // Binding 12: Frame accumulation
+    // Binding 10: Frame accumulation
     VkDescriptorImageInfo lastImageInfos;
     lastImageInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     lastImageInfos.imageView = last_storageImageView;
@@ -134,7 +256,7 @@ void VulkanRayTracingPipeline::handleResize(const VulkanContext& context, uint32
     VkWriteDescriptorSet lastImageWrite{};
     lastImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     lastImageWrite.dstSet = descriptorSet;
-    lastImageWrite.dstBinding = 12;
+    lastImageWrite.dstBinding = 10;
     lastImageWrite.dstArrayElement = 0;
     lastImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     lastImageWrite.descriptorCount = 1;
@@ -362,7 +484,7 @@ void VulkanRayTracingPipeline::createDescriptorPool(const VulkanContext& context
     poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     poolSizes[3].descriptorCount = 4; // vertex + index + mesh + instance
     poolSizes[4].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[4].descriptorCount = MAX_MESHES * 2 + 3 + 1; // MAX_MESHES * 2 for albedo + normals, +3 for GBuffer, + 1 for last image
+    poolSizes[4].descriptorCount = materialTextureCapacity + 3 + 1; // Material textures, +3 for GBuffer, + 1 for last image
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -376,107 +498,120 @@ void VulkanRayTracingPipeline::createDescriptorPool(const VulkanContext& context
     }
 }
 
-void VulkanRayTracingPipeline::createRayTracingResources(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkAccelerationStructureKHR tlas, const std::vector<VulkanModel>& models, std::vector<VkImageView>& outAlbedoTextureViews, std::vector<VkImageView>& outBumpTextureViews)
+void VulkanRayTracingPipeline::collectMaterialTextures(size_t firstAsset, std::vector<VkImageView>& outAlbedoTextureViews, std::vector<VkImageView>& outBumpTextureViews)
 {
-    // Compute sizes across all submeshes
-    size_t totalVertices = 0;
-    size_t totalIndices = 0;
-    size_t totalMeshes = 0;
-    size_t totalModels = models.size();
-
-    for (const auto& model : models)
+    // Same asset and mesh order as createRayTracingResources, the index of a mesh is its textureIndex
+    for (size_t i = firstAsset; i < sceneAssets.size(); i++)
     {
-        for (const auto& shadedMesh : model.shadedMeshes)
+        for (const auto& shadedMesh : sceneAssets[i]->shadedMeshes)
         {
-            totalVertices += shadedMesh.mesh.vertices.size();
-            totalIndices += shadedMesh.mesh.indices.size();
-            totalMeshes++;
+            if (!shadedMesh.material.hasError)
+            {
+                outAlbedoTextureViews.push_back(shadedMesh.material.albedoMap->imageView);
+                outBumpTextureViews.push_back(shadedMesh.material.bumpMap->imageView);
+            }
+            else
+            {
+                outAlbedoTextureViews.push_back(TextureManager::errorAlbedoTexture.imageView);
+                outBumpTextureViews.push_back(TextureManager::errorBumpTexture.imageView);
+            }
         }
     }
+}
 
-    // Create combined buffers
-    std::vector<VulkanVertex> allVertices;
-    std::vector<uint32_t> allIndices;
+void VulkanRayTracingPipeline::createRayTracingResources(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const std::vector<VulkanModel>& models)
+{
+    // Assets already in the scene buffers keep their data, shared assets are uploaded once and their instances point to the same meshes
+    size_t firstNewAsset = sceneAssets.size();
+    size_t totalVertexBytes = 0;
+    size_t totalIndexBytes = 0;
+    size_t totalGeometries = 0;
+    for (const auto& model : models)
+    {
+        if (!assetMeshOffsets.try_emplace(model.asset.get(), 0).second) continue;
+        sceneAssets.push_back(model.asset);
 
-    allVertices.reserve(totalVertices);
-    allIndices.reserve(totalIndices);
+        for (const auto& shadedMesh : model.asset->shadedMeshes)
+        {
+            totalVertexBytes += shadedMesh.mesh.vertices.size() * VertexCompression::getStride(shadedMesh.mesh.vertexFormat);
+            totalIndexBytes += shadedMesh.mesh.indices.size() * VulkanMesh::getIndexSize(shadedMesh.mesh.indexType) + 3;
+            totalGeometries += shadedMesh.mesh.getGeometryClusters().size();
+        }
+    }
 
-    std::vector<MeshData> allMeshData;
-    std::vector<InstanceData> allInstanceData;
+    // Data of the new assets, offsets continue after the data already uploaded
+    std::vector<uint8_t> newVertices;
+    std::vector<uint8_t> newIndices;
+    std::vector<MeshData> newMeshData;
 
-    allMeshData.reserve(totalMeshes);
-    allInstanceData.reserve(totalModels);
+    newVertices.reserve(totalVertexBytes);
+    newIndices.reserve(totalIndexBytes);
+    newMeshData.reserve(totalGeometries);
 
-    uint32_t vertexOffset = 0;
-    uint32_t indexOffset = 0;
-    uint32_t meshOffset = 0;
+    uint32_t vertexByteOffset = static_cast<uint32_t>(globalVertexBuffer.size);
+    uint32_t indexByteOffset = static_cast<uint32_t>(globalIndexBuffer.size);
+    uint32_t meshDataOffset = static_cast<uint32_t>(meshDataBuffer.size / sizeof(MeshData));
 
-    // Process all models and their submeshes
-    for (const auto& model : models)
+    // Process the new assets and their submeshes, mesh data is stored per BLAS geometry so clusters of a mesh get one entry each
+    for (size_t i = firstNewAsset; i < sceneAssets.size(); i++)
     {
-        // Safer to assign attributes explicitly since the struct might change
-        InstanceData instanceData;
-        instanceData.normalMatrix = glm::transpose(glm::inverse(model.transform.getTransformMatrix()));
-        instanceData.meshOffset = meshOffset;
-        allInstanceData.push_back(instanceData);
+        const VulkanModelAsset* asset = sceneAssets[i].get();
+        assetMeshOffsets[asset] = meshDataOffset + static_cast<uint32_t>(newMeshData.size());
 
-        for (const auto& shadedMesh : model.shadedMeshes)
+        for (const auto& shadedMesh : asset->shadedMeshes)
         {
             const VulkanMesh& mesh = shadedMesh.mesh;
 
             // Store mesh data
-            MeshData meshData;
-            meshData.indexOffset = indexOffset;
-            meshData.vertexOffset = vertexOffset;
-            allMeshData.push_back(meshData);
-
-            // Collect vertex and index data
-            allVertices.insert(allVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
-            allIndices.insert(allIndices.end(), mesh.indices.begin(), mesh.indices.end());
-
-            // Collect texture from material
-            if (!shadedMesh.material.hasError)
+            MeshData meshData{};
+            meshData.indexByteOffset = indexByteOffset + static_cast<uint32_t>(newIndices.size());
+            meshData.indexSize = VulkanMesh::getIndexSize(mesh.indexType);
+            meshData.vertexByteOffset = vertexByteOffset;
+            meshData.vertexFormat = static_cast<uint32_t>(mesh.vertexFormat);
+            meshData.textureIndex = sceneMeshCount++;
+
+            // Collect vertex and index data, vertices use the same encoding as the mesh vertex buffer
+            PositionDequantization dequantization;
+            std::vector<uint8_t> encodedVertices = VertexCompression::encode(mesh.vertices, mesh.vertexFormat, dequantization);
+            meshData.positionScale = dequantization.scale;
+            meshData.positionOffset = dequantization.offset;
+
+            uint32_t meshIndexByteOffset = meshData.indexByteOffset;
+            for (const MeshCluster& cluster : mesh.getGeometryClusters())
             {
-                outAlbedoTextureViews.push_back(shadedMesh.material.albedoMap.imageView);
-                outBumpTextureViews.push_back(shadedMesh.material.bumpMap.imageView);
-            }
-            else
-            {
-                outAlbedoTextureViews.push_back(TextureManager::errorAlbedoTexture.imageView);
-                outBumpTextureViews.push_back(TextureManager::errorBumpTexture.imageView);
+                meshData.indexByteOffset = meshIndexByteOffset + cluster.firstIndex * meshData.indexSize;
+                newMeshData.push_back(meshData);
             }
 
+            newVertices.insert(newVertices.end(), encodedVertices.begin(), encodedVertices.end());
+
+            // Indices keep the mesh index type, segments start on 4 bytes for ByteAddressBuffer loads
+            std::vector<uint8_t> encodedIndices = VulkanMesh::encodeIndices(mesh.indices, mesh.indexType);
+            newIndices.insert(newIndices.end(), encodedIndices.begin(), encodedIndices.end());
+            newIndices.resize((newIndices.size() + 3) & ~size_t(3));
+
             // Update offsets
-            vertexOffset += static_cast<uint32_t>(mesh.vertices.size());
-            indexOffset += static_cast<uint32_t>(mesh.indices.size());
-            meshOffset++;
+            vertexByteOffset += static_cast<uint32_t>(encodedVertices.size());
         }
-
     }
 
-    // Create vertex buffer
-    VkBufferUsageFlags vertexUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    VkMemoryPropertyFlags vertexMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<VulkanVertex>(context, commandBufferManager, allVertices, globalVertexBuffer, globalVertexBufferMemory, vertexUsageFlags, vertexMemoryFlags, false);
+    globalVertexBuffer.append(context, commandBufferManager, newVertices.data(), newVertices.size());
+    globalIndexBuffer.append(context, commandBufferManager, newIndices.data(), newIndices.size());
+    meshDataBuffer.append(context, commandBufferManager, newMeshData.data(), newMeshData.size() * sizeof(MeshData));
 
-    // Create index buffer
-    VkBufferUsageFlags indexUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    VkMemoryPropertyFlags indexMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<uint32_t>(context, commandBufferManager, allIndices, globalIndexBuffer, globalIndexBufferMemory, indexUsageFlags, indexMemoryFlags, false);
-
-    // Create mesh data buffer
-    VkBufferUsageFlags meshDataUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    VkMemoryPropertyFlags meshDataMemoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<MeshData>(context, commandBufferManager, allMeshData, meshDataBuffer, meshDataBufferMemory, meshDataUsageFlags, meshDataMemoryFlags, false);
-
-    // Create offset buffer
-    VkBufferUsageFlags offsetUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    VkMemoryPropertyFlags offsetMemory = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VulkanUtils::Buffers::createAndFillBuffer<InstanceData>(context, commandBufferManager, allInstanceData, instanceDataBuffer, instanceDataBufferMemory, offsetUsage, offsetMemory, false);
-
-    // Create samplers
-    VulkanUtils::Textures::createSampler(context, &globalTextureSampler, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR);
-    VulkanUtils::Textures::createSampler(context, &pointTextureSampler, VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST);
+    // One instance per model, in TLAS order. Written again for every model, the TLAS is rebuilt with the current transforms too
+    std::vector<InstanceData> allInstanceData;
+    allInstanceData.reserve(models.size());
+    for (const auto& model : models)
+    {
+        // Safer to assign attributes explicitly since the struct might change
+        InstanceData instanceData;
+        instanceData.normalMatrix = glm::transpose(glm::inverse(model.transform.getTransformMatrix()));
+        instanceData.meshOffset = assetMeshOffsets[model.asset.get()];
+        allInstanceData.push_back(instanceData);
+    }
+    instanceDataBuffer.size = 0; // Rewritten from the start, the buffer only grows
+    instanceDataBuffer.append(context, commandBufferManager, allInstanceData.data(), allInstanceData.size() * sizeof(InstanceData));
 }
 
 void VulkanRayTracingPipeline::createDescriptorSet(const VulkanContext& context)
@@ -488,13 +623,40 @@ void VulkanRayTracingPipeline::createDescriptorSet(const VulkanContext& context)
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &layout;
 
+    VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+    variableCountInfo.descriptorSetCount = 1;
+    variableCountInfo.pDescriptorCounts = &materialTextureCapacity;
+    allocInfo.pNext = &variableCountInfo;
+
     if (vkAllocateDescriptorSets(context.device, &allocInfo, &descriptorSet) != VK_SUCCESS)
     {
         throw std::runtime_error("Could not allocate descriptor set!");
     }
 }
 
-void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView, VkAccelerationStructureKHR tlas, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews)
+bool VulkanRayTracingPipeline::reserveMaterialTextures(const VulkanContext& context, uint32_t textureCount)
+{
+    if (textureCount <= materialTextureCapacity)
+    {
+        return false;
+    }
+
+    uint32_t maxTextures = DescriptorSetLayoutManager::getMaxMaterialTextures();
+    if (textureCount > maxTextures)
+    {
+        throw std::runtime_error("Scene uses " + std::to_string(textureCount) + " material textures, the device supports " + std::to_string(maxTextures));
+    }
+
+    // Grown geometrically so a progressively loading scene reallocates a few times only
+    materialTextureCapacity = std::min(std::max(textureCount, materialTextureCapacity * 2), maxTextures);
+    vkDestroyDescriptorPool(context.device, descriptorPool, nullptr);
+    createDescriptorPool(context);
+    createDescriptorSet(context);
+    return true;
+}
+
+void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView, VkAccelerationStructureKHR tlas, uint32_t firstMesh, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews)
 {
     std::vector<VkWriteDescriptorSet> descriptorWrites;
 
@@ -548,7 +710,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
 
     // Vertex Buffer
     VkDescriptorBufferInfo vertexBufferInfo{};
-    vertexBufferInfo.buffer = globalVertexBuffer;
+    vertexBufferInfo.buffer = globalVertexBuffer.buffer;
     vertexBufferInfo.offset = 0;
     vertexBufferInfo.range = VK_WHOLE_SIZE;
 
@@ -564,7 +726,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
 
     // Index Buffer
     VkDescriptorBufferInfo indexBufferInfo{};
-    indexBufferInfo.buffer = globalIndexBuffer;
+    indexBufferInfo.buffer = globalIndexBuffer.buffer;
     indexBufferInfo.offset = 0;
     indexBufferInfo.range = VK_WHOLE_SIZE;
 
@@ -580,7 +742,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
 
     // Mesh data Buffer
     VkDescriptorBufferInfo meshDataBufferInfo{};
-    meshDataBufferInfo.buffer = meshDataBuffer;
+    meshDataBufferInfo.buffer = meshDataBuffer.buffer;
     meshDataBufferInfo.offset = 0;
     meshDataBufferInfo.range = VK_WHOLE_SIZE;
 
@@ -596,7 +758,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
 
     // Instance data Buffer
     VkDescriptorBufferInfo instanceDataBufferInfo{};
-    instanceDataBufferInfo.buffer = instanceDataBuffer;
+    instanceDataBufferInfo.buffer = instanceDataBuffer.buffer;
     instanceDataBufferInfo.offset = 0;
     instanceDataBufferInfo.range = VK_WHOLE_SIZE;
 
@@ -610,65 +772,6 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
     instanceDataWrite.pBufferInfo = &instanceDataBufferInfo;
     descriptorWrites.push_back(instanceDataWrite);
 
-    if (std::max(albedoTextureViews.size(), normalTextureViews.size()) > MAX_MESHES)
-    {
-        std::cerr << "WARNING: reached maximum mesh count !" << std::endl;
-    }
-
-    // Material textures
-    // Albedo
-    std::vector<VkDescriptorImageInfo> albedoTextureInfos(MAX_MESHES);
-    for (size_t i = 0; i < MAX_MESHES; i++)
-    {
-        albedoTextureInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        albedoTextureInfos[i].sampler = globalTextureSampler;
-        if (i < albedoTextureViews.size())
-        {
-            albedoTextureInfos[i].imageView = albedoTextureViews[i];
-        }
-        else
-        {
-            // TODO: find better alternative
-            albedoTextureInfos[i].imageView = TextureManager::errorAlbedoTexture.imageView;
-        }
-    }
-
-    // Normals
-    std::vector<VkDescriptorImageInfo> normalTextureInfos(MAX_MESHES);
-    for (size_t i = 0; i < MAX_MESHES; i++)
-    {
-        normalTextureInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        normalTextureInfos[i].sampler = globalTextureSampler;
-        if (i < normalTextureViews.size())
-        {
-            normalTextureInfos[i].imageView = normalTextureViews[i];
-        }
-        else
-        {
-            normalTextureInfos[i].imageView = TextureManager::errorBumpTexture.imageView;
-        }
-    }
-
-    VkWriteDescriptorSet albedoWrite{};
-    albedoWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    albedoWrite.dstSet = descriptorSet;
-    albedoWrite.dstBinding = 7;
-    albedoWrite.dstArrayElement = 0;
-    albedoWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    albedoWrite.descriptorCount = MAX_MESHES;
-    albedoWrite.pImageInfo = albedoTextureInfos.data();
-    descriptorWrites.push_back(albedoWrite);
-
-    VkWriteDescriptorSet normalWrite{};
-    normalWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    normalWrite.dstSet = descriptorSet;
-    normalWrite.dstBinding = 8;
-    normalWrite.dstArrayElement = 0;
-    normalWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    normalWrite.descriptorCount = MAX_MESHES;
-    normalWrite.pImageInfo = normalTextureInfos.data();
-    descriptorWrites.push_back(normalWrite);
-
     // Depth
     VkDescriptorImageInfo depthInfos;
     depthInfos.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
@@ -678,7 +781,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
     VkWriteDescriptorSet depthWrite{};
     depthWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     depthWrite.dstSet = descriptorSet;
-    depthWrite.dstBinding = 9;
+    depthWrite.dstBinding = 7;
     depthWrite.dstArrayElement = 0;
     depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     depthWrite.descriptorCount = 1;
@@ -695,7 +798,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
     VkWriteDescriptorSet gBufferNormalsWrite{};
     gBufferNormalsWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     gBufferNormalsWrite.dstSet = descriptorSet;
-    gBufferNormalsWrite.dstBinding = 10;
+    gBufferNormalsWrite.dstBinding = 8;
     gBufferNormalsWrite.dstArrayElement = 0;
     gBufferNormalsWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     gBufferNormalsWrite.descriptorCount = 1;
@@ -712,7 +815,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
     VkWriteDescriptorSet gBufferAlbedoWrite{};
     gBufferAlbedoWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     gBufferAlbedoWrite.dstSet = descriptorSet;
-    gBufferAlbedoWrite.dstBinding = 11;
+    gBufferAlbedoWrite.dstBinding = 9;
     gBufferAlbedoWrite.dstArrayElement = 0;
     gBufferAlbedoWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     gBufferAlbedoWrite.descriptorCount = 1;
@@ -729,7 +832,7 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
     VkWriteDescriptorSet lastImageWrite{};
     lastImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     lastImageWrite.dstSet = descriptorSet;
-    lastImageWrite.dstBinding = 12;
+    lastImageWrite.dstBinding = 10;
     lastImageWrite.dstArrayElement = 0;
     lastImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     lastImageWrite.descriptorCount = 1;
@@ -737,10 +840,36 @@ void VulkanRayTracingPipeline::writeDescriptorSet(const VulkanContext& context,
 
     descriptorWrites.push_back(lastImageWrite);
 
+    std::vector<VkDescriptorImageInfo> materialTextureInfos;
+    writeMaterialTextures(firstMesh, albedoTextureViews, normalTextureViews, materialTextureInfos, descriptorWrites);
 
     vkUpdateDescriptorSets(context.device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
+void VulkanRayTracingPipeline::writeMaterialTextures(uint32_t firstMesh, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews, std::vector<VkDescriptorImageInfo>& outImageInfos, std::vector<VkWriteDescriptorSet>& outDescriptorWrites)
+{
+    // Material textures, albedo then normal map of every mesh. Only the populated range is written, the binding is partially bound
+    outImageInfos.resize(albedoTextureViews.size() * 2);
+    for (size_t i = 0; i < albedoTextureViews.size(); i++)
+    {
+        outImageInfos[i * 2] = { globalTextureSampler, albedoTextureViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        outImageInfos[i * 2 + 1] = { globalTextureSampler, normalTextureViews[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    }
+
+    if (!outImageInfos.empty())
+    {
+        VkWriteDescriptorSet materialTexturesWrite{};
+        materialTexturesWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        materialTexturesWrite.dstSet = descriptorSet;
+        materialTexturesWrite.dstBinding = 11;
+        materialTexturesWrite.dstArrayElement = firstMesh * 2;
+        materialTexturesWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        materialTexturesWrite.descriptorCount = static_cast<uint32_t>(outImageInfos.size());
+        materialTexturesWrite.pImageInfo = outImageInfos.data();
+        outDescriptorWrites.push_back(materialTexturesWrite);
+    }
+}
+
 void VulkanRayTracingPipeline::traceRays(VkCommandBuffer commandBuffer, uint32_t frameCount)
 {
     sampleCount = RunTimeSettings::spp * frameCount;
@@ -852,42 +981,15 @@ void VulkanRayTracingPipeline::cleanup(VkDevice device)
         vkFreeMemory(device, last_storageImageMemory, nullptr);
     }
 
-    if (globalVertexBuffer != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, globalVertexBuffer, nullptr);
-    }
-    if (globalVertexBufferMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, globalVertexBufferMemory, nullptr);
-    }
-    if (globalIndexBuffer != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, globalIndexBuffer, nullptr);
-    }
-    if (globalIndexBufferMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, globalIndexBufferMemory, nullptr);
-    }
-    if (meshDataBuffer != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, meshDataBuffer, nullptr);
-    }
-    if (meshDataBufferMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, meshDataBufferMemory, nullptr);
-    }
-    if (instanceDataBuffer != VK_NULL_HANDLE)
-    {
-        vkDestroyBuffer(device, instanceDataBuffer, nullptr);
-    }
-    if (instanceDataBufferMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, instanceDataBufferMemory, nullptr);
-    }
+    releaseSceneResources(device);
     if (globalTextureSampler != VK_NULL_HANDLE)
     {
         vkDestroySampler(device, globalTextureSampler, nullptr);
     }
+    if (pointTextureSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(device, pointTextureSampler, nullptr);
+    }
 
     if (sbtBuffer != VK_NULL_HANDLE) 
     {
@@ -1,5 +1,7 @@
 #include "VulkanContext.hpp"
 #include "VulkanModel.hpp"
+#include <memory>
+#include <unordered_map>
 
 struct SceneData 
 {
@@ -13,19 +15,27 @@ struct SceneData
     int resolutionX;
     int resolutionY;
     int spp;
+    alignas(16) glm::vec4 sunDirection; // xyz: direction the light travels
+    alignas(16) glm::vec4 sunColor;
 };
 
 struct InstanceData
 {
     glm::mat4 normalMatrix;
-    uint32_t meshOffset;
+    uint32_t meshOffset; // First MeshData entry of the model, one per BLAS geometry
     glm::vec3 padding;
 };
 
 struct MeshData
 {
-    uint32_t indexOffset;
-    uint32_t vertexOffset;
+    uint32_t indexByteOffset; // Meshes may use 16 or 32 bit indices, so indices are addressed in bytes
+    uint32_t vertexByteOffset; // Meshes may use different vertex formats, so vertices are addressed in bytes
+    uint32_t vertexFormat;
+    uint32_t indexSize; // 2 or 4
+    uint32_t textureIndex; // Clusters of a mesh share its textures
+    uint32_t padding[3];
+    glm::vec4 positionScale;
+    glm::vec4 positionOffset;
 };
 
 struct PushConstants
@@ -34,6 +44,18 @@ struct PushConstants
     uint32_t rng;
 };
 
+// Device local storage buffer of the ray tracing scene, grown geometrically with its content kept
+struct SceneBuffer
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0; // Bytes written
+    VkDeviceSize capacity = 0;
+
+    void append(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const void* data, VkDeviceSize dataSize);
+    void cleanup(VkDevice device);
+};
+
 class VulkanRayTracingPipeline
 {
 private:
@@ -68,39 +90,65 @@ private:
     // Descriptor Set
     VkDescriptorPool descriptorPool;
     VkDescriptorSet descriptorSet;
+    uint32_t materialTextureCapacity = 0; // Variable count of the material texture binding of descriptorSet
 
-    // buffers
-    VkBuffer instanceDataBuffer;
-    VkDeviceMemory instanceDataBufferMemory;
-
-    VkBuffer globalIndexBuffer;
-    VkDeviceMemory globalIndexBufferMemory;
+    // Scene buffers. Assets added while the scene loads are appended to the geometry, the instances are written again
+    SceneBuffer instanceDataBuffer;
+    SceneBuffer globalIndexBuffer;
+    SceneBuffer meshDataBuffer;
+    SceneBuffer globalVertexBuffer;
 
-    VkBuffer meshDataBuffer;
-    VkDeviceMemory meshDataBufferMemory;
+    // Assets in the scene buffers in upload order, with their first MeshData entry
+    std::vector<std::shared_ptr<const VulkanModelAsset>> sceneAssets;
+    std::unordered_map<const VulkanModelAsset*, uint32_t> assetMeshOffsets;
+    uint32_t sceneMeshCount = 0; // Meshes of sceneAssets, each one has an albedo and a normal map in the material texture binding
 
-    VkBuffer globalVertexBuffer;
-    VkDeviceMemory globalVertexBufferMemory;
+    bool sceneWritten = false;
 
     // Sampler
-    VkSampler globalTextureSampler;
-    VkSampler pointTextureSampler;
+    VkSampler globalTextureSampler = VK_NULL_HANDLE;
+    VkSampler pointTextureSampler = VK_NULL_HANDLE;
 
     int sampleCount;
 
 public:
     void init(const VulkanContext& context, uint32_t width, uint32_t height);
+    /// <summary>
+    /// Uploads the assets of models not in the scene buffers yet, writes the instances and binds the scene. Models may only
+    /// be added between calls. The scene buffers and descriptor set must not be in use.
+    /// </summary>
     void writeDescriptors(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const std::vector<VulkanModel>& models, VkAccelerationStructureKHR tlas, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView);
+    bool hasScene() const; // False until writeDescriptors ran, tracing before would read unwritten descriptors
+    void printSceneStatistics() const; // Sizes of the scene buffers, once the scene is loaded
+
+    /// <summary>
+    /// Rewrites the material textures of the meshes in the scene buffers, after materials swapped textures.
+    /// The descriptor set must not be in use.
+    /// </summary>
+    void updateMaterialTextures(const VulkanContext& context);
+    void releaseSceneResources(VkDevice device);
 
     void createRayTracingPipelineLayout(const VulkanContext& context);
     void createRayTracingPipeline(const VulkanContext& context);
     void createShaderBindingTable(const VulkanContext& context);
     
-    void createRayTracingResources(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkAccelerationStructureKHR tlas, const std::vector<VulkanModel>& models, std::vector<VkImageView>& outAlbedoTextureViews, std::vector<VkImageView>& outNormalTextureViews);
+    // Appends the geometry of the assets first placed by models, then writes the instances of every model
+    void createRayTracingResources(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const std::vector<VulkanModel>& models);
+    // Material texture views of sceneAssets from firstAsset on, in mesh order
+    void collectMaterialTextures(size_t firstAsset, std::vector<VkImageView>& outAlbedoTextureViews, std::vector<VkImageView>& outNormalTextureViews);
 
     void createDescriptorPool(const VulkanContext& context);
     void createDescriptorSet(const VulkanContext& context);
-    void writeDescriptorSet(const VulkanContext& context, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView, VkAccelerationStructureKHR tlas, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews);
+
+    /// <summary>
+    /// Reallocates the descriptor set with room for at least textureCount material textures when it has less, every
+    /// binding must be written again afterwards. Returns whether the set was reallocated.
+    /// </summary>
+    bool reserveMaterialTextures(const VulkanContext& context, uint32_t textureCount);
+    // The material textures are written from the one of mesh firstMesh on
+    void writeDescriptorSet(const VulkanContext& context, VkImageView depthImageView, VkImageView normalsImageView, VkImageView albedoImageView, VkAccelerationStructureKHR tlas, uint32_t firstMesh, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews);
+    // Appends the write of the material textures of meshes firstMesh on, outImageInfos must outlive the update
+    void writeMaterialTextures(uint32_t firstMesh, const std::vector<VkImageView>& albedoTextureViews, const std::vector<VkImageView>& normalTextureViews, std::vector<VkDescriptorImageInfo>& outImageInfos, std::vector<VkWriteDescriptorSet>& outDescriptorWrites);
     
     void createStorageImage(const VulkanContext& context, uint32_t width, uint32_t height);
     void createUniformBuffer(const VulkanContext& context);
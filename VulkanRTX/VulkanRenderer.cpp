@@ -123,17 +123,18 @@ void VulkanRenderer::drawFrame(int nativeWidth, int nativeHeight, int scaledWidt
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
-    if (RunTimeSettings::displayRayTracing)
+    // Without a scene the raster frame is presented, the scene may still be loading
+    if (RunTimeSettings::displayRayTracing && graphicsPipeline.rtPipeline.hasScene())
     {
         // Trace rays
         VkCommandBuffer rtcmd = commandBufferManager.beginSingleTimeCommands(context.device);
-        float startTime = Time::time();
+        double startTime = Time::time();
         graphicsPipeline.rtPipeline.traceRays(rtcmd, Time::getFrameCount());
         commandBufferManager.endSingleTimeCommands(context.device, context.graphicsQueue, rtcmd);
-        float hangTime = Time::time() - startTime;
-        if (hangTime > 0.5f)
+        lastTraceTime = Time::time() - startTime;
+        if (lastTraceTime > 0.5)
         {
-            std::cerr << "Hang time: " << hangTime << std::endl;
+            std::cerr << "Hang time: " << lastTraceTime << std::endl;
         }
 
         // Blit ray traced image to swapchain
@@ -220,6 +221,7 @@ void VulkanRenderer::updateUniformBuffers(int scaledWidth, int scaledHeight, con
 
     VulkanFullScreenQuadUBO fullScreenUBO{};
     fullScreenUBO.time = 0; // TODO ?
+    fullScreenUBO.sunDirection = glm::vec4(RunTimeSettings::sunDirection, 0);
     memcpy(fullScreenQuad.uniformBuffersMapped[currentFrame], &fullScreenUBO, sizeof(fullScreenUBO));
 
     SceneData sceneData;
@@ -233,6 +235,8 @@ void VulkanRenderer::updateUniformBuffers(int scaledWidth, int scaledHeight, con
     sceneData.spp = RunTimeSettings::spp;
     sceneData.resolutionX = scaledWidth;
     sceneData.resolutionY = scaledHeight;
+    sceneData.sunDirection = glm::vec4(RunTimeSettings::sunDirection, 0);
+    sceneData.sunColor = glm::vec4(RunTimeSettings::sunColor, 0);
     rtPipeline.updateUniformBuffer(sceneData);
 }
 
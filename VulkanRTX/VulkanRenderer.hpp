@@ -20,6 +20,8 @@ public:
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
 
+    double lastTraceTime = 0.0; // Seconds spent tracing the last frame, the dispatch is waited on before the blit
+
 public:
     void createSyncObjects(const VulkanContext& context, const VulkanSwapChainManager& swapChainManager);
     void recordCommandBuffer(int nativeWidth, int nativeHeight, int scaledWidth, int scaledHeight, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, const VulkanSwapChainManager swapChainManager, VulkanGraphicsPipelineManager& graphicsPipeline, uint32_t imageIndex, uint32_t currentFrame, const std::vector<VulkanModel>& models, const VulkanFullScreenQuad& fullScreenQuad);
@@ -11,7 +11,7 @@ void VulkanTLAS::createTLAS(const VulkanContext& context, const std::vector<Vulk
     for (const VulkanModel& model : models)
     {
         BLASInstance instance;
-        instance.blas = model.blasHandle;
+        instance.blas = model.asset->blasHandle;
         instance.transform = model.transform.getTransformMatrix();
         instance.instanceId = instanceIndex++;
         instance.hitGroupIndex = RT_CLOSEST_HIT_GENERAL_SHADER_INDEX;
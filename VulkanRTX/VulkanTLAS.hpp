@@ -20,13 +20,14 @@ struct BLASInstance
 class VulkanTLAS 
 {
 private:
-    VkAccelerationStructureKHR tlas;
-    VkBuffer tlasBuffer;
-    VkDeviceMemory tlasMemory;
-    VkBuffer instanceBuffer;
-    VkDeviceMemory instanceMemory;
-    VkBuffer scratchBuffer;
-    VkDeviceMemory scratchMemory;
+    // Null until the first build, the TLAS is rebuilt when models are added while the scene loads
+    VkAccelerationStructureKHR tlas = VK_NULL_HANDLE;
+    VkBuffer tlasBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory tlasMemory = VK_NULL_HANDLE;
+    VkBuffer instanceBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+    VkBuffer scratchBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory scratchMemory = VK_NULL_HANDLE;
 
 public:
     void createTLAS(const VulkanContext& context, const std::vector<VulkanModel>& models, VulkanCommandBufferManager& commandBufferManager);
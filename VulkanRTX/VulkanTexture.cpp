@@ -1,5 +1,11 @@
 #include "VulkanTexture.hpp"
+#include "ImportSettings.hpp"
+#include "TextureCache.hpp"
+#include "TextureCompressor.hpp"
 #include "VulkanUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -9,52 +15,267 @@
     #include <stb_image.h>
 #endif
 
+namespace
+{
+    bool isSrgb(VkFormat format)
+    {
+        return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+    }
+
+    const std::array<float, 256>& getSrgbToLinear()
+    {
+        static const std::array<float, 256> table = []
+        {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    uint8_t linearToSrgb(float c)
+    {
+        c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+}
+
 void VulkanTexture::init(std::string path, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format)
 {
-    createImage(path, context, commandBufferManager, format);
-    createImageView(context, format);
+    init(load(path, format), context, commandBufferManager, format);
+}
+
+void VulkanTexture::init(const TextureData& data, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format)
+{
+    VkFormat imageFormat = getImageFormat(data, format);
+    createImage(data, context, commandBufferManager, imageFormat);
+    createImageView(context, imageFormat);
+    createSampler(context);
+}
 
+VkFormat VulkanTexture::getImageFormat(const TextureData& data, VkFormat format)
+{
+    // Compressed data is sampled the same way, in its own block format
+    return data.compressedFormat != VK_FORMAT_UNDEFINED ? data.compressedFormat : format;
+}
+
+void VulkanTexture::createSampler(const VulkanContext& context)
+{
     // TODO: don't create a sampler everytime, reuse a sampler instead
     VulkanUtils::Textures::createSampler(context, &sampler, VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR);
 }
 
 void VulkanTexture::createImageView(const VulkanContext& context, VkFormat format)
 {
-    imageView = VulkanUtils::Image::createImageView(context, image, format, VK_IMAGE_ASPECT_COLOR_BIT);
+    imageView = VulkanUtils::Image::createImageView(context, image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
 }
 
-void VulkanTexture::createImage(std::string path, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format)
+TextureData VulkanTexture::decode(const std::string& path)
 {
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
-
     if (!pixels)
     {
         throw std::runtime_error("failed to load texture image!");
     }
 
+    TextureData data;
+    data.width = static_cast<uint32_t>(texWidth);
+    data.height = static_cast<uint32_t>(texHeight);
+    data.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
+    stbi_image_free(pixels);
+    return data;
+}
+
+TextureData VulkanTexture::load(const std::string& path, VkFormat format)
+{
+    VkFormat compressedFormat = getCompressedFormat(format);
+    if (!ImportSettings::compressTextures || compressedFormat == VK_FORMAT_UNDEFINED)
+    {
+        return decode(path);
+    }
+
+    TextureData data;
+    if (TextureCache::load(path, compressedFormat, data))
+    {
+        return data;
+    }
+
+    data = TextureCompressor::compress(decode(path), compressedFormat);
+    TextureCache::store(path, data);
+    return data;
+}
+
+VkFormat VulkanTexture::getCompressedFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return VK_FORMAT_BC7_SRGB_BLOCK;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+TextureData VulkanTexture::downsample(const TextureData& data, bool srgb)
+{
+    TextureData result;
+    result.width = std::max(data.width / 2, 1u);
+    result.height = std::max(data.height / 2, 1u);
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+
+    const std::array<float, 256>& toLinear = getSrgbToLinear();
+    for (uint32_t y = 0; y < result.height; y++)
+    {
+        // A source side of 1 texel is read twice
+        uint32_t y0 = std::min(y * 2, data.height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, data.height - 1);
+        for (uint32_t x = 0; x < result.width; x++)
+        {
+            uint32_t x0 = std::min(x * 2, data.width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, data.width - 1);
+            const uint8_t* texels[4] = {
+                &data.pixels[(static_cast<size_t>(y0) * data.width + x0) * 4],
+                &data.pixels[(static_cast<size_t>(y0) * data.width + x1) * 4],
+                &data.pixels[(static_cast<size_t>(y1) * data.width + x0) * 4],
+                &data.pixels[(static_cast<size_t>(y1) * data.width + x1) * 4]
+            };
+
+            uint8_t* target = &result.pixels[(static_cast<size_t>(y) * result.width + x) * 4];
+            for (int c = 0; c < 4; c++)
+            {
+                // Alpha is always linear
+                if (srgb && c < 3)
+                {
+                    float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]];
+                    target[c] = linearToSrgb(sum * 0.25f);
+                }
+                else
+                {
+                    target[c] = static_cast<uint8_t>((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+void VulkanTexture::createImage(const TextureData& textureData, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format)
+{
+    TextureUpload upload = prepareUpload(textureData, context, format);
+
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
-    VulkanUtils::Buffers::createBuffer(context, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    VulkanUtils::Buffers::createBuffer(context, upload.size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
     void* data;
-    vkMapMemory(context.device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
+    vkMapMemory(context.device, stagingBufferMemory, 0, upload.size, 0, &data);
+    writeStaging(upload, static_cast<uint8_t*>(data));
     vkUnmapMemory(context.device, stagingBufferMemory);
 
-    stbi_image_free(pixels);
-
-    VulkanUtils::Image::createImage(context, texWidth, texHeight, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+    VulkanUtils::Image::createImage(context, textureData.width, textureData.height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory, mipLevels);
 
-    VulkanUtils::Image::transitionImageLayout(context, commandBufferManager, image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    VulkanUtils::Image::copyBufferToImage(context, commandBufferManager, stagingBuffer, image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    VulkanUtils::Image::transitionImageLayout(context, commandBufferManager, image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    // One submission for the whole upload, the queue is waited on once per texture
+    VkCommandBuffer commandBuffer = commandBufferManager.beginSingleTimeCommands(context.device);
+    recordUpload(commandBuffer, upload, stagingBuffer, 0);
+    commandBufferManager.endSingleTimeCommands(context.device, context.graphicsQueue, commandBuffer);
 
     vkDestroyBuffer(context.device, stagingBuffer, nullptr);
     vkFreeMemory(context.device, stagingBufferMemory, nullptr);
 }
 
+TextureUpload VulkanTexture::prepareUpload(const TextureData& textureData, const VulkanContext& context, VkFormat format)
+{
+    TextureUpload upload;
+    upload.width = textureData.width;
+    upload.height = textureData.height;
+    upload.format = format;
+
+    bool compressed = textureData.compressedFormat != VK_FORMAT_UNDEFINED;
+    mipLevels = compressed ? textureData.mipLevels : VulkanUtils::Image::getMipLevelCount(upload.width, upload.height);
+
+    // The GPU blits the chain from level 0, formats it cannot filter get their levels built here instead.
+    // Compressed data comes with its chain
+    upload.blitMipmaps = !compressed && VulkanUtils::Image::supportsMipmapBlit(context, format);
+    if (!compressed && !upload.blitMipmaps)
+    {
+        upload.cpuLevels.reserve(mipLevels - 1);
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            upload.cpuLevels.push_back(downsample(level == 1 ? textureData : upload.cpuLevels.back(), isSrgb(format)));
+        }
+    }
+
+    // Uploaded levels, with where their data starts
+    for (uint32_t level = 0; level < (upload.blitMipmaps ? 1 : mipLevels); level++)
+    {
+        uint32_t levelWidth = std::max(upload.width >> level, 1u);
+        uint32_t levelHeight = std::max(upload.height >> level, 1u);
+        VkBufferImageCopy region{};
+        region.bufferOffset = upload.size;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { levelWidth, levelHeight, 1 };
+        upload.regions.push_back(region);
+
+        if (compressed)
+        {
+            // Levels are packed from the largest
+            upload.levelPixels.push_back(textureData.pixels.data() + upload.size);
+            upload.size += TextureCompressor::getLevelSize(levelWidth, levelHeight);
+        }
+        else
+        {
+            const TextureData& levelData = level == 0 ? textureData : upload.cpuLevels[level - 1];
+            upload.levelPixels.push_back(levelData.pixels.data());
+            upload.size += levelData.pixels.size();
+        }
+    }
+    if (compressed && upload.size != textureData.pixels.size())
+    {
+        throw std::runtime_error("incomplete compressed mip chain!");
+    }
+    return upload;
+}
+
+void VulkanTexture::writeStaging(const TextureUpload& upload, uint8_t* target)
+{
+    for (size_t i = 0; i < upload.regions.size(); i++)
+    {
+        VkDeviceSize levelSize = (i + 1 < upload.regions.size() ? upload.regions[i + 1].bufferOffset : upload.size) - upload.regions[i].bufferOffset;
+        memcpy(target + upload.regions[i].bufferOffset, upload.levelPixels[i], static_cast<size_t>(levelSize));
+    }
+}
+
+void VulkanTexture::recordUpload(VkCommandBuffer commandBuffer, const TextureUpload& upload, VkBuffer stagingBuffer, VkDeviceSize stagingOffset)
+{
+    std::vector<VkBufferImageCopy> regions = upload.regions;
+    for (VkBufferImageCopy& region : regions)
+    {
+        region.bufferOffset += stagingOffset;
+    }
+
+    VulkanUtils::Image::transitionImageLayout_existingCmd(commandBuffer, image, upload.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+    VulkanUtils::Image::copyBufferToImage_existingCmd(commandBuffer, stagingBuffer, image, regions);
+    if (upload.blitMipmaps)
+    {
+        VulkanUtils::Image::generateMipmaps_existingCmd(commandBuffer, image, upload.width, upload.height, mipLevels);
+    }
+    else
+    {
+        VulkanUtils::Image::transitionImageLayout_existingCmd(commandBuffer, image, upload.format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+    }
+}
+
 void VulkanTexture::cleanup(VkDevice device)
 {
     vkDestroySampler(device, sampler, nullptr);
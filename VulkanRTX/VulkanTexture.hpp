@@ -3,7 +3,45 @@
 #include "Constants.hpp"
 #include "VulkanContext.hpp"
 #include "VulkanCommandBufferManager.hpp"
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// RGBA8 pixels decoded from an image file, or a block compressed mip chain. Decoding can run on any thread while the upload
+// needs the render thread
+struct TextureData
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels; // Level 0, or every level from the largest when compressed
+    VkFormat compressedFormat = VK_FORMAT_UNDEFINED; // Block format of the pixels, undefined for RGBA8
+    uint32_t mipLevels = 1; // Levels stored in pixels
+};
+
+// Textures decoded ahead of an upload, by source path
+using DecodedTextures = std::unordered_map<std::string, TextureData>;
+
+class VulkanTexture;
+
+// Cached textures acquired ahead of the materials using them, by source path and format
+using AcquiredTextures = std::map<std::pair<std::string, VkFormat>, std::shared_ptr<VulkanTexture>>;
+
+// Staging layout of one texture, built by VulkanTexture::prepareUpload. Level pointers reference the TextureData it was built
+// from, which must outlive it
+struct TextureUpload
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED; // Of the image
+    std::vector<VkBufferImageCopy> regions; // Offsets relative to the start of the texture in the staging buffer
+    std::vector<const uint8_t*> levelPixels; // Source of every region
+    std::vector<TextureData> cpuLevels; // Levels built on the CPU for formats the GPU cannot blit
+    VkDeviceSize size = 0; // Staging bytes
+    bool blitMipmaps = false; // Only level 0 is copied, the GPU blits the others
+};
 
 class VulkanTexture
 {
@@ -12,12 +50,40 @@ public:
     VkDeviceMemory imageMemory;
     VkImageView imageView;
     VkSampler sampler;
+    uint32_t mipLevels = 1;
 
 public:
     void init(std::string path, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
+    void init(const TextureData& data, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
     void createImageView(const VulkanContext& context, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
-    void createImage(std::string path, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
+    void createImage(const TextureData& data, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
+    void createSampler(const VulkanContext& context);
     void cleanup(VkDevice device);
 
+    /// <summary>
+    /// Split createImage for batched uploads: prepareUpload sets the mip count and lays the levels out, writeStaging copies
+    /// them to the mapped staging memory of the texture and recordUpload records the copy into the created image, leaving
+    /// every level in SHADER_READ_ONLY_OPTIMAL. format is the image format, see getImageFormat.
+    /// </summary>
+    TextureUpload prepareUpload(const TextureData& data, const VulkanContext& context, VkFormat format);
+    static void writeStaging(const TextureUpload& upload, uint8_t* target);
+    void recordUpload(VkCommandBuffer commandBuffer, const TextureUpload& upload, VkBuffer stagingBuffer, VkDeviceSize stagingOffset);
+
+    // Format of the image holding the data of a texture used with the given format
+    static VkFormat getImageFormat(const TextureData& data, VkFormat format);
+
+    static TextureData decode(const std::string& path);
+
+    /// <summary>
+    /// Image data of a texture used with the given RGBA8 format. With ImportSettings::compressTextures, the block compressed
+    /// chain is read from the texture cache, or decoded, transcoded and cached on first load. Any thread.
+    /// </summary>
+    static TextureData load(const std::string& path, VkFormat format);
+
+    // BC7 for color, BC5 for the normal maps loaded as UNORM
+    static VkFormat getCompressedFormat(VkFormat format);
+
+    // Next mip level with a 2x2 box filter, averaged in linear space for sRGB data
+    static TextureData downsample(const TextureData& data, bool srgb);
     static VulkanTexture create1x1TextureRGBA(uint8_t r, uint8_t g, uint8_t b, const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB);
 };
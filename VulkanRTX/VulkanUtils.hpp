@@ -31,8 +31,23 @@ namespace VulkanUtils
     namespace Image
     {
         void copyBufferToImage(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-        void createImage(const VulkanContext& context, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-        VkImageView createImageView(const VulkanContext& context, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+        void copyBufferToImage(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions);
+        void copyBufferToImage_existingCmd(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions);
+        void createImage(const VulkanContext& context, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t mipLevels = 1);
+        VkImageView createImageView(const VulkanContext& context, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
+
+        // Levels of a full mip chain down to 1x1
+        uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+        // Whether the device can fill the mip chain of an optimal tiling image of this format with linear blits
+        bool supportsMipmapBlit(const VulkanContext& context, VkFormat format);
+
+        /// <summary>
+        /// Fills levels 1 and up by blitting each level from the previous one. Every level must be in TRANSFER_DST_OPTIMAL with
+        /// level 0 written, the whole chain ends in SHADER_READ_ONLY_OPTIMAL. The image needs TRANSFER_SRC usage.
+        /// </summary>
+        void generateMipmaps(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
+        void generateMipmaps_existingCmd(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
         void blitImage(
             VkCommandBuffer commandBuffer,
             VkImage srcImage, VkImage dstImage,
@@ -44,7 +59,8 @@ namespace VulkanUtils
             VkFilter filter
         );
         void transition_depthRW_to_depthR_existingCmd(const VulkanContext& context, VkCommandBuffer commandBuffer, VkImage image, VkFormat format);
-        void transitionImageLayout(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+        void transitionImageLayout(const VulkanContext& context, VulkanCommandBufferManager& commandBufferManager, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+        void transitionImageLayout_existingCmd(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
     };
 
     namespace Textures
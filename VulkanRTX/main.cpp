@@ -1,8 +1,14 @@
 #include "VulkanApplication.hpp"
+#include "TangentGenerator.hpp"
+#include "FastObjParser.hpp"
+#include "Scene.hpp"
+#include "ImportSettings.hpp"
+#include "TextureCompressor.hpp"
 
 #include <iostream>
 #include <windows.h>
 #include <cstdlib>
+#include <string>
 
 void compileShaders()
 {
@@ -27,13 +33,87 @@ void compileShaders()
 #endif
 }
 
-int main()
+int main(int argc, char** argv)
 {
     VulkanApplication app;
 
     try 
     {
+        std::string scenePath = "scenes/default.scene";
+        std::string staticLayout;
+        int benchmarkFrames = 0;
+        bool benchmarkStaticLayout = false;
+        bool progressive = false;
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::string(argv[i]) == "--scene" && i + 1 < argc)
+            {
+                scenePath = argv[++i];
+                continue;
+            }
+            if (std::string(argv[i]) == "--static-layout" && i + 1 < argc)
+            {
+                staticLayout = argv[++i];
+                continue;
+            }
+            if (std::string(argv[i]) == "--bench-rays" && i + 1 < argc)
+            {
+                benchmarkFrames = std::stoi(argv[++i]);
+                continue;
+            }
+            if (std::string(argv[i]) == "--progressive")
+            {
+                progressive = true;
+                continue;
+            }
+            if (std::string(argv[i]) == "--bench-static-layout")
+            {
+                benchmarkStaticLayout = true;
+                continue;
+            }
+            if (std::string(argv[i]) == "--bench-tangents")
+            {
+                TangentGenerator::runBenchmark("models");
+                return 0;
+            }
+            if (std::string(argv[i]) == "--bench-obj")
+            {
+                FastObjParser::runBenchmark("models");
+                return 0;
+            }
+            if (std::string(argv[i]) == "--compress-textures")
+            {
+                TextureCompressor::compressModels("models");
+                return 0;
+            }
+        }
+
+        // Runs the scene once per static layout, each run prints its rays per second
+        if (benchmarkStaticLayout)
+        {
+            for (const char* layout : { "instanced", "merged" })
+            {
+                std::string command = "\"\"" + std::string(argv[0]) + "\" --scene \"" + scenePath + "\" --static-layout " + layout + " --bench-rays 256\"";
+                std::system(command.c_str());
+            }
+            return 0;
+        }
+
+        Scene::loadDescription(scenePath);
+        if (staticLayout == "merged" || staticLayout == "instanced")
+        {
+            ImportSettings::mergeStaticModels = staticLayout == "merged";
+        }
+        else if (!staticLayout.empty())
+        {
+            throw std::runtime_error("Unknown static layout: " + staticLayout + ", expected merged or instanced");
+        }
+        if (progressive)
+        {
+            ImportSettings::progressiveLoading = true;
+        }
         compileShaders();
+        app.setRayBenchmark(benchmarkFrames);
         app.run();
     }
     catch (const std::exception& e) 
@@ -8,6 +8,7 @@ set SLANGC=slangc.exe
 echo Compiling shaders...
 
 %SLANGC% -profile vs_5_0 -target spirv -entry main -o geometry_vert.spv geometry_vert.slang
+%SLANGC% -profile vs_5_0 -target spirv -entry main -D COMPACT_VERTEX -o geometry_vert_compact.spv geometry_vert.slang
 %SLANGC% -profile ps_5_0 -target spirv -entry main -o geometry_frag.spv geometry_frag.slang
 
 %SLANGC% -profile vs_5_0 -target spirv -entry main -o lighting_vert.spv lighting_vert.slang